@@ -15,6 +15,12 @@
 #include "amb82_gpio.h"
 #include "serial_commands.h"
 #include "lora_rak3172.h"
+#include "detection_manager.h"
+#include "heap_probe.h"
+#include "nn_governor.h"
+#include "motion_gate.h"
+#include "trigger_rules.h"
+#include "state_checkpoint.h"
 
 // Neural Network includes
 #include "WiFi.h"
@@ -23,7 +29,6 @@
 #include "RTSP.h"
 #include "NNObjectDetection.h"
 #include "VideoStreamOverlay.h"
-#include "ObjectClassList.h"
 
 // ===== GLOBAL VARIABLES =====
 system_config_t system_config;
@@ -36,14 +41,19 @@ extern void stop_rtsp_streaming();
 // Video configuration
 #define CHANNEL 0
 #define CHANNELNN 3
+#define CHANNELMD 1
 #define NNWIDTH 576
 #define NNHEIGHT 320
 
 // Core detection setup
-VideoSetting configNN(NNWIDTH, NNHEIGHT, 10, VIDEO_RGB, 0);
+VideoSetting configNN(NNWIDTH, NNHEIGHT, DETECTION_NN_TARGET_FPS, VIDEO_RGB, 0);
 NNObjectDetection ObjDet;
 StreamIO videoStreamerNN(1, 1);
 
+// Motion gate input: a small NV12 channel read with getImage(), so the gate
+// never takes frames from the StreamIO link feeding ObjDet
+VideoSetting configMD(MOTION_CAPTURE_W, MOTION_CAPTURE_H, DETECTION_NN_TARGET_FPS, VIDEO_NV12, 0);
+
 // Optional WiFi/RTSP components
 VideoSetting config(VIDEO_FHD, 30, VIDEO_H264, 0);
 RTSP rtsp;
@@ -58,9 +68,6 @@ bool neural_network_loaded = false;
 bool camera_initialized = false;
 bool wifi_connected = false;
 bool rtsp_streaming = false;
-uint32_t detection_count = 0;
-uint32_t led_detections = 0;
-uint32_t motherboard_detections = 0;
 
 // ===== USB CONNECTION MONITORING =====
 typedef enum {
@@ -218,11 +225,12 @@ void perform_post_reconnection_check() {
   }
 
   // Display current stats
-  Serial.println("📊 Current stats: Detections=" + String(detection_count) + " (LED:" + String(led_detections) + ", MB:" + String(motherboard_detections) + ")");
+  detection_stats_t* stats = &detection_manager.stats;
+  Serial.println("📊 Current stats: Detections=" + String(stats->total_detections_found) + " (LED:" + String(stats->led_on_detections) + ", MB:" + String(stats->motherboard_detections) + ")");
 }
 
 // ===== SAFE SERIAL OUTPUT =====
-void safe_serial_print(const String& message) {
+void safe_serial_print(const char* message) {
   if (usb_monitor.current_state == USB_STATE_STABLE || usb_monitor.current_state == USB_STATE_CONNECTED) {
     try {
       Serial.println(message);
@@ -232,97 +240,28 @@ void safe_serial_print(const String& message) {
   }
 }
 
-void safe_serial_print(const char* message) {
-  safe_serial_print(String(message));
-}
-
-// ===== DETECTION HANDLER =====
-void handle_detection(uint8_t object_class, float confidence, ObjectDetectionResult& result) {
-  // Update statistics
-  detection_count++;
-
-  if (object_class == CLASS_LED_ON) {
-    led_detections++;
-  } else if (object_class == CLASS_MOTHERBOARD) {
-    motherboard_detections++;
-
-    // Add to motherboard counter
-    motherboard_counter_add_detection(millis());
-
-    // Check if trigger threshold reached
-    if (motherboard_counter_check_trigger()) {
-      // Send LoRa trigger message
-      send_motherboard_trigger_lora();
-
-      // Special visual indication
-      gpio_status_led_set_pattern(LED_PATTERN_TRIPLE_BLINK);
-
-      safe_serial_print("🚨 MOTHERBOARD DETECTION TRIGGER ACTIVATED!");
-      safe_serial_print("📡 LoRa trigger message sent");
-    }
-  }
-
-  // Create detection result for logging
-  detection_result_t det_result = { 0 };
-  det_result.timestamp = millis();
-  det_result.object_class = object_class;
-  det_result.confidence = confidence;
-  det_result.x_min = result.xMin();
-  det_result.y_min = result.yMin();
-  det_result.x_max = result.xMax();
-  det_result.y_max = result.yMax();
-  det_result.valid = 1;
-
-  // Log to flash
-  if (flash_is_initialized()) {
-    flash_write_detection_log(&det_result);
-  }
-
-  // Visual feedback
-  //if (object_class != CLASS_MOTHERBOARD || !motherboard_counter_check_trigger()) {
-  gpio_status_led_set_pattern(LED_PATTERN_FAST_BLINK);
-  //}
-  gpio_laser_force_off();
-
-  // LoRa transmission for high-confidence detections
-  if (lora_is_initialized() && confidence >= system_config.detection_threshold) {
-    send_detection_lora(object_class, confidence);
-  }
-
-  // Update crosshair laser for motherboard
-  if (object_class == CLASS_MOTHERBOARD && motherboard_counter_check_trigger()) {
-    gpio_status_led_set_pattern(LED_PATTERN_TRIPLE_BLINK);
-  }
-
-  // Print detection info safely
-  String counter_info = "";
-  if (object_class == CLASS_MOTHERBOARD) {
-    uint32_t window_count = motherboard_counter_get_count_in_window();
-    counter_info = " (Count: " + String(window_count) + "/" + String(system_config.motherboard_count_threshold) + ")";
-  }
-
-  safe_serial_print("🎯 " + String(object_class == CLASS_LED_ON ? "LED" : "MOTHERBOARD") + " detected: " + String(confidence, 1) + "%" + counter_info);
+void safe_serial_print(const String& message) {
+  safe_serial_print(message.c_str());
 }
 
 // ===== LORA FUNCTIONS =====
-void send_detection_lora(uint8_t object_class, float confidence) {
-  char msg[30];
-  snprintf(msg, sizeof(msg), "%d,%.2f", object_class, confidence);
-
-  lora_result_t result = lora_send_message(LORA_MSG_DETECTION, msg);
-  if (result != LORA_SUCCESS) {
-    DEBUG_PRINT(3, "[LoRa] Failed: " + String(lora_result_to_string(result)));
-  } else {
-    DEBUG_PRINT(3, "[LoRa] Sent: " + String(msg));
-  }
-}
-
 void send_status_lora() {
-  char msg[25];
-  snprintf(msg, sizeof(msg), "UP:%lu,D:%lu", millis() / 1000, detection_count);
+  // Format: S,<uptime_seconds>,<detections>, then R,<MB per minute> on the next LoRa pass
+  static_assert(LORA_MESSAGE_FITS("S,4294967,4294967295"), "status uplink exceeds the LoRa payload limit");
+  static_assert(LORA_MESSAGE_FITS("R,65535"), "rate uplink exceeds the LoRa payload limit");
+  char msg[LORA_MAX_MESSAGE_LENGTH + 1];
+  snprintf(msg, sizeof(msg), "S,%lu,%lu", millis() / 1000, detection_manager.stats.total_detections_found);
   lora_result_t result = lora_send_message(LORA_MSG_STATUS, msg);
   if (result != LORA_SUCCESS) {
     DEBUG_PRINT(3, "[LoRa] Status failed: " + String(lora_result_to_string(result)));
+    return;
+  }
+
+  float per_minute = motherboard_counter_get_rate() * 60.0f + 0.5f;
+  snprintf(msg, sizeof(msg), "R,%u", (unsigned)(per_minute < UINT16_MAX ? (uint16_t)per_minute : UINT16_MAX));
+  result = lora_queue_message(LORA_MSG_STATUS, msg);
+  if (result != LORA_SUCCESS) {
+    DEBUG_PRINT(3, "[LoRa] Rate failed: " + String(lora_result_to_string(result)));
   }
 }
 
@@ -354,6 +293,102 @@ bool init_wifi_on_demand() {
   }
 }
 
+// ===== NN RESULT CALLBACK =====
+// Runs in the NN task after every finished inference. Copies the results into
+// the next free queue slot; the main loop drains the queue every iteration.
+void on_nn_results_ready(std::vector<ObjectDetectionResult> results) {
+  if (detection_sim_is_active()) {
+    return;  // Simulated source owns the queue
+  }
+
+  detection_frame_t* frame = detection_queue_reserve();
+  if (!frame) {
+    return;  // Queue full, counted as dropped
+  }
+
+  size_t count = results.size();
+  frame->raw_result_count = count > 255 ? 255 : count;
+
+  for (size_t i = 0; i < count && frame->result_count < MAX_DETECTION_RESULTS; i++) {
+    ObjectDetectionResult& item = results[i];
+    uint8_t slot = frame->result_count++;
+    frame->object_type[slot] = item.type();
+    frame->confidence[slot] = item.score();
+    frame->box[slot].x_min = item.xMin();
+    frame->box[slot].y_min = item.yMin();
+    frame->box[slot].x_max = item.xMax();
+    frame->box[slot].y_max = item.yMax();
+  }
+
+  detection_queue_commit();
+}
+
+// ===== NN LINK CONTROL =====
+// Used by the frame rate governor: pausing the StreamIO link stops frames
+// reaching ObjDet without tearing down the camera channel or the model
+void nn_link_set_running(bool running) {
+  if (!neural_network_loaded) {
+    return;
+  }
+
+  try {
+    if (running) {
+      videoStreamerNN.resume();
+    } else {
+      videoStreamerNN.pause();
+    }
+  } catch (...) {
+    safe_serial_print("! NN link " + String(running ? "resume" : "pause") + " failed");
+  }
+}
+
+// ===== MOTION CHANNEL CONTROL =====
+// CHANNELMD is configured with the other channels before videoInit() but only
+// streams while the motion gate is enabled
+static bool motion_channel_running = false;
+
+bool motion_channel_set_running(bool running) {
+  if (!camera_initialized) {
+    return false;
+  }
+  if (running == motion_channel_running) {
+    return true;
+  }
+
+  try {
+    if (running) {
+      Camera.channelBegin(CHANNELMD);
+    } else {
+      Camera.channelEnd(CHANNELMD);
+    }
+  } catch (...) {
+    safe_serial_print("! Motion channel " + String(running ? "start" : "stop") + " failed");
+    return false;
+  }
+
+  motion_channel_running = running;
+  return true;
+}
+
+// Latest CHANNELMD frame (NV12, Y plane first) for the motion gate
+bool motion_capture_frame(const uint8_t** data, uint32_t* length) {
+  if (!camera_initialized || !motion_channel_running) {
+    return false;
+  }
+
+  uint32_t addr = 0;
+  uint32_t len = 0;
+  try {
+    Camera.getImage(CHANNELMD, &addr, &len);
+  } catch (...) {
+    return false;
+  }
+
+  *data = (const uint8_t*)(uintptr_t)addr;
+  *length = len;
+  return addr != 0 && len > 0;
+}
+
 // ===== NEURAL NETWORK INITIALIZATION =====
 bool init_neural_network_core() {
   safe_serial_print("[NN] Initializing Core Neural Network...");
@@ -362,6 +397,7 @@ bool init_neural_network_core() {
     safe_serial_print("  - Configuring video channels...");
     Camera.configVideoChannel(CHANNELNN, configNN);
     Camera.configVideoChannel(CHANNEL, config);  // Also configure main channel
+    Camera.configVideoChannel(CHANNELMD, configMD);
     delay(1000);
 
     safe_serial_print("  - Camera video initialization...");
@@ -376,6 +412,9 @@ bool init_neural_network_core() {
     ObjDet.modelSelect(OBJECT_DETECTION, CUSTOMIZED_YOLOV7TINY, NA_MODEL, NA_MODEL);
     delay(1000);
 
+    safe_serial_print("  - Registering result-ready callback...");
+    ObjDet.setResultCallback(on_nn_results_ready);
+
     safe_serial_print("  - Starting object detection...");
     ObjDet.begin();
     delay(2000);
@@ -449,6 +488,14 @@ void setup() {
   motherboard_counter_init();
   Serial.println("✓ Motherboard counter ready");
 
+  Serial.println("[3b] Detection manager...");
+  detection_init();
+  Serial.println("✓ Detection manager ready (" + String(DETECTION_QUEUE_DEPTH) + " frame queue)");
+
+  Serial.println("[3c] State checkpoint...");
+  checkpoint_init();
+  Serial.println("✓ Counter state " + String(checkpoint_get_stats()->restored ? "restored" : "fresh"));
+
   Serial.println("[4] Serial commands...");
   serial_commands_init();
   Serial.println("✓ Commands ready");
@@ -512,6 +559,9 @@ void setup() {
     Serial.println("⚠️  System will continue without detection capability");
   }
 
+  nn_governor_init();
+  motion_gate_init();
+
   system_state = SYS_STATE_RUNNING;
 
   Serial.println("\n🎉 SYSTEM V2.0 STATUS!");
@@ -528,7 +578,7 @@ void setup() {
     Serial.println("\n🎯 DETECTION SETTINGS:");
     Serial.println("- Threshold: " + String(system_config.detection_threshold * 100) + "%");
     Serial.println("- Motherboard: " + String(system_config.motherboard_threshold * 100) + "%");
-    Serial.println("- MB Trigger: " + String(system_config.motherboard_count_threshold) + " detections");
+    Serial.println("- MB Trigger: " + String(system_config.class_counters[CLASS_MOTHERBOARD].count_threshold) + " detections");
   }
 
   Serial.println("\n⚠️  TROUBLESHOOTING NOTES:");
@@ -571,9 +621,18 @@ void loop() {
   }
 
   // Core detection processing (always continue)
-  if (neural_network_loaded) {
+  nn_governor_process();
+  motion_gate_process();
+  detection_sim_process();
+  if (neural_network_loaded || detection_sim_is_active()) {
     process_detections_core();
   }
+  trigger_rules_process();
+  class_counter_process();
+  motherboard_counter_zones_process();
+  checkpoint_process();
+  flash_log_process();
+  config_process();
 
   // Status reporting with USB-safe output
   static uint32_t last_status = 0;
@@ -583,12 +642,14 @@ void loop() {
     }
 
     uint32_t mb_window_count = motherboard_counter_get_count_in_window();
-    safe_serial_print("📊 " + String(millis() / 1000) + "s | Detections: " + String(detection_count) + " (LED:" + String(led_detections) + ", MB:" + String(motherboard_detections) + ") | MB Window: " + String(mb_window_count) + "/" + String(system_config.motherboard_count_threshold) + " | USB: " + String(usb_monitor.reconnection_count) + " reconnections");
+    detection_stats_t* stats = &detection_manager.stats;
+    safe_serial_print("📊 " + String(millis() / 1000) + "s | Detections: " + String(stats->total_detections_found) + " (LED:" + String(stats->led_on_detections) + ", MB:" + String(stats->motherboard_detections) + ") | " + String(stats->frames_per_second, 1) + " fps (" + String(nn_rate_to_string(nn_governor_get_rate())) + ") | MB Window: " + String(mb_window_count) + "/" + String(system_config.class_counters[CLASS_MOTHERBOARD].count_threshold) + " | USB: " + String(usb_monitor.reconnection_count) + " reconnections");
 
     last_status = millis();
   }
   static uint32_t last_led_reset = 0;
   if (millis() - last_led_reset > 10000) {  // 10 seconds
+    uint32_t detection_count = detection_manager.stats.total_detections_found;
     static uint32_t last_detection_check = detection_count;
     if (last_detection_check == detection_count) {
       // No new detections in 10 seconds, return to normal blink
@@ -597,83 +658,52 @@ void loop() {
     last_detection_check = detection_count;
     last_led_reset = millis();
   }
-  delay(100);
+  delay(MAIN_LOOP_DELAY);
 }
 
 // ===== DETECTION PROCESSING =====
 void process_detections_core() {
-  static uint32_t last_check = 0;
   static uint32_t error_count = 0;
 
-  if (millis() - last_check < 2000) return;
-
-  try {
-    // Check if neural network is still loaded
-    if (!neural_network_loaded) {
-      return;
-    }
-
-    std::vector<ObjectDetectionResult> results = ObjDet.getResult();
-    int count = ObjDet.getResultCount();
+  // Check if neural network is still loaded
+  if (!neural_network_loaded && !detection_sim_is_active()) {
+    return;
+  }
 
+  // The detection manager drains every queued NN frame
+  if (detection_process() != DETECTION_ERROR_PROCESSING) {
     // Reset error count on successful operation
     error_count = 0;
 
     // Debug output with USB-safe printing
     static uint32_t last_debug = 0;
     if (millis() - last_debug > 30000) {
-      safe_serial_print("[DEBUG] NN Processing - Result count: " + String(count));
+      safe_serial_print("[DEBUG] NN Processing - Result count: " + String(detection_get_result_count()) +
+                        ", " + String(detection_manager.stats.frames_per_second, 1) + " fps");
       last_debug = millis();
     }
+    return;
+  }
 
-    // Process detections
-    if (count > 0) {
-      for (int i = 0; i < count && i < 3; i++) {
-        ObjectDetectionResult item = results[i];
-        int obj_type = item.type();
-        float confidence = item.score();
-
-        if (obj_type >= 0 && obj_type < 2) {  // Only process our 2 classes
-          if (confidence > system_config.detection_threshold) {
-
-            uint8_t object_class = CLASS_UNKNOWN;
-
-            if (obj_type == 0) {
-              object_class = CLASS_LED_ON;
-            } else if (obj_type == 1) {
-              object_class = CLASS_MOTHERBOARD;
-            }
-
-            if (object_class != CLASS_UNKNOWN) {
-              handle_detection(object_class, confidence, item);
-            }
-          }
-        }
-      }
-    }
+  error_count++;
+  if (error_count < 5) {  // Only print first few errors
+    safe_serial_print("! Detection processing error #" + String(error_count));
+  }
 
-  } catch (...) {
-    error_count++;
-    if (error_count < 5) {  // Only print first few errors
-      safe_serial_print("! Detection processing error #" + String(error_count));
-    }
+  // If too many errors, try to restart detection
+  if (error_count > 10) {
+    safe_serial_print("⚠️  Too many detection errors, attempting restart...");
+    neural_network_loaded = false;
+    delay(5000);
 
-    // If too many errors, try to restart detection
-    if (error_count > 10) {
-      safe_serial_print("⚠️  Too many detection errors, attempting restart...");
-      neural_network_loaded = false;
-      delay(5000);
-
-      if (init_neural_network_core()) {
-        safe_serial_print("✅ Detection system restarted successfully");
-        error_count = 0;
-      } else {
-        safe_serial_print("❌ Detection system restart failed");
-      }
+    if (init_neural_network_core()) {
+      safe_serial_print("✅ Detection system restarted successfully");
+      error_count = 0;
+      nn_governor_init();  // Fresh link is running at full rate
+    } else {
+      safe_serial_print("❌ Detection system restart failed");
     }
   }
-
-  last_check = millis();
 }
 
 // ===== DIAGNOSTIC FUNCTIONS =====
@@ -682,9 +712,16 @@ void debug_neural_network_status() {
   safe_serial_print("USB State: " + String(usb_monitor.current_state) + " (Reconnections: " + String(usb_monitor.reconnection_count) + ")");
   safe_serial_print("Camera initialized: " + String(camera_initialized ? "YES" : "NO"));
   safe_serial_print("NN loaded: " + String(neural_network_loaded ? "YES" : "NO"));
-  safe_serial_print("Detection count: " + String(detection_count));
-  safe_serial_print("LED detections: " + String(led_detections));
-  safe_serial_print("Motherboard detections: " + String(motherboard_detections));
+  detection_stats_t* stats = &detection_manager.stats;
+  safe_serial_print("Detection count: " + String(stats->total_detections_found));
+  safe_serial_print("LED detections: " + String(stats->led_on_detections));
+  safe_serial_print("Motherboard detections: " + String(stats->motherboard_detections));
+  safe_serial_print("Frame rate: " + String(stats->frames_per_second, 1) + " fps");
+  if (heap_probe_is_enabled()) {
+    safe_serial_print("Detection path heap allocations: " + String(stats->heap_allocations));
+  } else {
+    safe_serial_print("Detection path heap allocations: n/a (build with HEAP_PROBE_ENABLED=1)");
+  }
 
   try {
     int count = ObjDet.getResultCount();
@@ -694,6 +731,8 @@ void debug_neural_network_status() {
   }
 
   safe_serial_print("=====================================\n");
+
+  detection_queue_print_stats();
 }
 
 bool reset_camera_system() {
@@ -720,6 +759,11 @@ void debug_camera_system() {
     Serial.println("NN Channel (CHANNELNN=" + String(CHANNELNN) + "):");
     Serial.println("  Resolution: " + String(NNWIDTH) + "x" + String(NNHEIGHT));
 
+    // Test motion channel
+    Serial.println("Motion Channel (CHANNELMD=" + String(CHANNELMD) + "):");
+    Serial.println("  Resolution: " + String(MOTION_CAPTURE_W) + "x" + String(MOTION_CAPTURE_H) + " NV12");
+    Serial.println("  Status: " + String(motion_channel_running ? "ACTIVE" : "INACTIVE (motion gate off)"));
+
     // Test RTSP channel
     Serial.println("RTSP Channel (CHANNEL=" + String(CHANNEL) + "):");
     Serial.println("  Status: " + String(rtsp_streaming ? "ACTIVE" : "INACTIVE"));
@@ -5,14 +5,21 @@ struct ObjectDetectionItem {
     uint8_t index;
     const char* objectName;
     uint8_t filter;
+    // Post-filter limits, box area as a fraction of the NN frame and
+    // aspect ratio as width/height in NN pixels
+    float minArea;
+    float maxArea;
+    float minAspect;
+    float maxAspect;
 };
 
 // List of objects the pre-trained model is capable of recognizing
 // Index number is fixed and hard-coded from training
 // Set the filter value to 0 to ignore any recognized objects
-ObjectDetectionItem itemList[3] = {
-    {0,  "led_on",         1},
-    {1,  "motherboard",        1},
+// constexpr so the detection post-filter table is built at compile time
+constexpr ObjectDetectionItem itemList[3] = {
+    {0,  "led_on",         1,   0.0f,    0.10f,   0.25f,   4.0f},
+    {1,  "motherboard",        1,   0.01f,   1.00f,   0.25f,   4.0f},
 };
 
 #endif
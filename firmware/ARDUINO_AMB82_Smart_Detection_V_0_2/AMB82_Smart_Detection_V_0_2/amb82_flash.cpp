@@ -1,9 +1,70 @@
 // amb82_flash.cpp - Flash Memory Operations Implementation
 #include "amb82_flash.h"
 
+// Slot layout, see amb82_flash.h
+#define CONFIG_SLOT_TAG         0x53000001      // 'S' + slot layout
+#define CONFIG_WORDS            (sizeof(system_config_t) / 4)
+#define CONFIG_CHECKSUM_WORD    (offsetof(system_config_t, checksum) / 4)
+#define CONFIG_DELTA_SIZE       8               // Value, then commit word
+#define CONFIG_DELTA_RECORDS    ((FLASH_SECTOR_DATA_SIZE - FLASH_CONFIG_SIZE) / CONFIG_DELTA_SIZE)
+#define CONFIG_FIRST_SLOT       1               // Slot A holds the legacy copy until B is valid
+
+// The configuration must fit its image area, the slots in front of the checkpoints
+static_assert(sizeof(system_config_t) <= FLASH_CONFIG_SIZE, "system_config_t outgrew its flash area");
+static_assert(offsetof(system_config_t, checksum) + 4 == sizeof(system_config_t),
+              "the checksum must be the last config word, its delta record commits a save");
+static_assert(CONFIG_WORDS < 0xFF, "config word indexes must fit a delta record's top byte");
+static_assert(FLASH_CONFIG_OFFSET + FLASH_CONFIG_SLOTS * FLASH_SECTOR_SIZE <= FLASH_CHECKPOINT_OFFSET,
+              "config slots overlap the checkpoint slots");
+static_assert(sizeof(system_config_v2_t) == 80, "system_config_v2_t must match the version 2 flash layout");
+static_assert(sizeof(log_packed_t) <= 20, "packed log records must stay within 20 bytes");
+static_assert(sizeof(log_summary_t) == 32, "log sector summaries are 8 words");
+
 // ===== GLOBAL VARIABLES =====
 static bool flash_initialized = false;
-static uint32_t current_log_index = 0;
+static flash_wear_area_t config_area;
+static flash_wear_area_t log_area;
+static system_config_t config_flash;        // What the slot in use reads back as
+static config_store_stats_t config_stats;
+static bool config_dirty = false;
+static uint32_t config_dirty_ms = 0;        // Last settings change
+
+// Per sector, meaningful for the log_chain sectors from log_tail_sector on
+typedef struct {
+    uint32_t sequence;              // Sector sequence, 0 = not in the log
+    uint32_t first_sequence;        // Of its first record
+    uint16_t records;               // Used slots, torn ones included
+    bool summary_valid;             // summary covers every record, read or built on first use
+    log_summary_t summary;
+} log_sector_t;
+
+// An event still taking hits
+typedef struct {
+    log_event_t event;              // hits 0 = slot free
+    detection_result_t last;        // Newest hit, the next one must overlap it
+} log_open_event_t;
+
+static log_sector_t log_sectors[FLASH_LOG_SECTORS];
+static uint16_t log_tail_sector = 0;        // Oldest sector of the log
+static uint16_t log_chain = 0;              // Sectors in the log, newest last
+static bool log_sector_open = false;        // Newest sector takes more records
+static uint32_t log_count = 0;              // Records in the log, torn ones included
+static uint32_t log_sequence = 0;           // Of the newest record
+static uint32_t log_sector_sequence = 0;    // Of the newest started sector
+static uint32_t log_head_timestamp = 0;     // Decoded, of the newest record in the open sector
+static uint16_t log_cache_sector = UINT16_MAX;     // Last timestamp walk, reads in order continue it
+static uint16_t log_cache_slot = 0;
+static uint32_t log_cache_timestamp = 0;
+static uint32_t log_recovery_reads = 0;     // Words read to find the write position at boot
+static uint16_t log_scanned_sectors = 0;    // Summaries built from the records since boot
+static log_event_t log_stage[FLASH_LOG_STAGE_RECORDS];
+static uint8_t log_staged = 0;
+static uint32_t log_stage_first_ms = 0;     // When the oldest staged record came in
+static flash_log_stats_t log_stats;
+static log_open_event_t log_open_events[FLASH_LOG_OPEN_EVENTS];
+
+static void log_recover();
+static void config_recover();
 
 // ===== FLASH INITIALIZATION =====
 flash_result_t flash_init() {
@@ -24,13 +85,20 @@ flash_result_t flash_init() {
         return FLASH_ERROR_INIT;
     }
     
-    // Load current log index
-    current_log_index = flash_get_log_count();
+    // Before the first checksum, not on the detection path
+    crc32_init();
+    
+    // Config slot in use, then the write position of the log journal
+    flash_wear_init(&config_area, "Config", FLASH_CONFIG_OFFSET, FLASH_CONFIG_SLOTS);
+    config_area.design_load = "24 saves a day of 4 words";
+    config_area.design_erases_per_day = 24.0f * 4 / CONFIG_DELTA_RECORDS / FLASH_CONFIG_SLOTS;
+    config_recover();
+    log_recover();
     
     flash_initialized = true;
     INFO_PRINT("Flash memory initialized successfully");
     INFO_PRINT("Max log entries: " + String(MAX_LOG_ENTRIES));
-    INFO_PRINT("Current log count: " + String(current_log_index));
+    INFO_PRINT("Current log count: " + String(log_count) + " (found in " + String(log_recovery_reads) + " reads)");
     
     return FLASH_SUCCESS;
 }
@@ -39,34 +107,259 @@ bool flash_is_initialized() {
     return flash_initialized;
 }
 
+// ===== CONFIGURATION SLOTS =====
+// Commit word of a delta record: word index in the top byte, CRC-32 of
+// index and value below it; 0xFF is never an index, so erased is never valid
+static uint32_t config_delta_commit(uint32_t index, uint32_t value) {
+    uint32_t record[2] = {index, value};
+    return (index << 24) | (crc32(record, sizeof(record)) & 0x00FFFFFF);
+}
+
+static uint32_t config_delta_offset(uint8_t slot, uint16_t record) {
+    return flash_wear_data_offset(&config_area, slot) + FLASH_CONFIG_SIZE + (uint32_t)record * CONFIG_DELTA_SIZE;
+}
+
+// Full image, then the deltas of every save that completed; false if the
+// image itself is incomplete
+static bool config_read_slot(uint8_t slot, system_config_t* config, uint16_t* deltas, bool* torn) {
+    uint32_t base = flash_wear_data_offset(&config_area, slot);
+    uint32_t* words = (uint32_t*)config;
+    for (uint32_t i = 0; i < CONFIG_WORDS; i++) {
+        words[i] = FlashMemory.readWord(base + i * 4);
+    }
+    if (!config_validate_checksum(config)) {
+        return false;
+    }
+
+    system_config_t working = *config;
+    uint32_t* working_words = (uint32_t*)&working;
+    *deltas = 0;
+    *torn = false;
+    for (uint16_t record = 0; record < CONFIG_DELTA_RECORDS; record++) {
+        uint32_t offset = config_delta_offset(slot, record);
+        uint32_t value = FlashMemory.readWord(offset);
+        uint32_t commit = FlashMemory.readWord(offset + 4);
+        if (value == 0xFFFFFFFF && commit == 0xFFFFFFFF) {
+            break;
+        }
+        *deltas = record + 1;
+
+        uint32_t index = commit >> 24;
+        if (index >= CONFIG_WORDS || commit != config_delta_commit(index, value)) {
+            *torn = true;
+            continue;
+        }
+        working_words[index] = value;
+        if (index == CONFIG_CHECKSUM_WORD && config_validate_checksum(&working)) {
+            *config = working;
+            *torn = false;
+        }
+    }
+
+    // Words of a save whose checksum never made it
+    if (memcmp(&working, config, sizeof(system_config_t)) != 0) {
+        *torn = true;
+    }
+    return true;
+}
+
+// Newest slot with a complete image, sequence numbers compare wrap-safe
+static void config_recover() {
+    config_stats.generation = 0;
+    config_stats.slot = 0;
+    config_stats.deltas = 0;
+    config_stats.compact_pending = false;
+    memset(&config_flash, 0xFF, sizeof(config_flash));
+
+    system_config_t candidate;
+    for (uint8_t slot = 0; slot < FLASH_CONFIG_SLOTS; slot++) {
+        flash_sector_header_t header;
+        if (!flash_wear_read_header(&config_area, slot, &header) || header.tag != CONFIG_SLOT_TAG) {
+            continue;
+        }
+        if (config_stats.generation != 0 && (int32_t)(header.sequence - config_stats.generation) <= 0) {
+            continue;
+        }
+
+        uint16_t deltas;
+        bool torn;
+        if (!config_read_slot(slot, &candidate, &deltas, &torn)) {
+            DEBUG_PRINT(1, "Config slot " + String(slot ? "B" : "A") + " generation " + String(header.sequence) +
+                           " incomplete, skipped");
+            continue;
+        }
+        config_flash = candidate;
+        config_stats.generation = header.sequence;
+        config_stats.slot = slot;
+        config_stats.deltas = deltas;
+        config_stats.compact_pending = torn;
+    }
+}
+
+// Changed words in ascending order, so the checksum word commits the save
+static flash_result_t config_append_deltas() {
+    const uint32_t* words = (const uint32_t*)&system_config;
+    const uint32_t* held = (const uint32_t*)&config_flash;
+
+    for (uint32_t i = 0; i < CONFIG_WORDS; i++) {
+        if (words[i] == held[i]) {
+            continue;
+        }
+        uint32_t offset = config_delta_offset(config_stats.slot, config_stats.deltas++);
+        uint32_t commit = config_delta_commit(i, words[i]);
+        FlashMemory.writeWord(offset, words[i]);
+        FlashMemory.writeWord(offset + 4, commit);
+        config_stats.words_written += 2;
+
+        if (FlashMemory.readWord(offset) != words[i] || FlashMemory.readWord(offset + 4) != commit) {
+            config_stats.compact_pending = true;
+            return FLASH_ERROR_VERIFY;
+        }
+    }
+    return FLASH_SUCCESS;
+}
+
+// Full image into the other slot under the next generation, checksum last;
+// the slot in use stays valid until then
+static flash_result_t config_compact() {
+    uint8_t slot = config_stats.generation ? (config_stats.slot + 1) % FLASH_CONFIG_SLOTS : CONFIG_FIRST_SLOT;
+    uint32_t generation = config_stats.generation + 1;
+    uint32_t base = flash_wear_data_offset(&config_area, slot);
+    const uint32_t* words = (const uint32_t*)&system_config;
+
+    // Erased words need no programming, the checksum word goes last
+    flash_wear_erase(&config_area, slot, CONFIG_SLOT_TAG, generation);
+    for (uint32_t i = 0; i < CONFIG_WORDS; i++) {
+        if (words[i] != 0xFFFFFFFF) {
+            FlashMemory.writeWord(base + i * 4, words[i]);
+            config_stats.words_written++;
+        }
+    }
+
+    for (uint32_t i = 0; i < CONFIG_WORDS; i++) {
+        if (FlashMemory.readWord(base + i * 4) != words[i]) {
+            ERROR_PRINT("Config slot " + String(slot ? "B" : "A") + " verification failed");
+            return FLASH_ERROR_VERIFY;
+        }
+    }
+
+    config_stats.generation = generation;
+    config_stats.slot = slot;
+    config_stats.deltas = 0;
+    config_stats.compact_pending = false;
+    config_stats.compactions++;
+    DEBUG_PRINT(2, "Config slot " + String(slot ? "B" : "A") + " now in use, generation " + String(generation));
+    return FLASH_SUCCESS;
+}
+
+// Before the slots: one version 2 copy at FLASH_CONFIG_LEGACY_OFFSET,
+// migrated and moved to slot B
+static flash_result_t config_load_legacy() {
+    uint32_t words[sizeof(system_config_v2_t) / 4];
+    for (uint32_t i = 0; i < sizeof(system_config_v2_t) / 4; i++) {
+        words[i] = FlashMemory.readWord(FLASH_CONFIG_LEGACY_OFFSET + (i * 4));
+    }
+    system_config_v2_t old_config;
+    memcpy(&old_config, words, sizeof(old_config));
+    
+    // Validate version
+    if (old_config.config_version != CONFIG_VERSION_SINGLE_COPY) {
+        INFO_PRINT("No configuration in flash, using defaults");
+        return config_reset_to_defaults();
+    }
+    
+    // Validate checksum
+    if (config_v2_checksum(&old_config) != old_config.checksum) {
+        ERROR_PRINT("Configuration checksum validation failed!");
+        return config_reset_to_defaults();
+    }
+    
+    INFO_PRINT("Version 2 config, migrating it to the A/B slots");
+    config_migrate_v2(&old_config, &system_config);
+    return config_save_to_flash();
+}
+
+// Settings the version 2 layout did not have keep their defaults
+void config_migrate_v2(const system_config_v2_t* old_config, system_config_t* config) {
+    system_config_t migrated = DEFAULT_CONFIG;
+    migrated.system_id = old_config->system_id;
+    migrated.lora_send_interval = old_config->lora_send_interval;
+    migrated.lora_retry_count = old_config->lora_retry_count;
+    migrated.lora_timeout = old_config->lora_timeout;
+    migrated.lora_enabled = old_config->lora_enabled;
+    migrated.detection_threshold = old_config->detection_threshold;
+    migrated.motherboard_threshold = old_config->motherboard_threshold;
+    migrated.detection_enabled = old_config->detection_enabled;
+    migrated.crosshair_enabled = old_config->crosshair_enabled;
+    
+    // The motherboard counter became the class counter of its class, windows in seconds
+    class_counter_config_t* counter = &migrated.class_counters[CLASS_MOTHERBOARD];
+    counter->enabled = old_config->motherboard_count_enabled ? 1 : 0;
+    counter->count_threshold = min(old_config->motherboard_count_threshold, (uint32_t)CLASS_COUNTER_MAX_THRESHOLD);
+    counter->window_s = constrain((old_config->motherboard_count_window_ms + 500) / 1000, (uint32_t)1,
+                                  (uint32_t)CLASS_COUNTER_MAX_WINDOW);
+    
+    migrated.fan_cycle_interval = old_config->fan_cycle_interval;
+    migrated.fan_enabled = old_config->fan_enabled;
+    migrated.laser_blink_interval = old_config->laser_blink_interval;
+    migrated.debug_level = old_config->debug_level;
+    migrated.serial_commands_enabled = old_config->serial_commands_enabled;
+    migrated.total_detections = old_config->total_detections;
+    migrated.system_uptime = old_config->system_uptime;
+    migrated.total_motherboard_count_triggers = old_config->total_motherboard_count_triggers;
+    migrated.last_motherboard_trigger_time = old_config->last_motherboard_trigger_time;
+    *config = migrated;
+}
+
 // ===== CONFIGURATION MANAGEMENT =====
 flash_result_t config_save_to_flash() {
     if (!flash_initialized) {
         return FLASH_ERROR_INIT;
     }
     
-    INFO_PRINT("Saving configuration to flash...");
+    // Usually the last write before a reset
+    flash_log_flush();
+    config_dirty = false;
     
     // Calculate and set checksum
     system_config.checksum = config_calculate_checksum(&system_config);
     
-    // Write configuration structure word by word
-    uint32_t* config_ptr = (uint32_t*)&system_config;
-    uint32_t config_size = sizeof(system_config_t);
-    uint32_t word_count = (config_size + 3) / 4; // Round up to word boundary
+    const uint32_t* words = (const uint32_t*)&system_config;
+    const uint32_t* held = (const uint32_t*)&config_flash;
+    uint16_t changed = 0;
+    for (uint32_t i = 0; i < CONFIG_WORDS; i++) {
+        changed += words[i] != held[i] ? 1 : 0;
+    }
+    if (changed == 0) {
+        config_stats.unchanged++;
+        DEBUG_PRINT(2, "Configuration unchanged, nothing to save");
+        return FLASH_SUCCESS;
+    }
+    
+    INFO_PRINT("Saving configuration to flash...");
+    uint32_t start_us = micros();
+    uint32_t words_before = config_stats.words_written;
     
-    for (uint32_t i = 0; i < word_count; i++) {
-        FlashMemory.writeWord(FLASH_CONFIG_OFFSET + (i * 4), config_ptr[i]);
+    flash_result_t result = FLASH_ERROR_WRITE;
+    if (config_stats.generation != 0 && !config_stats.compact_pending &&
+        config_stats.deltas + changed <= CONFIG_DELTA_RECORDS) {
+        result = config_append_deltas();
+    }
+    if (result != FLASH_SUCCESS) {
+        result = config_compact();
     }
     
-    // Verify write operation
-    flash_result_t verify_result = config_load_from_flash();
-    if (verify_result != FLASH_SUCCESS) {
-        ERROR_PRINT("Configuration save verification failed!");
-        return FLASH_ERROR_VERIFY;
+    config_stats.last_words = config_stats.words_written - words_before;
+    config_stats.last_duration_us = micros() - start_us;
+    if (result != FLASH_SUCCESS) {
+        ERROR_PRINT("Configuration save failed, flash keeps the previous one");
+        return result;
     }
     
-    INFO_PRINT("Configuration saved successfully");
+    config_flash = system_config;
+    config_stats.saves++;
+    INFO_PRINT("Configuration saved successfully (" + String(changed) + " words changed, " +
+               String(config_stats.last_words) + " programmed in " + String(config_stats.last_duration_us) + "us)");
     return FLASH_SUCCESS;
 }
 
@@ -76,35 +369,24 @@ flash_result_t config_load_from_flash() {
     }
     
     INFO_PRINT("Loading configuration from flash...");
-    
-    // Create temporary config structure
-    system_config_t temp_config;
-    
-    // Read configuration structure word by word
-    uint32_t* config_ptr = (uint32_t*)&temp_config;
-    uint32_t config_size = sizeof(system_config_t);
-    uint32_t word_count = (config_size + 3) / 4; // Round up to word boundary
-    
-    for (uint32_t i = 0; i < word_count; i++) {
-        config_ptr[i] = FlashMemory.readWord(FLASH_CONFIG_OFFSET + (i * 4));
+    config_recover();
+    if (config_stats.generation == 0) {
+        return config_load_legacy();
     }
     
-    // Validate version
-    if (temp_config.config_version != CONFIG_VERSION) {
+    // Validate version, the next save writes a full image in this layout
+    if (config_flash.config_version != CONFIG_VERSION) {
         INFO_PRINT("Config version mismatch, using defaults");
-        return config_reset_to_defaults();
-    }
-    
-    // Validate checksum
-    if (!config_validate_checksum(&temp_config)) {
-        ERROR_PRINT("Configuration checksum validation failed!");
+        config_stats.compact_pending = true;
         return config_reset_to_defaults();
     }
     
     // Copy validated config to global
-    system_config = temp_config;
+    system_config = config_flash;
     
-    INFO_PRINT("Configuration loaded successfully");
+    INFO_PRINT("Configuration loaded from slot " + String(config_stats.slot ? "B" : "A") + ", generation " +
+               String(config_stats.generation) + ", " + String(config_stats.deltas) + " deltas" +
+               (config_stats.compact_pending ? ", an interrupted save dropped" : ""));
     return FLASH_SUCCESS;
 }
 
@@ -120,9 +402,14 @@ flash_result_t config_reset_to_defaults() {
 }
 
 uint32_t config_calculate_checksum(system_config_t* config) {
+    return crc32(config, offsetof(system_config_t, checksum));
+}
+
+// Version 2: byte by byte add and xor-shift
+uint32_t config_v2_checksum(const system_config_v2_t* config) {
     uint32_t checksum = 0;
-    uint8_t* data = (uint8_t*)config;
-    uint32_t size = sizeof(system_config_t) - sizeof(config->checksum); // Exclude checksum field
+    const uint8_t* data = (const uint8_t*)config;
+    uint32_t size = offsetof(system_config_v2_t, checksum);
     
     for (uint32_t i = 0; i < size; i++) {
         checksum += data[i];
@@ -137,60 +424,624 @@ bool config_validate_checksum(system_config_t* config) {
     return (calculated_checksum == config->checksum);
 }
 
-// ===== DETECTION LOG MANAGEMENT =====
-flash_result_t flash_write_detection_log(detection_result_t* result) {
-    if (!flash_initialized || !result) {
-        return FLASH_ERROR_INIT;
+// ===== CONFIGURATION AUTOSAVE =====
+void config_mark_dirty() {
+    config_dirty = true;
+    config_dirty_ms = millis();
+}
+
+bool config_is_dirty() {
+    return config_dirty;
+}
+
+// A burst of settings commands costs one save
+void config_process() {
+    if (!config_dirty || millis() - config_dirty_ms < CONFIG_AUTOSAVE_DELAY_MS) {
+        return;
+    }
+    DEBUG_PRINT(2, "Autosaving configuration");
+    config_save_to_flash();
+}
+
+const config_store_stats_t* config_get_store_stats() {
+    return &config_stats;
+}
+
+// ===== PACKED RECORD CODEC =====
+#define LOG_PACKED_MARKER       0xC0000000      // Both set: slot unused
+#define LOG_PACKED_VALID        0x80000000
+#define LOG_PACKED_SECONDS      0x00020000
+#define LOG_PACKED_DELTA_MAX    0x0001FFFF
+#define LOG_PACKED_DELTA_SIGN   0x00010000
+#define LOG_PACKED_BOX_SCALE    65534.0f        // 0xFFFF stays the erased value
+#define LOG_PACKED_LONG         0x00008000      // Duration in 10s units
+#define LOG_PACKED_DURATION_MAX 0x7FFF
+
+static uint32_t log_quantize(float value, float scale) {
+    return (uint32_t)(constrain(value, 0.0f, 1.0f) * scale + 0.5f);
+}
+
+// Two's complement in uint32_t for a negative delta
+static uint32_t log_packed_delta(uint32_t word) {
+    uint32_t delta = word & LOG_PACKED_DELTA_MAX;
+    if (delta & LOG_PACKED_DELTA_SIGN) {
+        delta |= ~(uint32_t)LOG_PACKED_DELTA_MAX;
+    }
+    return (word & LOG_PACKED_SECONDS) ? delta * 1000 : delta;
+}
+
+bool flash_log_encode(const log_event_t* event, uint32_t previous_timestamp, log_packed_t* packed) {
+    const detection_result_t* entry = &event->detection;
+    int32_t delta = (int32_t)(entry->timestamp - previous_timestamp);
+    int32_t range = LOG_PACKED_DELTA_SIGN;
+    uint32_t word;
+    if (delta >= -range && delta < range) {
+        word = (uint32_t)delta & LOG_PACKED_DELTA_MAX;
+    } else if (delta / 1000 >= -range && delta / 1000 < range) {
+        word = LOG_PACKED_SECONDS | ((uint32_t)(delta / 1000) & LOG_PACKED_DELTA_MAX);
+    } else {
+        return false;
     }
     
-    // Check if log buffer is full
-    if (current_log_index >= MAX_LOG_ENTRIES) {
-        // Implement circular buffer - overwrite oldest entry
-        current_log_index = 0;
-        DEBUG_PRINT(3, "Log buffer full, wrapping to beginning");
+    // Merging keeps events within both limits, saturate all the same
+    uint32_t duration = event->last_timestamp - entry->timestamp;
+    uint32_t span = duration / 100;
+    if (span > LOG_PACKED_DURATION_MAX) {
+        span = LOG_PACKED_LONG | min(duration / 10000, (uint32_t)LOG_PACKED_DURATION_MAX);
     }
+    uint32_t hits = constrain((uint32_t)event->hits, (uint32_t)1, (uint32_t)LOG_EVENT_MAX_HITS);
     
-    // Calculate log entry offset
-    uint32_t log_offset = FLASH_LOG_OFFSET + (current_log_index * sizeof(detection_result_t));
+    uint32_t object_class = min((uint32_t)entry->object_class, (uint32_t)0xF);
+    packed->words[0] = word | (entry->valid ? LOG_PACKED_VALID : 0) | (object_class << 26) |
+                       (log_quantize(entry->confidence, 255.0f) << 18);
+    packed->words[1] = log_quantize(entry->x_min, LOG_PACKED_BOX_SCALE) |
+                       (log_quantize(entry->y_min, LOG_PACKED_BOX_SCALE) << 16);
+    packed->words[2] = log_quantize(entry->x_max, LOG_PACKED_BOX_SCALE) |
+                       (log_quantize(entry->y_max, LOG_PACKED_BOX_SCALE) << 16);
+    packed->words[3] = (hits << 16) | span;
+    packed->words[4] = crc32(packed->words, 4 * 4);
+    return true;
+}
+
+bool flash_log_decode(const log_packed_t* packed, uint32_t previous_timestamp, log_event_t* event) {
+    uint32_t word = packed->words[0];
+    if ((word & LOG_PACKED_MARKER) == LOG_PACKED_MARKER || packed->words[4] != crc32(packed->words, 4 * 4)) {
+        return false;
+    }
     
-    // Write log entry word by word
-    uint32_t* log_ptr = (uint32_t*)result;
-    uint32_t log_size = sizeof(detection_result_t);
-    uint32_t word_count = (log_size + 3) / 4; // Round up to word boundary
+    detection_result_t* entry = &event->detection;
+    uint8_t object_class = (word >> 26) & 0xF;
+    entry->timestamp = previous_timestamp + log_packed_delta(word);
+    entry->object_class = object_class == 0xF ? CLASS_UNKNOWN : object_class;
+    entry->confidence = ((word >> 18) & 0xFF) / 255.0f;
+    entry->x_min = (packed->words[1] & 0xFFFF) / LOG_PACKED_BOX_SCALE;
+    entry->y_min = (packed->words[1] >> 16) / LOG_PACKED_BOX_SCALE;
+    entry->x_max = (packed->words[2] & 0xFFFF) / LOG_PACKED_BOX_SCALE;
+    entry->y_max = (packed->words[2] >> 16) / LOG_PACKED_BOX_SCALE;
+    entry->valid = (word & LOG_PACKED_VALID) ? 1 : 0;
     
-    for (uint32_t i = 0; i < word_count; i++) {
-        FlashMemory.writeWord(log_offset + (i * 4), log_ptr[i]);
+    uint32_t span = packed->words[3] & LOG_PACKED_DURATION_MAX;
+    event->hits = (packed->words[3] >> 16) & LOG_EVENT_MAX_HITS;
+    event->last_timestamp = entry->timestamp + ((packed->words[3] & LOG_PACKED_LONG) ? span * 10000 : span * 100);
+    return true;
+}
+
+// ===== DETECTION LOG JOURNAL =====
+static uint16_t log_ring_sector(uint16_t position) {
+    return (log_tail_sector + position) % FLASH_LOG_SECTORS;
+}
+
+static uint32_t log_slot_offset(uint16_t sector, uint16_t slot) {
+    return flash_wear_data_offset(&log_area, sector) + sizeof(log_sector_preamble_t) + slot * sizeof(log_packed_t);
+}
+
+static uint32_t log_recovery_read(uint32_t offset) {
+    log_recovery_reads++;
+    return FlashMemory.readWord(offset);
+}
+
+// Header of a log sector
+static bool log_read_sector(uint16_t sector, log_sector_t* info) {
+    flash_sector_header_t header;
+    memset(info, 0, sizeof(log_sector_t));
+    log_recovery_reads += sizeof(flash_sector_header_t) / 4;
+    if (!flash_wear_read_header(&log_area, sector, &header) || header.sequence == 0 || header.tag != LOG_JOURNAL_TAG) {
+        return false;
+    }
+    info->sequence = header.sequence;
+    return true;
+}
+
+// 0xFFFFFFFF if the sector never got its preamble
+static uint32_t log_read_first_sequence(uint16_t sector) {
+    return log_recovery_read(flash_wear_data_offset(&log_area, sector));
+}
+
+// Decoded timestamp of the record before a slot of a sector, the
+// sector's base for slot 0. Walks the deltas, continuing the last walk when
+// it can, so reading a sector in order costs one word per record.
+static uint32_t log_timestamp_before(uint16_t sector, uint16_t slot) {
+    uint32_t base = FlashMemory.readWord(flash_wear_data_offset(&log_area, sector) + 4);
+    if (slot == 0) {
+        return base;
     }
     
-    current_log_index++;
+    uint16_t from = 0;
+    uint32_t timestamp = base;
+    if (log_cache_sector == sector && log_cache_slot < slot) {
+        from = log_cache_slot + 1;
+        timestamp = log_cache_timestamp;
+    }
+    for (uint16_t i = from; i < slot; i++) {
+        // Bytes are programmed lowest first, so a word 0 torn mid-program
+        // still has its marker erased and its delta is not taken
+        uint32_t word = FlashMemory.readWord(log_slot_offset(sector, i));
+        if ((word & LOG_PACKED_MARKER) != LOG_PACKED_MARKER) {
+            timestamp += log_packed_delta(word);
+        }
+    }
+    
+    log_cache_sector = sector;
+    log_cache_slot = slot - 1;
+    log_cache_timestamp = timestamp;
+    return timestamp;
+}
+
+// ===== DETECTION LOG SUMMARIES =====
+static uint32_t log_summary_offset(uint16_t sector) {
+    return flash_wear_data_offset(&log_area, sector) + FLASH_SECTOR_DATA_SIZE - sizeof(log_summary_t);
+}
+
+static void log_summary_clear(log_summary_t* summary) {
+    memset(summary, 0, sizeof(log_summary_t));
+    memset(summary->reserved, 0xFF, sizeof(summary->reserved));
+    summary->first_timestamp = 0xFFFFFFFF;
+}
+
+static void log_summary_add(log_summary_t* summary, const log_event_t* event) {
+    const detection_result_t* detection = &event->detection;
+    if (detection->valid == 1) {
+        summary->hits[detection->object_class < DETECTION_CLASS_COUNT ? detection->object_class
+                                                                     : DETECTION_CLASS_COUNT] += event->hits;
+    }
+    if (detection->timestamp < summary->first_timestamp) {
+        summary->first_timestamp = detection->timestamp;
+    }
+    if (event->last_timestamp > summary->last_timestamp) {
+        summary->last_timestamp = event->last_timestamp;
+    }
+    uint8_t confidence = log_quantize(detection->confidence, 255.0f);
+    if (confidence > summary->max_confidence) {
+        summary->max_confidence = confidence;
+    }
+    summary->events++;
+}
+
+static void log_summary_merge(log_summary_t* total, const log_summary_t* part) {
+    for (uint8_t bucket = 0; bucket < LOG_SUMMARY_CLASSES; bucket++) {
+        total->hits[bucket] += part->hits[bucket];
+    }
+    if (part->events > 0) {
+        total->first_timestamp = min(total->first_timestamp, part->first_timestamp);
+        total->last_timestamp = max(total->last_timestamp, part->last_timestamp);
+    }
+    total->max_confidence = max(total->max_confidence, part->max_confidence);
+    total->slots += part->slots;
+    total->events += part->events;
+}
+
+// Written and for the records the sector holds now, false if not
+static bool log_read_summary(uint16_t sector, log_summary_t* summary) {
+    uint32_t* words = (uint32_t*)summary;
+    for (uint32_t i = 0; i < sizeof(log_summary_t) / 4; i++) {
+        words[i] = FlashMemory.readWord(log_summary_offset(sector) + i * 4);
+    }
+    return summary->checksum == crc32(summary, offsetof(log_summary_t, checksum)) &&
+           summary->slots == log_sectors[sector].records;
+}
+
+// Only into erased words, a summary cut short stays and the sector is read
+// through after the next boot
+static void log_write_summary(uint16_t sector, const log_summary_t* summary) {
+    uint32_t offset = log_summary_offset(sector);
+    for (uint32_t i = 0; i < sizeof(log_summary_t) / 4; i++) {
+        if (FlashMemory.readWord(offset + i * 4) != 0xFFFFFFFF) {
+            return;
+        }
+    }
+    
+    log_summary_t record = *summary;
+    record.checksum = crc32(&record, offsetof(log_summary_t, checksum));
+    const uint32_t* words = (const uint32_t*)&record;
+    for (uint32_t i = 0; i < sizeof(log_summary_t) / 4; i++) {
+        FlashMemory.writeWord(offset + i * 4, words[i]);
+    }
+}
+
+// Every record of the sector at a position of the log, in order
+static void log_scan_summary(uint16_t position, log_summary_t* summary) {
+    uint32_t first = 0;
+    for (uint16_t before = 0; before < position; before++) {
+        first += log_sectors[log_ring_sector(before)].records;
+    }
+    
+    log_summary_clear(summary);
+    summary->slots = log_sectors[log_ring_sector(position)].records;
+    log_event_t event;
+    for (uint32_t index = first; index < first + summary->slots; index++) {
+        if (flash_read_log_event(index, &event) == FLASH_SUCCESS) {
+            log_summary_add(summary, &event);
+        }
+    }
+    log_scanned_sectors++;
+}
+
+// Summary of the sector at a position of the log: kept in RAM, read from the
+// sector once it is closed, or built from its records
+static const log_summary_t* log_sector_summary(uint16_t position) {
+    uint16_t sector = log_ring_sector(position);
+    log_sector_t* info = &log_sectors[sector];
+    if (info->summary_valid) {
+        return &info->summary;
+    }
+    
+    bool closed = !(log_sector_open && position == log_chain - 1);
+    if (!closed || !log_read_summary(sector, &info->summary)) {
+        log_scan_summary(position, &info->summary);
+        if (closed) {
+            log_write_summary(sector, &info->summary);
+        }
+    }
+    info->summary_valid = true;
+    return &info->summary;
+}
+
+// The sector takes no more records
+static void log_seal_sector(uint16_t position) {
+    log_write_summary(log_ring_sector(position), log_sector_summary(position));
+}
+
+static void log_recover() {
+    flash_wear_init(&log_area, "Log", FLASH_LOG_OFFSET, FLASH_LOG_SECTORS);
+    log_area.design_erases_per_day = 86400.0f / MAX_LOG_ENTRIES;    // Once per lap
+    log_area.design_load = "1 record/s";
+    
+    log_recovery_reads = 0;
+    log_scanned_sectors = 0;
+    log_staged = 0;
+    memset(log_open_events, 0, sizeof(log_open_events));
+    log_tail_sector = 0;
+    log_chain = 0;
+    log_sector_open = false;
+    log_count = 0;
+    log_sequence = 0;
+    log_sector_sequence = 0;
+    log_cache_sector = UINT16_MAX;
+    
+    // Newest sector: the highest sequence
+    int16_t newest = -1;
+    for (uint16_t sector = 0; sector < FLASH_LOG_SECTORS; sector++) {
+        if (log_read_sector(sector, &log_sectors[sector]) &&
+            (newest < 0 || log_sectors[sector].sequence > log_sectors[newest].sequence)) {
+            newest = sector;
+        }
+    }
+    if (newest < 0) {
+        return;
+    }
+    
+    // The log runs back from it while sector sequences count down by one; a
+    // sector whose restart was cut short ends it
+    log_tail_sector = newest;
+    log_chain = 1;
+    while (log_chain < FLASH_LOG_SECTORS) {
+        uint16_t previous = (log_tail_sector + FLASH_LOG_SECTORS - 1) % FLASH_LOG_SECTORS;
+        if (log_sectors[previous].sequence == 0 ||
+            log_sectors[previous].sequence != log_sectors[log_tail_sector].sequence - 1) {
+            break;
+        }
+        log_tail_sector = previous;
+        log_chain++;
+    }
+    
+    // A newest sector without its first record is started over by the next
+    // write, its preamble may have been cut short
+    uint32_t newest_sequence = log_sectors[newest].sequence;
+    log_sectors[newest].first_sequence = log_read_first_sequence(newest);
+    if (log_sectors[newest].first_sequence == 0xFFFFFFFF ||
+        log_recovery_read(log_slot_offset(newest, 0)) == 0xFFFFFFFF) {
+        log_sectors[newest].sequence = 0;
+        log_chain--;
+    }
+    if (log_chain == 0) {
+        log_sector_sequence = newest_sequence;
+        return;
+    }
+    
+    // Used slots are a prefix of the newest sector left
+    uint16_t head_sector = log_ring_sector(log_chain - 1);
+    log_sector_t* head = &log_sectors[head_sector];
+    head->first_sequence = log_read_first_sequence(head_sector);
+    uint16_t low = 0;
+    uint16_t high = LOG_RECORDS_PER_SECTOR;
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        if (log_recovery_read(log_slot_offset(head_sector, mid)) != 0xFFFFFFFF) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    head->records = low;
+    
+    // The others are full up to the next one's first record
+    for (uint16_t position = log_chain - 1; position-- > 0;) {
+        uint16_t sector = log_ring_sector(position);
+        uint32_t next_first = log_sectors[log_ring_sector(position + 1)].first_sequence;
+        uint32_t first = log_read_first_sequence(sector);
+        if (first == 0xFFFFFFFF || first > next_first || next_first - first > LOG_RECORDS_PER_SECTOR) {
+            log_tail_sector = log_ring_sector(position + 1);
+            log_chain -= position + 1;
+            break;
+        }
+        log_sectors[sector].first_sequence = first;
+        log_sectors[sector].records = next_first - first;
+    }
+    
+    head = &log_sectors[log_ring_sector(log_chain - 1)];
+    log_sector_sequence = head->sequence;
+    log_sequence = head->first_sequence + head->records - 1;
+    log_count = log_sequence + 1 - log_sectors[log_tail_sector].first_sequence;
+    
+    // millis() starts over at boot, so this boot's records start a new
+    // sector; the previous boot's head is sealed by the first write
+    log_sector_open = false;
+}
+
+// Next sector of the ring, dropping the oldest one's records if it is full
+static void log_open_sector(const log_event_t* event) {
+    uint16_t sector = log_ring_sector(log_chain);
+    if (log_chain == FLASH_LOG_SECTORS) {
+        log_count -= log_sectors[log_tail_sector].records;
+        log_tail_sector = (log_tail_sector + 1) % FLASH_LOG_SECTORS;
+        log_chain--;
+    }
+    if (log_chain == 0) {
+        log_tail_sector = sector;
+    }
+    
+    flash_wear_erase(&log_area, sector, LOG_JOURNAL_TAG, ++log_sector_sequence);
+    uint32_t offset = flash_wear_data_offset(&log_area, sector);
+    FlashMemory.writeWord(offset, log_sequence + 1);
+    FlashMemory.writeWord(offset + 4, event->detection.timestamp);
+    
+    log_sectors[sector].sequence = log_sector_sequence;
+    log_sectors[sector].first_sequence = log_sequence + 1;
+    log_sectors[sector].records = 0;
+    log_sectors[sector].summary_valid = true;
+    log_summary_clear(&log_sectors[sector].summary);
+    log_chain++;
+    log_sector_open = true;
+    log_head_timestamp = event->detection.timestamp;
+    if (log_cache_sector == sector) {
+        log_cache_sector = UINT16_MAX;
+    }
+}
+
+static void log_program_record(const log_event_t* event) {
+    log_packed_t packed;
+    uint16_t sector = log_ring_sector(log_chain - 1);
+    
+    if (log_sector_open && !flash_log_encode(event, log_head_timestamp, &packed)) {
+        log_sector_open = false;    // Gap too long for a delta
+        log_seal_sector(log_chain - 1);
+    }
+    if (!log_sector_open) {
+        // The head a reboot left without its summary
+        if (log_chain > 0 && !log_sectors[sector].summary_valid) {
+            log_seal_sector(log_chain - 1);
+        }
+        log_open_sector(event);
+        sector = log_ring_sector(log_chain - 1);
+        flash_log_encode(event, log_head_timestamp, &packed);
+    }
+    
+    // Claim the slot with word 0, commit with the CRC
+    log_sector_t* head = &log_sectors[sector];
+    uint32_t log_offset = log_slot_offset(sector, head->records);
+    for (uint32_t i = 0; i < sizeof(log_packed_t) / 4; i++) {
+        FlashMemory.writeWord(log_offset + (i * 4), packed.words[i]);
+    }
+    
+    DEBUG_PRINT(3, "Detection log written: sector=" + String(sector) + ", slot=" + String(head->records) +
+                   ", seq=" + String(log_sequence + 1) +
+                   ", class=" + String(event->detection.object_class) + 
+                   ", confidence=" + String(event->detection.confidence) +
+                   ", hits=" + String(event->hits));
+    
+    // Summarized as it reads back
+    log_event_t programmed;
+    if (head->summary_valid) {
+        if (flash_log_decode(&packed, log_head_timestamp, &programmed)) {
+            log_summary_add(&head->summary, &programmed);
+        }
+        head->summary.slots++;
+    }
+    
+    log_head_timestamp += log_packed_delta(packed.words[0]);
+    log_sequence++;
+    log_count++;
+    head->records++;
+    if (head->records == LOG_RECORDS_PER_SECTOR) {
+        log_sector_open = false;
+        log_seal_sector(log_chain - 1);
+    }
+}
+
+static void log_flush_stage(flash_log_flush_reason_t reason) {
+    if (log_staged == 0) {
+        return;
+    }
+    
+    uint32_t start_us = micros();
+    for (uint8_t i = 0; i < log_staged; i++) {
+        log_program_record(&log_stage[i]);
+    }
+    uint32_t elapsed_us = micros() - start_us;
+    
+    log_stats.flushes[reason]++;
+    log_stats.flushed_records += log_staged;
+    log_stats.flush_time_us += elapsed_us;
+    log_stats.flush_max_us = max(log_stats.flush_max_us, elapsed_us);
+    DEBUG_PRINT(3, "Detection log flushed: " + String(log_staged) + " records in " + String(elapsed_us) + "us");
+    log_staged = 0;
+}
+
+static void log_stage_event(const log_event_t* event) {
+    // More closed events at once than the stage holds
+    if (log_staged == FLASH_LOG_STAGE_RECORDS) {
+        log_flush_stage(FLASH_LOG_FLUSH_FULL);
+    }
+    
+    if (log_staged == 0) {
+        log_stage_first_ms = millis();
+    }
+    log_stage[log_staged++] = *event;
+    log_stats.staged_records++;
+    log_stats.staged_hits += event->hits;
+}
+
+// ===== DETECTION LOG EVENTS =====
+static void log_event_start(log_event_t* event, const detection_result_t* result) {
+    event->detection = *result;
+    event->last_timestamp = result->timestamp;
+    event->hits = 1;
+}
+
+// Same class and validity, box overlapping the event's newest hit
+static bool log_event_matches(const log_open_event_t* open, const detection_result_t* result) {
+    const detection_result_t* last = &open->last;
+    return open->event.hits > 0 && last->object_class == result->object_class && last->valid == result->valid &&
+           result->x_min <= last->x_max && result->x_max >= last->x_min &&
+           result->y_min <= last->y_max && result->y_max >= last->y_min;
+}
+
+static bool log_event_takes(const log_open_event_t* open, const detection_result_t* result, uint32_t gap_ms) {
+    const log_event_t* event = &open->event;
+    return (int32_t)(result->timestamp - event->last_timestamp) <= (int32_t)gap_ms &&
+           result->timestamp - event->detection.timestamp <= LOG_EVENT_MAX_MS && event->hits < LOG_EVENT_MAX_HITS;
+}
+
+static void log_event_merge(log_open_event_t* open, const detection_result_t* result) {
+    detection_result_t* entry = &open->event.detection;
+    entry->confidence = max(entry->confidence, result->confidence);
+    entry->x_min = min(entry->x_min, result->x_min);
+    entry->y_min = min(entry->y_min, result->y_min);
+    entry->x_max = max(entry->x_max, result->x_max);
+    entry->y_max = max(entry->y_max, result->y_max);
+    open->event.last_timestamp = max(open->event.last_timestamp, result->timestamp);
+    open->event.hits++;
+    open->last = *result;
+}
+
+static void log_event_close(log_open_event_t* open) {
+    log_stage_event(&open->event);
+    open->event.hits = 0;
+}
+
+// Events whose last hit is more than the gap before now, all of them with all
+static void log_close_events(uint32_t now, bool all) {
+    int32_t gap_ms = system_config.log_event_gap_s * 1000L;
+    for (uint8_t i = 0; i < FLASH_LOG_OPEN_EVENTS; i++) {
+        log_open_event_t* open = &log_open_events[i];
+        if (open->event.hits > 0 && (all || gap_ms == 0 || (int32_t)(now - open->event.last_timestamp) > gap_ms)) {
+            log_event_close(open);
+        }
+    }
+}
+
+// ===== DETECTION LOG MANAGEMENT =====
+flash_result_t flash_write_detection_log(detection_result_t* result) {
+    if (!flash_initialized || !result) {
+        return FLASH_ERROR_INIT;
+    }
+    
+    uint32_t start_us = micros();
+    uint32_t gap_ms = system_config.log_event_gap_s * 1000UL;
+    log_event_t single;
+    if (gap_ms == 0) {
+        log_event_start(&single, result);
+        log_stage_event(&single);
+    } else {
+        // Merge into a matching event, else start one in a free slot or the stalest
+        log_open_event_t* slot = NULL;
+        bool merged = false;
+        for (uint8_t i = 0; i < FLASH_LOG_OPEN_EVENTS && !merged; i++) {
+            log_open_event_t* open = &log_open_events[i];
+            if (log_event_matches(open, result) && log_event_takes(open, result, gap_ms)) {
+                log_event_merge(open, result);
+                merged = true;
+            } else if (!slot || (slot->event.hits > 0 &&
+                       (open->event.hits == 0 || open->event.last_timestamp - slot->event.last_timestamp > 0x80000000UL))) {
+                slot = open;
+            }
+        }
+        if (!merged) {
+            if (slot->event.hits > 0) {
+                log_event_close(slot);
+            }
+            log_event_start(&slot->event, result);
+            slot->last = *result;
+        }
+    }
     
     // Update statistics
     system_config.total_detections++;
-    
-    DEBUG_PRINT(3, "Detection log written: index=" + String(current_log_index-1) + 
-                   ", class=" + String(result->object_class) + 
-                   ", confidence=" + String(result->confidence));
+    log_stats.detections++;
+    log_stats.stage_time_us += micros() - start_us;
     
     return FLASH_SUCCESS;
 }
 
 flash_result_t flash_read_detection_log(uint32_t index, detection_result_t* result) {
-    if (!flash_initialized || !result || index >= MAX_LOG_ENTRIES) {
+    log_event_t event;
+    if (!result) {
         return FLASH_ERROR_READ;
     }
     
-    // Calculate log entry offset
-    uint32_t log_offset = FLASH_LOG_OFFSET + (index * sizeof(detection_result_t));
-    
-    // Read log entry word by word
-    uint32_t* log_ptr = (uint32_t*)result;
-    uint32_t log_size = sizeof(detection_result_t);
-    uint32_t word_count = (log_size + 3) / 4; // Round up to word boundary
+    flash_result_t read_result = flash_read_log_event(index, &event);
+    if (read_result == FLASH_SUCCESS) {
+        *result = event.detection;
+    }
+    return read_result;
+}
+
+flash_result_t flash_read_log_event(uint32_t index, log_event_t* event) {
+    if (!flash_initialized || !event || index >= log_count + log_staged) {
+        return FLASH_ERROR_READ;
+    }
     
-    for (uint32_t i = 0; i < word_count; i++) {
-        log_ptr[i] = FlashMemory.readWord(log_offset + (i * 4));
+    // Newest records may not be in flash yet
+    if (index >= log_count) {
+        *event = log_stage[index - log_count];
+        return FLASH_SUCCESS;
     }
     
+    // Chronological index to sector and slot
+    uint16_t sector = log_tail_sector;
+    uint32_t slot = index;
+    for (uint16_t position = 0; slot >= log_sectors[sector].records; position++) {
+        slot -= log_sectors[sector].records;
+        sector = log_ring_sector(position + 1);
+    }
+    uint32_t log_offset = log_slot_offset(sector, slot);
+    log_packed_t packed;
+    for (uint32_t i = 0; i < sizeof(log_packed_t) / 4; i++) {
+        packed.words[i] = FlashMemory.readWord(log_offset + (i * 4));
+    }
+    if (!flash_log_decode(&packed, log_timestamp_before(sector, slot), event)) {
+        return FLASH_ERROR_CHECKSUM;
+    }
     return FLASH_SUCCESS;
 }
 
@@ -199,21 +1050,11 @@ uint32_t flash_get_log_count() {
         return 0;
     }
     
-    // Count valid log entries by checking for valid flag
-    uint32_t count = 0;
-    detection_result_t temp_result;
-    
-    for (uint32_t i = 0; i < MAX_LOG_ENTRIES; i++) {
-        if (flash_read_detection_log(i, &temp_result) == FLASH_SUCCESS) {
-            if (temp_result.valid == 1) {
-                count++;
-            } else {
-                break; // Found first invalid entry, stop counting
-            }
-        }
-    }
-    
-    return count;
+    return log_count + log_staged;
+}
+
+uint32_t flash_get_log_sequence() {
+    return log_sequence + log_staged;
 }
 
 flash_result_t flash_clear_logs() {
@@ -223,15 +1064,22 @@ flash_result_t flash_clear_logs() {
     
     INFO_PRINT("Clearing detection logs...");
     
-    // Clear log area by writing zeros
-    uint32_t log_area_size = MAX_LOG_ENTRIES * sizeof(detection_result_t);
-    uint32_t word_count = (log_area_size + 3) / 4;
+    log_staged = 0;
+    memset(log_open_events, 0, sizeof(log_open_events));
     
-    for (uint32_t i = 0; i < word_count; i++) {
-        FlashMemory.writeWord(FLASH_LOG_OFFSET + (i * 4), 0x00000000);
+    // Every sector out of the log, counts kept; the next write restarts sector 0
+    for (uint16_t sector = 0; sector < FLASH_LOG_SECTORS; sector++) {
+        flash_wear_erase(&log_area, sector, LOG_JOURNAL_TAG, 0);
+        log_sectors[sector].sequence = 0;
+        log_sectors[sector].summary_valid = false;
     }
-    
-    current_log_index = 0;
+    log_tail_sector = 0;
+    log_chain = 0;
+    log_count = 0;
+    log_sequence = 0;
+    log_sector_sequence = 0;
+    log_sector_open = false;
+    log_cache_sector = UINT16_MAX;
     system_config.total_detections = 0;
     
     INFO_PRINT("Detection logs cleared");
@@ -243,29 +1091,172 @@ flash_result_t flash_get_log_stats(uint32_t* total_count, uint32_t* led_count, u
         return FLASH_ERROR_READ;
     }
     
+    log_summary_t summary;
+    flash_get_log_summary(&summary);
+    
     *total_count = 0;
-    *led_count = 0;
-    *motherboard_count = 0;
+    for (uint8_t bucket = 0; bucket < LOG_SUMMARY_CLASSES; bucket++) {
+        (*total_count) += summary.hits[bucket];
+    }
+    *led_count = summary.hits[CLASS_LED_ON];
+    *motherboard_count = summary.hits[CLASS_MOTHERBOARD];
     
-    detection_result_t temp_result;
-    uint32_t log_count = flash_get_log_count();
+    return FLASH_SUCCESS;
+}
+
+// ===== DETECTION LOG INDEX =====
+flash_result_t flash_get_log_summary(log_summary_t* summary) {
+    if (!flash_initialized || !summary) {
+        return FLASH_ERROR_READ;
+    }
+    
+    log_summary_clear(summary);
+    for (uint16_t position = 0; position < log_chain; position++) {
+        log_summary_merge(summary, log_sector_summary(position));
+    }
+    for (uint8_t i = 0; i < log_staged; i++) {
+        log_summary_add(summary, &log_stage[i]);
+        summary->slots++;
+    }
+    return FLASH_SUCCESS;
+}
+
+static bool log_event_in_range(const log_event_t* event, uint32_t from_ms, uint32_t to_ms) {
+    return event->detection.timestamp <= to_ms && event->last_timestamp >= from_ms;
+}
+
+uint16_t flash_read_log_range(uint32_t from_ms, uint32_t to_ms, uint32_t* index,
+                              log_event_t* events, uint16_t max_events) {
+    if (!flash_initialized || !index || !events) {
+        return 0;
+    }
     
-    for (uint32_t i = 0; i < log_count; i++) {
-        if (flash_read_detection_log(i, &temp_result) == FLASH_SUCCESS) {
-            if (temp_result.valid == 1) {
-                (*total_count)++;
-                if (temp_result.object_class == CLASS_LED_ON) {
-                    (*led_count)++;
-                } else if (temp_result.object_class == CLASS_MOTHERBOARD) {
-                    (*motherboard_count)++;
+    uint16_t found = 0;
+    uint32_t sector_start = 0;
+    for (uint16_t position = 0; position < log_chain && found < max_events; position++) {
+        uint32_t sector_end = sector_start + log_sectors[log_ring_sector(position)].records;
+        if (*index < sector_end) {
+            // The summary rules out most sectors without touching their records
+            const log_summary_t* summary = log_sector_summary(position);
+            if (summary->events == 0 || summary->first_timestamp > to_ms || summary->last_timestamp < from_ms) {
+                *index = sector_end;
+            }
+            for (; *index < sector_end && found < max_events; (*index)++) {
+                if (flash_read_log_event(*index, &events[found]) == FLASH_SUCCESS &&
+                    log_event_in_range(&events[found], from_ms, to_ms)) {
+                    found++;
                 }
             }
         }
+        sector_start = sector_end;
     }
     
+    // Staged records follow the flashed ones
+    for (; *index < log_count + log_staged && found < max_events; (*index)++) {
+        if (*index >= log_count && log_event_in_range(&log_stage[*index - log_count], from_ms, to_ms)) {
+            events[found++] = log_stage[*index - log_count];
+        }
+    }
+    return found;
+}
+
+uint16_t flash_log_get_scanned_sectors() {
+    return log_scanned_sectors;
+}
+
+// ===== DETECTION LOG STAGING =====
+void flash_log_process() {
+    log_close_events(millis(), false);
+    
+    if (log_staged == FLASH_LOG_STAGE_RECORDS) {
+        log_flush_stage(FLASH_LOG_FLUSH_FULL);
+    } else if (log_staged > 0 && millis() - log_stage_first_ms >= FLASH_LOG_STAGE_MAX_MS) {
+        log_flush_stage(FLASH_LOG_FLUSH_AGE);
+    }
+}
+
+flash_result_t flash_log_flush() {
+    if (!flash_initialized) {
+        return FLASH_ERROR_INIT;
+    }
+    
+    log_close_events(0, true);
+    log_flush_stage(FLASH_LOG_FLUSH_FORCED);
     return FLASH_SUCCESS;
 }
 
+void flash_get_log_head(uint16_t* sector, uint16_t* slot) {
+    if (log_sector_open) {
+        *sector = log_ring_sector(log_chain - 1);
+        *slot = log_sectors[*sector].records;
+    } else {
+        *sector = log_ring_sector(log_chain);
+        *slot = 0;
+    }
+}
+
+uint8_t flash_log_get_staged() {
+    return log_staged;
+}
+
+uint8_t flash_log_get_open_events() {
+    uint8_t open_events = 0;
+    for (uint8_t i = 0; i < FLASH_LOG_OPEN_EVENTS; i++) {
+        open_events += log_open_events[i].event.hits > 0 ? 1 : 0;
+    }
+    return open_events;
+}
+
+const flash_log_stats_t* flash_log_get_stats() {
+    return &log_stats;
+}
+
+static void flash_log_print_stats() {
+    uint32_t flushes = log_stats.flushes[FLASH_LOG_FLUSH_FULL] + log_stats.flushes[FLASH_LOG_FLUSH_AGE] +
+                       log_stats.flushes[FLASH_LOG_FLUSH_FORCED];
+    Serial.println("Log Staging: " + String(log_staged) + "/" + String(FLASH_LOG_STAGE_RECORDS) + " staged, " +
+                   String(flushes) + " flushes (" + String(log_stats.flushes[FLASH_LOG_FLUSH_FULL]) + " full, " +
+                   String(log_stats.flushes[FLASH_LOG_FLUSH_AGE]) + " aged, " +
+                   String(log_stats.flushes[FLASH_LOG_FLUSH_FORCED]) + " forced)");
+    Serial.println("  Events: " + String(log_stats.staged_hits) + " hits in " + String(log_stats.staged_records) +
+                   " records" + (log_stats.staged_records ? " (" + String((float)log_stats.staged_hits /
+                   log_stats.staged_records, 1) + ":1)" : String("")) + ", " + String(flash_log_get_open_events()) +
+                   " open, gap " + String(system_config.log_event_gap_s) + "s");
+    if (flushes == 0 || log_stats.detections == 0) {
+        return;
+    }
+    
+    // Before staging, every hit cost a programmed record on the detection path
+    float stage_us = (float)log_stats.stage_time_us / log_stats.detections;
+    float record_us = (float)log_stats.flush_time_us / log_stats.flushed_records;
+    Serial.println("  Flush: " + String((float)log_stats.flush_time_us / flushes, 1) + "us avg for " +
+                   String((float)log_stats.flushed_records / flushes, 1) + " records, " +
+                   String(log_stats.flush_max_us) + "us max");
+    Serial.println("  Detection Path: " + String(stage_us, 1) + "us per hit merged and staged vs " +
+                   String(record_us, 1) + "us per record programmed");
+}
+
+// From the sector summaries, records are only read for sectors without one
+static void flash_log_print_summary() {
+    log_summary_t summary;
+    uint16_t scanned = log_scanned_sectors;
+    if (flash_get_log_summary(&summary) != FLASH_SUCCESS) {
+        return;
+    }
+    
+    uint32_t hits = 0;
+    for (uint8_t bucket = 0; bucket < LOG_SUMMARY_CLASSES; bucket++) {
+        hits += summary.hits[bucket];
+    }
+    Serial.println("Log Index: " + String(hits) + " hits (LED " + String(summary.hits[CLASS_LED_ON]) + ", MB " +
+                   String(summary.hits[CLASS_MOTHERBOARD]) + ") in " + String(summary.events) + " events" +
+                   (summary.events ? ", " + String(summary.first_timestamp / 1000.0f, 1) + "-" +
+                    String(summary.last_timestamp / 1000.0f, 1) + "s, max confidence " +
+                    String(summary.max_confidence / 255.0f, 2) : String("")) + "; " + String(log_chain) +
+                   " sector summaries, " + String(log_scanned_sectors - scanned) + " read through now, " +
+                   String(log_scanned_sectors) + " since boot");
+}
+
 // ===== UTILITY FUNCTIONS =====
 void flash_print_config() {
     Serial.println("\n=== FLASH CONFIGURATION ===");
@@ -274,17 +1265,53 @@ void flash_print_config() {
     Serial.println("LoRa Interval: " + String(system_config.lora_send_interval) + "ms");
     Serial.println("Detection Threshold: " + String(system_config.detection_threshold));
     Serial.println("Motherboard Threshold: " + String(system_config.motherboard_threshold));
-    Serial.println("MB Count Enabled: " + String(system_config.motherboard_count_enabled ? "YES" : "NO"));
-    Serial.println("MB Count Threshold: " + String(system_config.motherboard_count_threshold));
-    Serial.println("MB Count Window: " + String(system_config.motherboard_count_window_ms/1000) + "s");
+    for (uint8_t cls = 0; cls < DETECTION_CLASS_COUNT; cls++) {
+        const class_counter_config_t* counter = &system_config.class_counters[cls];
+        Serial.println("Counter " + String(cls) + ": " + String(counter->enabled ? "ON" : "OFF") + ", mode " +
+                       String(counter->mode) + ", " +
+                       String(counter->count_threshold) + " in " + String(counter->window_s) + "s, " +
+                       String(counter->resolution_ms) + "ms resolution, clear " + String(counter->clear_threshold) +
+                       ", cooldown " + String(counter->cooldown_s) + "s");
+    }
+    uint8_t rules_enabled = 0;
+    for (uint8_t rule = 0; rule < TRIGGER_MAX_RULES; rule++) {
+        rules_enabled += system_config.trigger_rules[rule].enabled ? 1 : 0;
+    }
+    Serial.println("Trigger Rules: " + String(rules_enabled) + "/" + String(TRIGGER_MAX_RULES) + " enabled");
+    Serial.println("Config Store: slot " + String(config_stats.slot ? "B" : "A") + ", generation " +
+                   String(config_stats.generation) + ", " + String(config_stats.deltas) + "/" +
+                   String(CONFIG_DELTA_RECORDS) + " deltas, " + String(config_stats.saves) + " saves (" +
+                   String(config_stats.compactions) + " full, " + String(config_stats.unchanged) + " unchanged), last " +
+                   String(config_stats.last_words) + " words in " + String(config_stats.last_duration_us) + "us" +
+                   (config_dirty ? ", autosave pending" : ""));
+    Serial.println("Checkpoint Interval: " + String(system_config.checkpoint_interval_s) + "s");
+    Serial.println("Log Event Gap: " + String(system_config.log_event_gap_s) + "s");
     Serial.println("Fan Cycle: " + String(system_config.fan_cycle_interval) + "ms");
     Serial.println("Debug Level: " + String(system_config.debug_level));
     Serial.println("Total Detections: " + String(system_config.total_detections));
     Serial.println("MB Triggers: " + String(system_config.total_motherboard_count_triggers));
+    Serial.println("Detection Log: " + String(flash_get_log_count()) + "/" + String(MAX_LOG_ENTRIES) + " records in " +
+                   String(log_chain) + " sectors, newest #" + String(flash_get_log_sequence()) + ", format " +
+                   String(LOG_FORMAT_VERSION) + " (" + String((uint32_t)sizeof(log_packed_t)) + "B/record), found in " +
+                   String(log_recovery_reads) + " reads at boot");
+    flash_log_print_summary();
+    flash_log_print_stats();
+    flash_wear_print_all();
     Serial.println("Checksum: 0x" + String(system_config.checksum, HEX));
     Serial.println("==========================\n");
 }
 
+static void flash_print_log_event(const String& label, const log_event_t* event) {
+    const detection_result_t* result = &event->detection;
+    const char* class_name = (result->object_class == CLASS_LED_ON) ? "LED" :
+                             (result->object_class == CLASS_MOTHERBOARD) ? "MB" : "UNK";
+    Serial.println(label + ": " + String(class_name) + ", " +
+                   "Conf=" + String(result->confidence) + ", " +
+                   "Time=" + String(result->timestamp) +
+                   (event->hits > 1 ? ", Hits=" + String(event->hits) + ", For=" +
+                    String((event->last_timestamp - result->timestamp) / 1000.0f, 1) + "s" : String("")));
+}
+
 void flash_print_logs(uint32_t max_entries) {
     Serial.println("\n=== DETECTION LOGS ===");
     
@@ -292,19 +1319,38 @@ void flash_print_logs(uint32_t max_entries) {
     uint32_t entries_to_show = min(max_entries, log_count);
     
     Serial.println("Total Logs: " + String(log_count));
-    Serial.println("Showing last " + String(entries_to_show) + " entries:");
+    Serial.println("Showing last " + String(entries_to_show) + " entries, oldest first:");
     
-    detection_result_t temp_result;
+    log_event_t temp_event;
     for (uint32_t i = log_count - entries_to_show; i < log_count; i++) {
-        if (flash_read_detection_log(i, &temp_result) == FLASH_SUCCESS) {
-            const char* class_name = (temp_result.object_class == CLASS_LED_ON) ? "LED" : 
-                                    (temp_result.object_class == CLASS_MOTHERBOARD) ? "MB" : "UNK";
-            Serial.println("Log " + String(i) + ": " +
-                          String(class_name) + ", " +
-                          "Conf=" + String(temp_result.confidence) + ", " +
-                          "Time=" + String(temp_result.timestamp));
+        if (flash_read_log_event(i, &temp_event) == FLASH_SUCCESS) {
+            flash_print_log_event("Log #" + String(flash_get_log_sequence() - log_count + 1 + i), &temp_event);
+        }
+    }
+    Serial.println("======================\n");
+}
+
+void flash_print_log_range(uint32_t from_ms, uint32_t to_ms, uint32_t max_entries) {
+    Serial.println("\n=== DETECTION LOGS ===");
+    Serial.println("Events between " + String(from_ms / 1000) + "s and " + String(to_ms / 1000) + "s, oldest first:");
+    
+    // A few at a time, sectors outside the range are skipped on their summary
+    log_event_t events[8];
+    uint32_t index = 0;
+    uint32_t shown = 0;
+    while (shown < max_entries) {
+        uint16_t batch = min(max_entries - shown, (uint32_t)(sizeof(events) / sizeof(events[0])));
+        uint16_t found = flash_read_log_range(from_ms, to_ms, &index, events, batch);
+        for (uint16_t i = 0; i < found; i++) {
+            flash_print_log_event("Event", &events[i]);
+        }
+        shown += found;
+        if (found < batch) {
+            break;
         }
     }
+    
+    Serial.println("Shown: " + String(shown) + (shown == max_entries ? " (limit)" : ""));
     Serial.println("======================\n");
 }
 
@@ -4,6 +4,8 @@
 
 #include "config.h"
 #include <FlashMemory.h>
+#include "flash_wear.h"
+#include "crc32.h"
 
 // ===== FLASH OPERATION RESULTS =====
 typedef enum {
@@ -24,29 +26,210 @@ bool flash_is_initialized();
 flash_result_t config_save_to_flash();
 flash_result_t config_load_from_flash();
 flash_result_t config_reset_to_defaults();
-uint32_t config_calculate_checksum(system_config_t* config);
+uint32_t config_calculate_checksum(system_config_t* config);     // CRC-32 of everything before it
 bool config_validate_checksum(system_config_t* config);
 
+// ===== CONFIGURATION SLOTS =====
+// Two slots, A and B, one sector each. A slot holds a full image followed
+// by delta records, one per changed word: a save appends the words that
+// differ from what flash holds, checksum word last, and that record commits
+// it. When the deltas no longer fit, the next save erases the other slot
+// under the next generation and writes a full image there, checksum last;
+// until that completes the old slot stays the newest valid one. A save cut
+// short by a reset leaves the previous configuration in effect.
+typedef struct {
+    uint32_t saves;                 // That programmed anything
+    uint32_t unchanged;             // Nothing differed from flash
+    uint32_t compactions;           // Full images, slot switches
+    uint32_t words_written;
+    uint32_t last_words;
+    uint32_t last_duration_us;
+    uint32_t generation;            // Of the slot in use, 0 = none
+    uint8_t slot;
+    uint16_t deltas;                // Records used in that slot
+    bool compact_pending;           // Records past the last complete save, or an older layout
+} config_store_stats_t;
+
+void config_mark_dirty();          // After a settings change, saved CONFIG_AUTOSAVE_DELAY_MS after the last one
+void config_process();             // Main loop
+bool config_is_dirty();
+const config_store_stats_t* config_get_store_stats();
+
+// ===== CONFIGURATION MIGRATION =====
+// Builds before the slots kept one copy at FLASH_CONFIG_LEGACY_OFFSET in the
+// version 2 layout below, checksummed byte by byte with add and xor-shift.
+// It is read once, mapped into the current layout and saved to slot B.
+#define CONFIG_VERSION_SINGLE_COPY  2
+
+typedef struct {
+    uint16_t config_version;
+    uint32_t system_id;
+    uint32_t lora_send_interval;
+    uint8_t lora_retry_count;
+    uint32_t lora_timeout;
+    uint8_t lora_enabled;
+    float detection_threshold;
+    float motherboard_threshold;
+    uint8_t detection_enabled;
+    uint8_t crosshair_enabled;
+    uint8_t motherboard_count_enabled;
+    uint32_t motherboard_count_threshold;
+    uint32_t motherboard_count_window_ms;
+    uint32_t fan_cycle_interval;
+    uint8_t fan_enabled;
+    uint32_t laser_blink_interval;
+    uint8_t debug_level;
+    uint8_t serial_commands_enabled;
+    uint32_t total_detections;
+    uint32_t system_uptime;
+    uint32_t total_motherboard_count_triggers;
+    uint32_t last_motherboard_trigger_time;
+    uint32_t checksum;              // Over everything before it
+} system_config_v2_t;
+
+uint32_t config_v2_checksum(const system_config_v2_t* config);
+void config_migrate_v2(const system_config_v2_t* old_config, system_config_t* config);
+
 // ===== DETECTION LOG MANAGEMENT =====
-flash_result_t flash_write_detection_log(detection_result_t* result);
-flash_result_t flash_read_detection_log(uint32_t index, detection_result_t* result);
+// A record is an event: consecutive hits of one class on one region, each
+// overlapping the one before and at most log_event_gap_s apart, merged in
+// RAM until the gap passes (main loop), another region needs the slot or
+// the log is flushed. Gap 0 logs every hit as a record of its own.
+typedef struct {
+    detection_result_t detection;   // First hit's timestamp, highest confidence, union of the boxes
+    uint32_t last_timestamp;        // Of the last hit
+    uint16_t hits;
+} log_event_t;
+
+flash_result_t flash_write_detection_log(detection_result_t* result);  // Merged and staged, see below
+flash_result_t flash_read_log_event(uint32_t index, log_event_t* event);              // 0 = oldest, quantized
+flash_result_t flash_read_detection_log(uint32_t index, detection_result_t* result);  // Its event's detection
 uint32_t flash_get_log_count();
+uint32_t flash_get_log_sequence();         // Of the newest record, 0 if empty
 flash_result_t flash_clear_logs();
-flash_result_t flash_get_log_stats(uint32_t* total_count, uint32_t* led_count, uint32_t* motherboard_count);
+flash_result_t flash_get_log_stats(uint32_t* total_count, uint32_t* led_count, uint32_t* motherboard_count);  // Hits
+
+// ===== DETECTION LOG STAGING =====
+// Closed events are staged in RAM and programmed together: when the stage
+// fills, once its oldest record is FLASH_LOG_STAGE_MAX_MS old (main loop),
+// and before anything that may reset. Staged records count and read back
+// like flashed ones, open events do not; a power loss drops both.
+typedef enum {
+    FLASH_LOG_FLUSH_FULL = 0,
+    FLASH_LOG_FLUSH_AGE,
+    FLASH_LOG_FLUSH_FORCED,         // flash_log_flush(): reset, config save, clear
+    FLASH_LOG_FLUSH_REASONS
+} flash_log_flush_reason_t;
+
+typedef struct {
+    uint32_t detections;            // Hits handed to the log
+    uint32_t staged_records;
+    uint32_t staged_hits;           // Merged into the staged records
+    uint64_t stage_time_us;         // Detection path, merging and staging only
+    uint32_t flushes[FLASH_LOG_FLUSH_REASONS];
+    uint32_t flushed_records;
+    uint64_t flush_time_us;         // Programming, sector erases included
+    uint32_t flush_max_us;
+} flash_log_stats_t;
+
+void flash_log_process();                  // Main loop
+flash_result_t flash_log_flush();          // Before a reset
+uint8_t flash_log_get_staged();
+uint8_t flash_log_get_open_events();
+const flash_log_stats_t* flash_log_get_stats();
 
 // ===== UTILITY FUNCTIONS =====
 void flash_print_config();
 void flash_print_logs(uint32_t max_entries);
+void flash_print_log_range(uint32_t from_ms, uint32_t to_ms, uint32_t max_entries);
 flash_result_t flash_test_operations();
 const char* flash_result_to_string(flash_result_t result);
 
 // ===== FLASH MEMORY ORGANIZATION =====
 // Base address: FLASH_MEMORY_APP_BASE
-// Config area:  FLASH_CONFIG_OFFSET (0x1E00) - stores system_config_t
-// Log area:     FLASH_LOG_OFFSET (0x1F00) - stores detection logs
-// Each log entry is sizeof(detection_result_t) bytes
-// Maximum log entries: calculated based on available space
+// Config area:  FLASH_CONFIG_OFFSET (0x1000) - system_config_t, FLASH_CONFIG_SLOTS sectors
+// Checkpoints:  FLASH_CHECKPOINT_OFFSET (0x3000) - see state_checkpoint.h
+// Log area:     FLASH_LOG_OFFSET (0x7000) - detection log journal, FLASH_LOG_SECTORS sectors
+//
+// The log is an append-only ring of records over a wear-leveled sector area
+// (flash_wear.h); a sector is erased when the log reaches it again, dropping
+// its oldest records. Sectors carry a sequence number one above the previous
+// sector's and, in their header tag, the record format they hold. At boot
+// the sector headers give the sectors in the log and a binary search over
+// the newest one its write position.
+//
+// A sector starts with a log_sector_preamble_t, holds packed records and
+// ends with a log_summary_t of them. Sectors with another tag are not part
+// of the log and are erased when the log reaches them.
+
+#define LOG_FORMAT_VERSION      5
+#define LOG_JOURNAL_TAG         (0x4C000000 | (LOG_FORMAT_VERSION << 8) | sizeof(log_packed_t))  // 'L' + format + size
+
+// Five words:
+//   word 0  [31:30] 10 = valid, 00 = not valid, 11 = slot unused
+//           [29:26] class, 0xF = unknown
+//           [25:18] highest confidence * 255
+//           [17]    delta unit, 0 = ms, 1 = s
+//           [16:0]  signed delta of the first hit's timestamp from the
+//                   previous record's in the sector
+//   word 1  x_min | y_min << 16 of the union box, each * 65534
+//   word 2  x_max | y_max << 16
+//   word 3  [31]    0
+//           [30:16] hits
+//           [15]    duration unit, 0 = 100ms, 1 = 10s
+//           [14:0]  last hit - first hit
+//   word 4  CRC-32 of words 0-3
+// Word 0 is written first and the CRC last, so a record torn mid-write, or
+// corrupted since, fails its CRC. Events close out of order, hence signed
+// deltas; they are taken from the decoded previous timestamp: exact within
+// 65s, within a second up to 18h. A longer gap starts a new sector, and so
+// does the first record after a boot: millis() starts over, and a sector
+// must not mix the timestamps of two boots.
+typedef struct {
+    uint32_t words[5];
+} log_packed_t;
+
+#define LOG_EVENT_MAX_HITS         0x7FFF
+#define LOG_EVENT_MAX_MS           (0x7FFFUL * 10000)  // Longer events are closed and a new one started
+
+typedef struct {
+    uint32_t first_sequence;        // Of the sector's first record
+    uint32_t base_timestamp;        // The first record's, its delta is 0
+} log_sector_preamble_t;
+
+// Summary of a sector, written into its last 32 bytes once it takes no more
+// records, CRC last; kept in RAM for every sector of the log. A sector whose
+// summary a reset cut short is read through once after boot instead. A
+// whole-log summary adds up the sectors'.
+#define LOG_SUMMARY_CLASSES     (DETECTION_CLASS_COUNT + 1)     // Last: any other class
+
+typedef struct {
+    uint32_t hits[LOG_SUMMARY_CLASSES];     // Of valid records, per class
+    uint32_t first_timestamp;       // Earliest first hit, 0xFFFFFFFF if no records
+    uint32_t last_timestamp;        // Latest last hit
+    uint16_t slots;                 // Used, torn ones included, must match the sector's
+    uint16_t events;                // Records that read back
+    uint8_t max_confidence;         // * 255
+    uint8_t reserved[3];            // 0xFF
+    uint32_t checksum;              // CRC-32 of the words above
+} log_summary_t;
+
+#define LOG_RECORDS_PER_SECTOR     ((FLASH_SECTOR_DATA_SIZE - sizeof(log_sector_preamble_t) - sizeof(log_summary_t)) / \
+                                    sizeof(log_packed_t))
+#define MAX_LOG_ENTRIES            (FLASH_LOG_SECTORS * LOG_RECORDS_PER_SECTOR)
+
+// ===== PACKED RECORD CODEC =====
+bool flash_log_encode(const log_event_t* event, uint32_t previous_timestamp, log_packed_t* packed);  // False: gap too long
+bool flash_log_decode(const log_packed_t* packed, uint32_t previous_timestamp,
+                      log_event_t* event);     // False: torn, corrupt or unused
+void flash_get_log_head(uint16_t* sector, uint16_t* slot);  // Where the next record goes, slot 0 = sector not started
 
-#define MAX_LOG_ENTRIES ((FLASH_SIZE - (FLASH_LOG_OFFSET - FLASH_CONFIG_OFFSET) - sizeof(system_config_t)) / sizeof(detection_result_t))
+// ===== DETECTION LOG INDEX =====
+// Sector summaries answer these without reading the records of sectors
+// outside the time range.
+flash_result_t flash_get_log_summary(log_summary_t* summary);   // Whole log, staged records included
+uint16_t flash_read_log_range(uint32_t from_ms, uint32_t to_ms, uint32_t* index,
+                              log_event_t* events, uint16_t max_events);  // Overlapping events from *index on, oldest first
+uint16_t flash_log_get_scanned_sectors();  // Sectors summarized from their records since boot
 
 #endif // AMB82_FLASH_H
\ No newline at end of file
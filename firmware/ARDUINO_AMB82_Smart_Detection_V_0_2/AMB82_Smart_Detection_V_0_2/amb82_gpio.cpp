@@ -1,5 +1,6 @@
 // amb82_gpio.cpp - GPIO Control Implementation
 #include "amb82_gpio.h"
+#include "amb82_flash.h"
 
 // ===== GLOBAL VARIABLES =====
 gpio_module_t gpio_module = {0};
@@ -295,6 +296,7 @@ gpio_result_t gpio_reset_control_init() {
 
 gpio_result_t gpio_trigger_system_reset() {
     INFO_PRINT("Triggering system reset via GPIO pin...");
+    flash_log_flush();
     
     // Set reset pin HIGH to trigger reset
     digitalWrite(PIN_RESET_CONTROL, HIGH);
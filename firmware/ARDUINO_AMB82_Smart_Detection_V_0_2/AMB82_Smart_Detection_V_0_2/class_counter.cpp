@@ -0,0 +1,455 @@
+// class_counter.cpp - Per-Class Detection Counters Implementation
+#include "class_counter.h"
+#include "detection_manager.h"
+#include "lora_rak3172.h"
+
+// ===== GLOBAL VARIABLES =====
+static class_counter_set_t<0> class_counters = {};
+
+// ===== COUNTER HELPERS =====
+template <typename Counter>
+static void counter_apply_config(Counter& counter) {
+    const class_counter_config_t* cfg = &system_config.class_counters[Counter::class_id];
+    counter.configure(cfg->enabled, cfg->mode, cfg->count_threshold, (uint32_t)cfg->window_s * 1000, cfg->resolution_ms,
+                      cfg->clear_threshold, (uint32_t)cfg->cooldown_s * 1000);
+}
+
+template <typename Counter>
+static void counter_fill_stats(Counter& counter, class_counter_stats_t* stats) {
+    stats->enabled = counter.enabled;
+    stats->mode = counter.mode;
+    stats->count_in_window = counter.count();
+    stats->trigger_level = counter.level();
+    stats->rate_per_s = counter.rate();
+    stats->count_threshold = counter.count_threshold;
+    stats->window_ms = counter.wheel.window_ms;
+    stats->resolution_ms = counter.wheel.width_ms;
+    stats->slots = counter.wheel.slots;
+    stats->total_detections = counter.total_detections;
+    stats->triggers_sent = counter.triggers_sent;
+    stats->last_trigger_time = counter.last_trigger_time;
+    stats->state = counter.state;
+    stats->clear_threshold = counter.clear_threshold;
+    stats->cooldown_ms = counter.cooldown_ms;
+    stats->peak_count = counter.peak_count;
+    stats->trigger_duration_ms = counter.triggered() ? millis() - counter.last_trigger_time : counter.last_duration_ms;
+}
+
+static bool counter_valid_class(uint8_t object_class) {
+    if (object_class < DETECTION_CLASS_COUNT) {
+        return true;
+    }
+    ERROR_PRINT("Invalid class " + String(object_class) + ". Use 0-" + String(DETECTION_CLASS_COUNT - 1) + ".");
+    return false;
+}
+
+// ===== CLASS COUNTER INITIALIZATION =====
+void class_counter_init() {
+    INFO_PRINT("Initializing detection counters...");
+
+    class_counters.for_each([](auto& counter) {
+        counter.clear();
+        counter_apply_config(counter);
+        INFO_PRINT("- " + String(detection_class_to_string(counter.class_id)) + ": " +
+                   String(counter.enabled ? "enabled" : "disabled") + ", " +
+                   (counter.count_threshold ? String(counter.count_threshold) : String("no")) + " trigger in " +
+                   String(counter.wheel.window_ms / 1000) + "s (" + String(counter.wheel.width_ms) + "ms resolution)");
+    });
+}
+
+void class_counter_configure() {
+    class_counters.for_each([](auto& counter) {
+        bool was_enabled = counter.enabled;
+        counter_apply_config(counter);
+        if (counter.enabled && !was_enabled) {
+            counter.clear();
+        }
+    });
+}
+
+// ===== DETECTION PATH =====
+void class_counter_add_detection(uint8_t object_class, uint32_t timestamp) {
+    class_counters.visit(object_class, [timestamp](auto& counter) {
+        counter.add(timestamp);
+        DEBUG_PRINT(3, String(detection_class_to_string(counter.class_id)) + " detection added: total=" +
+                       String(counter.total_detections) + ", in_window=" + String(counter.count()));
+    });
+}
+
+class_trigger_event_t class_counter_check_trigger(uint8_t object_class) {
+    uint32_t current_count = 0;
+    uint32_t window_ms = 0;
+    uint32_t peak_count = 0;
+    uint32_t duration_ms = 0;
+    class_trigger_event_t event = CLASS_TRIGGER_NONE;
+    class_counters.visit(object_class, [&](auto& counter) {
+        event = counter.check_trigger(&current_count);
+        window_ms = counter.wheel.window_ms;
+        peak_count = counter.peak_count;
+        duration_ms = counter.last_duration_ms;
+    });
+
+    if (event == CLASS_TRIGGER_START) {
+        // Motherboard trigger statistics persist with the configuration
+        if (object_class == CLASS_MOTHERBOARD) {
+            system_config.total_motherboard_count_triggers++;
+            system_config.last_motherboard_trigger_time = millis();
+        }
+
+        // Printed piecewise like the other trigger messages, String concatenation allocates
+        if (system_config.debug_level >= 2) {
+            Serial.print("[INFO] 🚨 ");
+            Serial.print(detection_class_to_string(object_class));
+            Serial.print(" TRIGGER: ");
+            Serial.print(current_count);
+            Serial.print(" detections in ");
+            Serial.print(window_ms / 1000);
+            Serial.println("s window");
+        }
+    } else if (event == CLASS_TRIGGER_END) {
+        if (system_config.debug_level >= 2) {
+            Serial.print("[INFO] ✅ ");
+            Serial.print(detection_class_to_string(object_class));
+            Serial.print(" TRIGGER ENDED: peak ");
+            Serial.print(peak_count);
+            Serial.print(" after ");
+            Serial.print(duration_ms / 1000);
+            Serial.println("s");
+        }
+    }
+    return event;
+}
+
+void class_counter_process() {
+    for (uint8_t object_class = 0; object_class < DETECTION_CLASS_COUNT; object_class++) {
+        // Start events need a detection, only active triggers can change here
+        bool active = false;
+        class_counters.visit(object_class, [&active](auto& counter) {
+            active = counter.state == CLASS_TRIGGER_TRIGGERED;
+        });
+        if (active && class_counter_check_trigger(object_class) == CLASS_TRIGGER_END) {
+            send_class_trigger_end_lora(object_class);
+        }
+    }
+}
+
+uint32_t class_counter_get_count_in_window(uint8_t object_class) {
+    uint32_t count = 0;
+    class_counters.visit(object_class, [&count](auto& counter) {
+        count = counter.count();
+    });
+    return count;
+}
+
+float class_counter_get_rate(uint8_t object_class) {
+    float rate = 0.0f;
+    class_counters.visit(object_class, [&rate](auto& counter) {
+        rate = counter.rate();
+    });
+    return rate;
+}
+
+bool class_counter_get_stats(uint8_t object_class, class_counter_stats_t* stats) {
+    if (!stats) {
+        return false;
+    }
+    return class_counters.visit(object_class, [stats](auto& counter) {
+        counter_fill_stats(counter, stats);
+    });
+}
+
+void class_counter_reset() {
+    INFO_PRINT("Resetting detection counters...");
+
+    class_counters.for_each([](auto& counter) {
+        counter.clear();
+    });
+
+    // Reset config statistics
+    system_config.total_motherboard_count_triggers = 0;
+    system_config.last_motherboard_trigger_time = 0;
+}
+
+void class_counter_print_stats(uint8_t object_class) {
+    class_counters.for_each([object_class](auto& counter) {
+        if (object_class != CLASS_UNKNOWN && object_class != counter.class_id) {
+            return;
+        }
+
+        class_counter_stats_t stats;
+        counter_fill_stats(counter, &stats);
+        String level = stats.mode == CLASS_COUNTER_MODE_EWMA ? "EWMA " + String(stats.trigger_level)
+                                                             : String(stats.count_in_window);
+        Serial.println(String(detection_class_to_string(counter.class_id)) + ": " +
+                       String(stats.enabled ? "" : "OFF, ") + level + "/" +
+                       (stats.count_threshold ? String(stats.count_threshold) : String("-")) + " in " +
+                       String(stats.window_ms / 1000) + "s (" + String(stats.resolution_ms) + "ms x " +
+                       String(stats.slots) + "), " + String(stats.total_detections) + " total, " +
+                       String(stats.rate_per_s, 2) + "/s, " + String(class_trigger_state_to_string(stats.state)) + ", " +
+                       String(stats.triggers_sent) + " triggers" +
+                       (stats.triggers_sent ? ", last " + String((millis() - stats.last_trigger_time) / 1000) + "s ago"
+                                            : String("")));
+    });
+}
+
+// ===== CLASS COUNTER CONFIGURATION =====
+bool class_counter_set_enabled(uint8_t object_class, bool enabled) {
+    if (!counter_valid_class(object_class)) {
+        return false;
+    }
+
+    system_config.class_counters[object_class].enabled = enabled;
+    class_counter_configure();
+
+    INFO_PRINT(String(detection_class_to_string(object_class)) + " counter " + String(enabled ? "enabled" : "disabled"));
+    return true;
+}
+
+bool class_counter_set_threshold(uint8_t object_class, uint32_t threshold) {
+    if (!counter_valid_class(object_class)) {
+        return false;
+    }
+    if (threshold > CLASS_COUNTER_MAX_THRESHOLD) {
+        ERROR_PRINT("Invalid threshold range. Use 1-" + String(CLASS_COUNTER_MAX_THRESHOLD) + ", 0 = count only.");
+        return false;
+    }
+
+    system_config.class_counters[object_class].count_threshold = threshold;
+    class_counter_configure();
+
+    INFO_PRINT(String(detection_class_to_string(object_class)) + " counter threshold set to " + String(threshold));
+    return true;
+}
+
+bool class_counter_set_window(uint8_t object_class, uint32_t window_seconds) {
+    if (!counter_valid_class(object_class)) {
+        return false;
+    }
+    if (window_seconds < 1 || window_seconds > CLASS_COUNTER_MAX_WINDOW) {
+        ERROR_PRINT("Invalid window range. Use 1-" + String(CLASS_COUNTER_MAX_WINDOW) + " seconds.");
+        return false;
+    }
+
+    system_config.class_counters[object_class].window_s = window_seconds;
+    class_counter_configure();
+
+    INFO_PRINT(String(detection_class_to_string(object_class)) + " counter window set to " + String(window_seconds) +
+               " seconds");
+    return true;
+}
+
+bool class_counter_set_resolution(uint8_t object_class, uint32_t resolution_ms) {
+    if (!counter_valid_class(object_class)) {
+        return false;
+    }
+    if (resolution_ms > CLASS_COUNTER_MAX_RESOLUTION) {
+        ERROR_PRINT("Invalid resolution. Use 0 (auto) or 1-" + String(CLASS_COUNTER_MAX_RESOLUTION) + " ms.");
+        return false;
+    }
+
+    system_config.class_counters[object_class].resolution_ms = resolution_ms;
+    class_counter_configure();
+
+    class_counter_stats_t stats;
+    class_counter_get_stats(object_class, &stats);
+    INFO_PRINT(String(detection_class_to_string(object_class)) + " counter resolution " + String(stats.resolution_ms) +
+               "ms" + (resolution_ms < stats.resolution_ms ? " (limited by " + String(CLASS_COUNTER_SLOTS) + " slots)"
+                                                           : String("")));
+    return true;
+}
+
+bool class_counter_set_clear_threshold(uint8_t object_class, uint32_t threshold) {
+    if (!counter_valid_class(object_class)) {
+        return false;
+    }
+    if (threshold > CLASS_COUNTER_MAX_THRESHOLD) {
+        ERROR_PRINT("Invalid clear threshold. Use 0 (auto) or 1-" + String(CLASS_COUNTER_MAX_THRESHOLD) + ".");
+        return false;
+    }
+
+    system_config.class_counters[object_class].clear_threshold = threshold;
+    class_counter_configure();
+
+    class_counter_stats_t stats;
+    class_counter_get_stats(object_class, &stats);
+    INFO_PRINT(String(detection_class_to_string(object_class)) + " counter clears at " +
+               String(stats.clear_threshold) + (threshold != stats.clear_threshold ? String(" (auto)") : String("")));
+    return true;
+}
+
+bool class_counter_set_cooldown(uint8_t object_class, uint32_t cooldown_seconds) {
+    if (!counter_valid_class(object_class)) {
+        return false;
+    }
+    if (cooldown_seconds > CLASS_COUNTER_MAX_COOLDOWN) {
+        ERROR_PRINT("Invalid cooldown. Use 0-" + String(CLASS_COUNTER_MAX_COOLDOWN) + " seconds.");
+        return false;
+    }
+
+    system_config.class_counters[object_class].cooldown_s = cooldown_seconds;
+    class_counter_configure();
+
+    INFO_PRINT(String(detection_class_to_string(object_class)) + " counter cooldown set to " +
+               String(cooldown_seconds) + " seconds");
+    return true;
+}
+
+bool class_counter_set_mode(uint8_t object_class, uint8_t mode) {
+    if (!counter_valid_class(object_class)) {
+        return false;
+    }
+    if (mode >= CLASS_COUNTER_MODE_COUNT) {
+        ERROR_PRINT("Invalid counter mode. Use window or ewma.");
+        return false;
+    }
+
+    system_config.class_counters[object_class].mode = mode;
+    class_counter_configure();
+
+    INFO_PRINT(String(detection_class_to_string(object_class)) + " counter triggers on " +
+               String(class_counter_mode_to_string(mode)));
+    return true;
+}
+
+// ===== CHECKPOINT =====
+void class_counter_checkpoint_save(checkpoint_write_t write, uint32_t now) {
+    class_counters.for_each([write, now](auto& counter) {
+        auto snapshot = counter;
+        snapshot.rebase(now, 0);
+        write(&snapshot, sizeof(snapshot));
+    });
+}
+
+bool class_counter_checkpoint_restore(checkpoint_read_t read) {
+    bool ok = true;
+    class_counters.for_each([read, &ok](auto& counter) {
+        auto snapshot = counter;
+        if (!ok || !read(&snapshot, sizeof(snapshot))) {
+            ok = false;
+            return;
+        }
+        counter = snapshot;
+        counter_apply_config(counter);
+    });
+    return ok;
+}
+
+uint32_t class_counter_checkpoint_signature() {
+    uint32_t signature = 0;
+    class_counters.for_each([&signature](auto& counter) {
+        signature = signature * 31 + counter.total_detections;
+        signature = signature * 31 + counter.triggers_sent;
+        signature = signature * 31 + counter.state;
+    });
+    return signature;
+}
+
+// ===== UTILITY FUNCTIONS =====
+const char* class_trigger_state_to_string(uint8_t state) {
+    switch (state) {
+        case CLASS_TRIGGER_IDLE: return "IDLE";
+        case CLASS_TRIGGER_ARMED: return "ARMED";
+        case CLASS_TRIGGER_TRIGGERED: return "TRIGGERED";
+        case CLASS_TRIGGER_COOLDOWN: return "COOLDOWN";
+        default: return "UNKNOWN";
+    }
+}
+
+const char* class_counter_mode_to_string(uint8_t mode) {
+    switch (mode) {
+        case CLASS_COUNTER_MODE_WINDOW: return "WINDOW";
+        case CLASS_COUNTER_MODE_EWMA: return "EWMA";
+        default: return "UNKNOWN";
+    }
+}
+
+uint8_t class_counter_string_to_mode(const char* mode_str) {
+    if (!mode_str) {
+        return CLASS_COUNTER_MODE_COUNT;
+    }
+    if (strcasecmp(mode_str, "window") == 0) {
+        return CLASS_COUNTER_MODE_WINDOW;
+    }
+    if (strcasecmp(mode_str, "ewma") == 0) {
+        return CLASS_COUNTER_MODE_EWMA;
+    }
+    return CLASS_COUNTER_MODE_COUNT;
+}
+
+// ===== LORA TRIGGER =====
+void send_class_trigger_lora(uint8_t object_class) {
+    class_counter_stats_t stats;
+    if (!lora_is_initialized() || !class_counter_get_stats(object_class, &stats)) {
+        return;
+    }
+
+    char message_buffer[LORA_MAX_PAYLOAD_SIZE];
+    if (object_class == CLASS_MOTHERBOARD) {
+        // Format: MT,<count>,<timestamp>
+        static_assert(LORA_MESSAGE_FITS("MT,65535,4294967"), "MT uplink exceeds the LoRa payload limit");
+        snprintf(message_buffer, sizeof(message_buffer),
+                 "MT,%u,%lu",
+                 (unsigned)lora_saturate_u16(stats.trigger_level),
+                 (unsigned long)(millis()/1000));
+    } else {
+        // Format: CT,<class>,<count>
+        static_assert(LORA_MESSAGE_FITS("CT,255,65535"), "CT uplink exceeds the LoRa payload limit");
+        snprintf(message_buffer, sizeof(message_buffer),
+                 "CT,%u,%u",
+                 (unsigned)object_class,
+                 (unsigned)lora_saturate_u16(stats.trigger_level));
+    }
+
+    lora_result_t result = lora_send_message(LORA_MSG_MOTHERBOARD_TRIGGER, message_buffer);
+
+    if (result == LORA_SUCCESS) {
+        if (system_config.debug_level >= 2) {
+            Serial.print("[INFO] [LoRa] ");
+            Serial.print(detection_class_to_string(object_class));
+            Serial.print(" trigger sent: ");
+            Serial.println(message_buffer);
+        }
+    } else {
+        ERROR_PRINT("[LoRa] " + String(detection_class_to_string(object_class)) + " trigger failed: " +
+                    String(lora_result_to_string(result)));
+    }
+}
+
+void send_class_trigger_end_lora(uint8_t object_class) {
+    class_counter_stats_t stats;
+    if (!lora_is_initialized() || !class_counter_get_stats(object_class, &stats)) {
+        return;
+    }
+
+    char message_buffer[LORA_MAX_PAYLOAD_SIZE];
+    if (object_class == CLASS_MOTHERBOARD) {
+        // Format: ME,<peak>,<duration_seconds>
+        static_assert(LORA_MESSAGE_FITS("ME,65535,4294967"), "ME uplink exceeds the LoRa payload limit");
+        snprintf(message_buffer, sizeof(message_buffer),
+                 "ME,%u,%lu",
+                 (unsigned)lora_saturate_u16(stats.peak_count),
+                 (unsigned long)(stats.trigger_duration_ms/1000));
+    } else {
+        // Format: CE,<class>,<peak>,<duration_seconds>
+        static_assert(LORA_MESSAGE_FITS("CE,255,65535,4294967"), "CE uplink exceeds the LoRa payload limit");
+        snprintf(message_buffer, sizeof(message_buffer),
+                 "CE,%u,%u,%lu",
+                 (unsigned)object_class,
+                 (unsigned)lora_saturate_u16(stats.peak_count),
+                 (unsigned long)(stats.trigger_duration_ms/1000));
+    }
+
+    lora_result_t result = lora_send_message(LORA_MSG_MOTHERBOARD_TRIGGER, message_buffer);
+
+    if (result == LORA_SUCCESS) {
+        if (system_config.debug_level >= 2) {
+            Serial.print("[INFO] [LoRa] ");
+            Serial.print(detection_class_to_string(object_class));
+            Serial.print(" trigger end sent: ");
+            Serial.println(message_buffer);
+        }
+    } else {
+        ERROR_PRINT("[LoRa] " + String(detection_class_to_string(object_class)) + " trigger end failed: " +
+                    String(lora_result_to_string(result)));
+    }
+}
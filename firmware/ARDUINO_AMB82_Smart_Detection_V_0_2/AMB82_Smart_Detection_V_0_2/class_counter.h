@@ -0,0 +1,448 @@
+// class_counter.h - Per-Class Detection Counters
+#ifndef CLASS_COUNTER_H
+#define CLASS_COUNTER_H
+
+#include "config.h"
+#include "ObjectClassList.h"
+#include <math.h>
+
+// Every class in ObjectClassList.h itemList gets its own sliding-window
+// counter and trigger, configured from system_config.class_counters[class].
+// The counters are compile-time instances of class_counter_t, so the
+// per-detection path is a compare per class to find the counter followed by
+// an inlined time wheel update - no virtual calls, no runtime class tables.
+// Adding a class to the model means adding its itemList entry, its CLASS_*
+// id and its DEFAULT_CONFIG counter settings.
+
+// ===== TIME WHEEL =====
+// Sliding window as a ring of per-slot counts plus a running sum. All time
+// arithmetic is unsigned differences, so millis() wraparound is harmless.
+template <uint16_t Slots>
+struct time_wheel_t {
+    static_assert(Slots >= 1 && Slots <= 255, "time_wheel_t indexes slots with a uint8_t");
+
+    uint16_t counts[Slots];
+    uint8_t slots;                  // Slots in use, ceil(window / width)
+    uint8_t head;                   // Slot receiving current detections
+    uint32_t start;                 // millis() at which the head slot began
+    uint32_t width_ms;
+    uint32_t window_ms;
+    uint32_t sum;                   // Sum of counts
+
+    void clear(uint32_t now) {
+        memset(counts, 0, sizeof(counts));
+        head = 0;
+        start = now;
+        sum = 0;
+    }
+
+    // Slot width is the requested resolution, widened when the window would
+    // need more than Slots slots. Changing the layout starts the window over.
+    void configure(uint32_t window, uint32_t resolution_ms, uint32_t now) {
+        uint32_t width = (window + Slots - 1) / Slots;
+        if (width < resolution_ms) {
+            width = resolution_ms;
+        }
+        if (width == 0) {
+            width = 1;
+        }
+        uint32_t needed = (window + width - 1) / width;
+        if (needed == 0) {
+            needed = 1;
+        }
+
+        if (width != width_ms || needed != slots) {
+            clear(now);
+        }
+        window_ms = window;
+        width_ms = width;
+        slots = needed;
+    }
+
+    void advance(uint32_t now) {
+        if (width_ms == 0) {
+            return;     // Window not configured yet
+        }
+
+        uint32_t elapsed = now - start;
+
+        // Slightly behind the head (frame timestamps lag millis()) - nothing to expire
+        if (elapsed > UINT32_MAX - window_ms) {
+            return;
+        }
+
+        uint32_t steps = elapsed / width_ms;
+        if (steps == 0) {
+            return;
+        }
+
+        if (steps >= slots) {
+            // Idle for a whole window, everything expired
+            memset(counts, 0, sizeof(counts));
+            sum = 0;
+        } else {
+            for (uint32_t i = 0; i < steps; i++) {
+                head = (head + 1) % slots;
+                sum -= counts[head];
+                counts[head] = 0;
+            }
+        }
+        start += steps * width_ms;
+    }
+
+    void add(uint32_t timestamp) {
+        advance(timestamp);
+
+        // Detections older than the head slot go into the slot that covers them
+        uint8_t slot = head;
+        if ((int32_t)(timestamp - start) < 0) {
+            uint32_t back = (start - timestamp + width_ms - 1) / width_ms;
+            if (back >= slots) {
+                return;     // Already outside the window
+            }
+            slot = (head + slots - back) % slots;
+        }
+
+        if (counts[slot] < UINT16_MAX) {
+            counts[slot]++;
+            sum++;
+        }
+    }
+
+    // O(1) amortized, resolution is one slot
+    uint32_t count(uint32_t now) {
+        advance(now);
+        return sum;
+    }
+
+    // Move the wheel onto another clock, e.g. the millis() of the next boot
+    void rebase(uint32_t from, uint32_t to) {
+        start = start - from + to;
+    }
+};
+
+// ===== EWMA RATE =====
+// Exponentially weighted detections per second with time constant tau: each
+// detection adds 1/tau and the sum decays by exp(-dt/tau), so a steady r/s
+// reads r. O(1) per detection in 12 bytes; the decay is folded in lazily
+// when the rate is read or the next detection arrives.
+struct ewma_rate_t {
+    float rate;                     // Per second, as of last_ms
+    uint32_t last_ms;
+    uint32_t tau_ms;
+
+    void clear(uint32_t now) {
+        rate = 0.0f;
+        last_ms = now;
+    }
+
+    void configure(uint32_t tau) {
+        tau_ms = tau ? tau : 1;
+    }
+
+    float decay(uint32_t dt_ms) const {
+        return expf(-(float)dt_ms / (float)tau_ms);
+    }
+
+    void add(uint32_t timestamp) {
+        float weight = 1000.0f / (float)tau_ms;
+        uint32_t elapsed = timestamp - last_ms;
+        if (elapsed > UINT32_MAX / 2) {
+            // Frame timestamp behind the last read, add it pre-decayed
+            rate += weight * decay(last_ms - timestamp);
+            return;
+        }
+        rate = rate * decay(elapsed) + weight;
+        last_ms = timestamp;
+    }
+
+    float rate_at(uint32_t now) {
+        uint32_t elapsed = now - last_ms;
+        if (elapsed > 0 && elapsed <= UINT32_MAX / 2) {
+            rate *= decay(elapsed);
+            last_ms = now;
+        }
+        return rate;
+    }
+
+    void rebase(uint32_t from, uint32_t to) {
+        last_ms = last_ms - from + to;
+    }
+};
+
+// ===== TRIGGER MODES =====
+// WINDOW compares the sliding-window count with the thresholds. EWMA
+// compares rate x window, an exponentially smoothed count with the window
+// as time constant, so thresholds mean the same in both modes.
+typedef enum {
+    CLASS_COUNTER_MODE_WINDOW = 0,
+    CLASS_COUNTER_MODE_EWMA,
+    CLASS_COUNTER_MODE_COUNT
+} class_counter_mode_t;
+
+// ===== TRIGGER STATE MACHINE =====
+// IDLE -> ARMED once the count rises above the clear threshold, ARMED ->
+// TRIGGERED at the trigger threshold (start event), TRIGGERED -> COOLDOWN
+// when the count falls back to the clear threshold (end event), COOLDOWN ->
+// IDLE after the cooldown. One burst gives exactly one start and one end.
+typedef enum {
+    CLASS_TRIGGER_IDLE = 0,
+    CLASS_TRIGGER_ARMED,
+    CLASS_TRIGGER_TRIGGERED,
+    CLASS_TRIGGER_COOLDOWN
+} class_trigger_state_t;
+
+typedef enum {
+    CLASS_TRIGGER_NONE = 0,
+    CLASS_TRIGGER_START,
+    CLASS_TRIGGER_END
+} class_trigger_event_t;
+
+// ===== CLASS COUNTER =====
+// ResolutionMs is a floor on the slot width, on top of the configured one.
+// Capacity is the wheel size: RAM is 2 bytes per slot whatever the threshold.
+template <uint8_t ClassId, uint32_t ResolutionMs = 0, uint16_t Capacity = CLASS_COUNTER_SLOTS>
+struct class_counter_t {
+    static_assert(ClassId < DETECTION_CLASS_COUNT, "class_counter_t for a class outside DETECTION_CLASS_COUNT");
+
+    static constexpr uint8_t class_id = ClassId;
+
+    time_wheel_t<Capacity> wheel;
+    ewma_rate_t ewma;
+    bool enabled;
+    uint8_t mode;                   // class_counter_mode_t
+    uint8_t state;                  // class_trigger_state_t
+    uint32_t count_threshold;       // Rising threshold, 0 = count only
+    uint32_t clear_threshold;       // Falling threshold, below count_threshold
+    uint32_t cooldown_ms;
+    uint32_t total_detections;
+    uint32_t triggers_sent;
+    uint32_t last_trigger_time;     // Start of the current or last trigger
+    uint32_t state_time;            // millis() at the last state change
+    uint32_t peak_count;            // Highest count of the current or last trigger
+    uint32_t last_duration_ms;      // Length of the last completed trigger
+
+    // clear = 0 picks half the trigger threshold
+    void configure(bool on, uint8_t trigger_mode, uint32_t threshold, uint32_t window_ms, uint32_t resolution_ms,
+                   uint32_t clear, uint32_t cooldown) {
+        enabled = on;
+        mode = trigger_mode;
+        count_threshold = threshold;
+        clear_threshold = (clear == 0 || clear >= threshold) ? threshold / 2 : clear;
+        cooldown_ms = cooldown;
+        if (!enabled || count_threshold == 0) {
+            state = CLASS_TRIGGER_IDLE;
+        }
+        wheel.configure(window_ms, resolution_ms > ResolutionMs ? resolution_ms : ResolutionMs, millis());
+        ewma.configure(window_ms);
+    }
+
+    void clear() {
+        wheel.clear(millis());
+        ewma.clear(millis());
+        state = CLASS_TRIGGER_IDLE;
+        total_detections = 0;
+        triggers_sent = 0;
+        last_trigger_time = 0;
+        state_time = 0;
+        peak_count = 0;
+        last_duration_ms = 0;
+    }
+
+    void add(uint32_t timestamp) {
+        if (!enabled) {
+            return;
+        }
+        wheel.add(timestamp);
+        ewma.add(timestamp);
+        total_detections++;
+    }
+
+    uint32_t count() {
+        return enabled ? wheel.count(millis()) : 0;
+    }
+
+    float rate() {
+        return enabled ? ewma.rate_at(millis()) : 0.0f;
+    }
+
+    // What the thresholds compare against in the configured mode
+    uint32_t level() {
+        if (mode == CLASS_COUNTER_MODE_EWMA) {
+            return (uint32_t)(rate() * (float)wheel.window_ms / 1000.0f + 0.5f);
+        }
+        return count();
+    }
+
+    // Call on every detection and periodically, the end of a burst is only
+    // seen by the periodic calls
+    class_trigger_event_t check_trigger(uint32_t* count_out) {
+        if (!enabled || count_threshold == 0) {
+            return CLASS_TRIGGER_NONE;
+        }
+
+        uint32_t current_count = level();
+        uint32_t current_time = millis();
+        if (count_out) {
+            *count_out = current_count;
+        }
+
+        if (state == CLASS_TRIGGER_COOLDOWN) {
+            if (current_time - state_time < cooldown_ms) {
+                if (current_count >= count_threshold) {
+                    DEBUG_PRINT(3, "Class " + String(ClassId) + " trigger suppressed (cooldown)");
+                }
+                return CLASS_TRIGGER_NONE;
+            }
+            state = CLASS_TRIGGER_IDLE;
+            state_time = current_time;
+        }
+
+        if (state == CLASS_TRIGGER_TRIGGERED) {
+            if (current_count > peak_count) {
+                peak_count = current_count;
+            }
+            if (current_count > clear_threshold) {
+                return CLASS_TRIGGER_NONE;
+            }
+            state = CLASS_TRIGGER_COOLDOWN;
+            state_time = current_time;
+            last_duration_ms = current_time - last_trigger_time;
+            return CLASS_TRIGGER_END;
+        }
+
+        // IDLE or ARMED: the count alone decides, the clear threshold is the hysteresis
+        if (current_count >= count_threshold) {
+            state = CLASS_TRIGGER_TRIGGERED;
+            state_time = current_time;
+            last_trigger_time = current_time;
+            peak_count = current_count;
+            triggers_sent++;
+            return CLASS_TRIGGER_START;
+        }
+        uint8_t next = current_count > clear_threshold ? CLASS_TRIGGER_ARMED : CLASS_TRIGGER_IDLE;
+        if (next != state) {
+            state = next;
+            state_time = current_time;
+        }
+        return CLASS_TRIGGER_NONE;
+    }
+
+    bool triggered() const {
+        return state == CLASS_TRIGGER_TRIGGERED;
+    }
+
+    void rebase(uint32_t from, uint32_t to) {
+        wheel.rebase(from, to);
+        ewma.rebase(from, to);
+        last_trigger_time = last_trigger_time - from + to;
+        state_time = state_time - from + to;
+    }
+};
+
+// ===== COUNTER SET =====
+// One class_counter_t per itemList entry, chained at compile time. visit()
+// finds a class's counter with one compare per class; for_each() walks all.
+template <uint8_t Item, bool End = (Item >= DETECTION_CLASS_COUNT)>
+struct class_counter_set_t {
+    static_assert(itemList[Item].objectName != nullptr, "DETECTION_CLASS_COUNT exceeds the entries in itemList");
+
+    class_counter_t<itemList[Item].index> counter;
+    class_counter_set_t<Item + 1> next;
+
+    template <typename F>
+    bool visit(uint8_t object_class, F&& f) {
+        if (object_class == itemList[Item].index) {
+            f(counter);
+            return true;
+        }
+        return next.visit(object_class, f);
+    }
+
+    template <typename F>
+    void for_each(F&& f) {
+        f(counter);
+        next.for_each(f);
+    }
+};
+
+template <uint8_t Item>
+struct class_counter_set_t<Item, true> {
+    template <typename F>
+    bool visit(uint8_t object_class, F&& f) {
+        (void)object_class;
+        (void)f;
+        return false;
+    }
+
+    template <typename F>
+    void for_each(F&& f) {
+        (void)f;
+    }
+};
+
+// ===== COUNTER SNAPSHOT =====
+typedef struct {
+    bool enabled;
+    uint8_t mode;                   // class_counter_mode_t
+    uint32_t count_in_window;
+    uint32_t trigger_level;         // count_in_window, or the EWMA equivalent
+    float rate_per_s;               // EWMA
+    uint32_t count_threshold;
+    uint32_t window_ms;
+    uint32_t resolution_ms;         // Effective slot width
+    uint8_t slots;
+    uint32_t total_detections;
+    uint32_t triggers_sent;
+    uint32_t last_trigger_time;
+    uint8_t state;                  // class_trigger_state_t
+    uint32_t clear_threshold;
+    uint32_t cooldown_ms;
+    uint32_t peak_count;
+    uint32_t trigger_duration_ms;   // Current trigger so far, else the last one
+} class_counter_stats_t;
+
+// ===== CLASS COUNTER OPERATIONS =====
+void class_counter_init();
+void class_counter_configure();     // Re-read system_config.class_counters
+void class_counter_add_detection(uint8_t object_class, uint32_t timestamp);
+class_trigger_event_t class_counter_check_trigger(uint8_t object_class);
+void class_counter_process();       // Main loop, ends triggers once detections stop
+uint32_t class_counter_get_count_in_window(uint8_t object_class);
+float class_counter_get_rate(uint8_t object_class);         // EWMA detections per second
+bool class_counter_get_stats(uint8_t object_class, class_counter_stats_t* stats);
+void class_counter_reset();
+void class_counter_print_stats(uint8_t object_class);     // CLASS_UNKNOWN = all classes
+
+// ===== CLASS COUNTER CONFIGURATION =====
+bool class_counter_set_enabled(uint8_t object_class, bool enabled);
+bool class_counter_set_threshold(uint8_t object_class, uint32_t threshold);    // 0 = count only
+bool class_counter_set_window(uint8_t object_class, uint32_t window_seconds);
+bool class_counter_set_resolution(uint8_t object_class, uint32_t resolution_ms);    // 0 = auto
+bool class_counter_set_clear_threshold(uint8_t object_class, uint32_t threshold);    // 0 = auto
+bool class_counter_set_cooldown(uint8_t object_class, uint32_t cooldown_seconds);
+bool class_counter_set_mode(uint8_t object_class, uint8_t mode);
+
+// ===== CHECKPOINT =====
+// Counters are written as raw structs with every time rebased so that the
+// checkpoint instant is 0 - the boot instant of the run that restores them.
+// A restore re-applies the current configuration; a changed window layout
+// starts that counter's window over but keeps its totals.
+void class_counter_checkpoint_save(checkpoint_write_t write, uint32_t now);
+bool class_counter_checkpoint_restore(checkpoint_read_t read);
+uint32_t class_counter_checkpoint_signature();    // Changes with detections and trigger state
+
+// ===== UTILITY FUNCTIONS =====
+const char* class_trigger_state_to_string(uint8_t state);
+const char* class_counter_mode_to_string(uint8_t mode);
+uint8_t class_counter_string_to_mode(const char* mode_str);    // CLASS_COUNTER_MODE_COUNT if unknown
+
+// ===== LORA TRIGGER =====
+// Start: MT,<count>,<threshold>,<window_s>,<uptime_s> for motherboards,
+//        CT,<class>,<count>,<threshold>,<window_s> for every other class
+// End:   ME,<peak>,<duration_s>,<threshold>,<uptime_s> for motherboards,
+//        CE,<class>,<peak>,<duration_s>,<threshold> for every other class
+void send_class_trigger_lora(uint8_t object_class);
+void send_class_trigger_end_lora(uint8_t object_class);
+
+#endif // CLASS_COUNTER_H
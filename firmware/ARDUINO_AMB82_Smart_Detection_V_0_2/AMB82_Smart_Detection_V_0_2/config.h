@@ -6,7 +6,7 @@
 
 // ===== SYSTEM VERSION =====
 #define SYSTEM_VERSION "2.0.0"
-#define CONFIG_VERSION 2
+#define CONFIG_VERSION 12
 
 // ===== PIN DEFINITIONS =====
 #define PIN_FAN                10
@@ -20,17 +20,56 @@
 #define DETECTION_INTERVAL     100              // 100ms
 #define LASER_BLINK_INTERVAL   500              // 500ms
 #define SERIAL_TIMEOUT         50               // 50ms
+#define MAIN_LOOP_DELAY        5                // 5ms, NN results are queued
 
 // ===== DETECTION THRESHOLDS =====
 #define DEFAULT_DETECTION_THRESHOLD     0.7f    // 70%
 #define DEFAULT_MOTHERBOARD_THRESHOLD   0.6f    // 60%
 #define MAX_DETECTION_RESULTS          10
 
-// ===== MOTHERBOARD COUNTER SETTINGS =====
+// ===== DETECTION COUNTER SETTINGS =====
+// One sliding-window counter per class, see class_counter.h
 #define DEFAULT_MOTHERBOARD_COUNT_THRESHOLD    50       // 50 detections
-#define DEFAULT_MOTHERBOARD_COUNT_WINDOW       10000    // 10 seconds
+#define DEFAULT_MOTHERBOARD_COUNT_WINDOW       10       // 10 seconds
 #define DEFAULT_MOTHERBOARD_COUNT_ENABLED      1        // Enabled
-#define MOTHERBOARD_DETECTION_BUFFER_SIZE      100      // Buffer size
+#define DEFAULT_LED_COUNT_THRESHOLD            0        // Count only, no trigger
+#define DEFAULT_LED_COUNT_WINDOW               60       // 1 minute
+#define DEFAULT_LED_COUNT_ENABLED              1
+#define DEFAULT_COUNT_RESOLUTION               0        // ms per slot, 0 = finest the wheel allows
+#define DEFAULT_COUNT_CLEAR_THRESHOLD          0        // Falling threshold, 0 = half the trigger threshold
+#define DEFAULT_COUNT_COOLDOWN                 30       // Seconds after a trigger ends before it can re-arm
+#define DEFAULT_COUNT_MODE                     0        // Sliding window, see class_counter_mode_t
+#define CLASS_COUNTER_SLOTS                    128      // Time wheel slots, caps the resolution
+#define CLASS_COUNTER_MAX_THRESHOLD            10000
+#define CLASS_COUNTER_MAX_WINDOW               3600     // Seconds
+#define CLASS_COUNTER_MAX_RESOLUTION           60000    // ms
+#define CLASS_COUNTER_MAX_COOLDOWN             3600     // Seconds
+
+// ===== NN FRAME RATE GOVERNOR =====
+#define DEFAULT_NN_GOVERNOR_ENABLED     1
+#define DEFAULT_NN_IDLE_TIMEOUT         (5 * 60 * 1000) // 5 minutes without detections
+#define DEFAULT_NN_IDLE_FPS             1
+
+// ===== MOTION GATE =====
+#define DEFAULT_MOTION_GATE_ENABLED     0
+#define DEFAULT_MOTION_THRESHOLD        2       // Mean abs luminance difference
+
+// ===== STATE CHECKPOINT =====
+#define DEFAULT_CHECKPOINT_INTERVAL     300     // Seconds between counter checkpoints, 0 = off
+#define CHECKPOINT_MIN_INTERVAL         10      // Seconds, bounds the flash write rate
+
+// ===== DETECTION LOG EVENTS =====
+#define DEFAULT_LOG_EVENT_GAP           10      // Seconds, hits of a class on one region closer than this share a record, 0 = a record per hit
+#define LOG_EVENT_MAX_GAP               3600
+
+// ===== REGION OF INTEREST ZONES =====
+#define ROI_MAX_ZONES          4
+#define ROI_GRID_COLS          32       // Zone lookup grid over the NN frame
+#define ROI_GRID_ROWS          16
+
+// ===== TRIGGER RULES =====
+#define TRIGGER_MAX_RULES      6
+#define TRIGGER_MAX_WINDOW     65535    // Seconds
 
 // ===== LORA SETTINGS =====
 #define LORA_BAUD_RATE         115200
@@ -38,27 +77,59 @@
 #define LORA_TIMEOUT           5000
 
 // ===== FLASH MEMORY LAYOUT =====
-#define FLASH_CONFIG_OFFSET    0x1E00
-#define FLASH_LOG_OFFSET       0x1F00
+#define FLASH_CONFIG_OFFSET    0x1000      // Config slots, one per sector, A/B
+#define FLASH_CONFIG_SLOTS     2
+#define FLASH_CONFIG_SIZE      0x0100      // Full image at the start of a slot, changed words after it
+#define FLASH_CONFIG_LEGACY_OFFSET  0x1E00  // Single copy of older builds, read once, inside slot A
+#define CONFIG_AUTOSAVE_DELAY_MS    5000    // After the last settings command
 #define FLASH_SIZE             0x1000
+#define FLASH_APP_AREA_SIZE    0x30000     // FLASH_MEMORY_APP_BASE to the end of the 16MB flash
+#define FLASH_SECTOR_SIZE      0x1000      // Erase unit
+#define FLASH_CHECKPOINT_OFFSET     0x3000      // Counter checkpoints, one per sector
+#define FLASH_CHECKPOINT_SLOTS      4
+#define FLASH_LOG_OFFSET       0x7000      // Detection log journal
+#define FLASH_LOG_SECTORS      16
+#define FLASH_SECTOR_ENDURANCE 100000      // Erase cycles, NOR datasheet minimum
+#define FLASH_LOG_STAGE_RECORDS     12      // Log records staged in RAM, 12 x 20B fit one 256B program page
+#define FLASH_LOG_OPEN_EVENTS       4       // Detection log events merging hits at a time
+#define FLASH_LOG_STAGE_MAX_MS      5000    // Oldest staged record is flushed after this long
 
 // ===== DETECTION CLASSES =====
 #define CLASS_LED_ON           0
 #define CLASS_MOTHERBOARD      1
 #define CLASS_UNKNOWN          255
+#define DETECTION_CLASS_COUNT  2
+
+// ===== DETECTION COUNTER CONFIGURATION =====
+typedef struct {
+    uint8_t enabled;
+    uint8_t mode;                   // class_counter_mode_t, what the thresholds compare against
+    uint16_t count_threshold;       // Detections in window to trigger, 0 = count only
+    uint16_t window_s;
+    uint16_t resolution_ms;         // Slot width, 0 = auto
+    uint16_t clear_threshold;       // Trigger ends at or below this count, 0 = auto
+    uint16_t cooldown_s;            // Quiet time after a trigger ends
+} class_counter_config_t;
+
+// ===== ROI ZONE CONFIGURATION =====
+typedef struct {
+    uint8_t enabled;
+    uint16_t x_min, y_min, x_max, y_max;   // NN frame pixels (NNWIDTH x NNHEIGHT)
+    uint16_t count_threshold;              // Motherboards in window to trigger, 0 = count only
+} roi_zone_config_t;
 
-// ===== MOTHERBOARD DETECTION COUNTER =====
+// ===== TRIGGER RULE CONFIGURATION =====
 typedef struct {
-    uint32_t detection_timestamps[MOTHERBOARD_DETECTION_BUFFER_SIZE];
-    uint8_t buffer_index;
-    uint8_t buffer_count;
-    uint32_t total_motherboard_detections;
-    uint32_t lora_triggers_sent;
-    uint32_t last_lora_trigger_time;
-    bool enabled;
-    uint32_t count_threshold;
-    uint32_t time_window_ms;
-} motherboard_counter_t;
+    uint8_t enabled;
+    uint8_t object_class;
+    uint8_t aggregation;            // trigger_aggregation_t
+    uint8_t actions;                // TRIGGER_ACTION_* bits
+    uint16_t window_s;              // Window, or the silence that counts as absence
+    uint16_t threshold;             // Detections in window, or per minute for RATE
+    uint16_t cooldown_s;            // Minimum time between two firings
+    uint8_t lora_type;              // lora_message_type_t for TRIGGER_ACTION_LORA
+    uint8_t led_pattern;            // LED_PATTERN_* for TRIGGER_ACTION_LED
+} trigger_rule_config_t;
 
 // ===== SYSTEM CONFIGURATION =====
 typedef struct {
@@ -78,10 +149,29 @@ typedef struct {
     uint8_t detection_enabled;
     uint8_t crosshair_enabled;
     
-    // Motherboard Counter Settings
-    uint8_t motherboard_count_enabled;
-    uint32_t motherboard_count_threshold;
-    uint32_t motherboard_count_window_ms;
+    // Detection Counter Settings, indexed by class
+    class_counter_config_t class_counters[DETECTION_CLASS_COUNT];
+    
+    // NN Frame Rate Governor
+    uint8_t nn_governor_enabled;
+    uint8_t nn_idle_fps;
+    uint32_t nn_idle_timeout_ms;
+    
+    // Motion Gate
+    uint8_t motion_gate_enabled;
+    uint8_t motion_threshold;
+    
+    // Region of Interest Zones (none enabled = whole frame)
+    roi_zone_config_t roi_zones[ROI_MAX_ZONES];
+    
+    // Trigger Rules (evaluated next to the motherboard counter)
+    trigger_rule_config_t trigger_rules[TRIGGER_MAX_RULES];
+    
+    // Counter State Checkpoint
+    uint16_t checkpoint_interval_s;
+    
+    // Detection Log Events
+    uint16_t log_event_gap_s;
     
     // GPIO Settings
     uint32_t fan_cycle_interval;
@@ -129,6 +219,11 @@ typedef enum {
     SYS_STATE_MAINTENANCE
 } system_state_t;
 
+// ===== STATE CHECKPOINT CALLBACKS =====
+// Modules serialize their runtime state through these, see state_checkpoint.h
+typedef void (*checkpoint_write_t)(const void* data, uint32_t size);
+typedef bool (*checkpoint_read_t)(void* data, uint32_t size);
+
 // ===== GLOBAL CONFIGURATION =====
 extern system_config_t system_config;
 extern system_state_t system_state;
@@ -165,9 +260,23 @@ extern system_state_t system_state;
     .motherboard_threshold = DEFAULT_MOTHERBOARD_THRESHOLD, \
     .detection_enabled = 1, \
     .crosshair_enabled = 1, \
-    .motherboard_count_enabled = DEFAULT_MOTHERBOARD_COUNT_ENABLED, \
-    .motherboard_count_threshold = DEFAULT_MOTHERBOARD_COUNT_THRESHOLD, \
-    .motherboard_count_window_ms = DEFAULT_MOTHERBOARD_COUNT_WINDOW, \
+    .class_counters = { \
+        { DEFAULT_LED_COUNT_ENABLED, DEFAULT_COUNT_MODE, DEFAULT_LED_COUNT_THRESHOLD, \
+          DEFAULT_LED_COUNT_WINDOW, DEFAULT_COUNT_RESOLUTION, \
+          DEFAULT_COUNT_CLEAR_THRESHOLD, DEFAULT_COUNT_COOLDOWN }, \
+        { DEFAULT_MOTHERBOARD_COUNT_ENABLED, DEFAULT_COUNT_MODE, DEFAULT_MOTHERBOARD_COUNT_THRESHOLD, \
+          DEFAULT_MOTHERBOARD_COUNT_WINDOW, DEFAULT_COUNT_RESOLUTION, \
+          DEFAULT_COUNT_CLEAR_THRESHOLD, DEFAULT_COUNT_COOLDOWN } \
+    }, \
+    .nn_governor_enabled = DEFAULT_NN_GOVERNOR_ENABLED, \
+    .nn_idle_fps = DEFAULT_NN_IDLE_FPS, \
+    .nn_idle_timeout_ms = DEFAULT_NN_IDLE_TIMEOUT, \
+    .motion_gate_enabled = DEFAULT_MOTION_GATE_ENABLED, \
+    .motion_threshold = DEFAULT_MOTION_THRESHOLD, \
+    .roi_zones = {}, \
+    .trigger_rules = {}, \
+    .checkpoint_interval_s = DEFAULT_CHECKPOINT_INTERVAL, \
+    .log_event_gap_s = DEFAULT_LOG_EVENT_GAP, \
     .fan_cycle_interval = FAN_CYCLE_INTERVAL, \
     .fan_enabled = 1, \
     .laser_blink_interval = LASER_BLINK_INTERVAL, \
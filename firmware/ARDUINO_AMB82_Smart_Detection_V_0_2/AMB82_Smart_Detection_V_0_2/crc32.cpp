@@ -0,0 +1,59 @@
+// crc32.cpp - CRC-32 for Flash Integrity Checks Implementation
+#include "crc32.h"
+
+// ===== GLOBAL VARIABLES =====
+static uint32_t crc32_table[4][256];    // [k][b]: CRC of byte b followed by k zero bytes
+static bool crc32_ready = false;
+
+// ===== TABLES =====
+void crc32_init() {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32_POLYNOMIAL : crc >> 1;
+        }
+        crc32_table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (uint8_t k = 1; k < 4; k++) {
+            uint32_t previous = crc32_table[k - 1][i];
+            crc32_table[k][i] = (previous >> 8) ^ crc32_table[0][previous & 0xFF];
+        }
+    }
+    crc32_ready = true;
+}
+
+// ===== CRC =====
+uint32_t crc32_update(uint32_t crc, const void* data, uint32_t size) {
+    if (!crc32_ready) {
+        crc32_init();
+    }
+    
+    const uint8_t* bytes = (const uint8_t*)data;
+    crc = ~crc;
+    
+    // Bytes up to a word boundary, then a word per step (little endian)
+    while (size > 0 && ((uintptr_t)bytes & 3) != 0) {
+        crc = crc32_table[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+        size--;
+    }
+    while (size >= 4) {
+        uint32_t word;
+        memcpy(&word, bytes, 4);
+        crc ^= word;
+        crc = crc32_table[3][crc & 0xFF] ^ crc32_table[2][(crc >> 8) & 0xFF] ^
+              crc32_table[1][(crc >> 16) & 0xFF] ^ crc32_table[0][crc >> 24];
+        bytes += 4;
+        size -= 4;
+    }
+    while (size > 0) {
+        crc = crc32_table[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+        size--;
+    }
+    
+    return ~crc;
+}
+
+uint32_t crc32(const void* data, uint32_t size) {
+    return crc32_update(0, data, size);
+}
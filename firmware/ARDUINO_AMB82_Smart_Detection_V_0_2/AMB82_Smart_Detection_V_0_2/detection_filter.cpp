@@ -0,0 +1,149 @@
+// detection_filter.cpp - Per-Class Detection Post-Filter Implementation
+#include "detection_filter.h"
+#include "detection_manager.h"
+#include "ObjectClassList.h"
+
+// ===== COMPILE-TIME RULE TABLE =====
+// Aspect limits are pre-scaled to normalized box units so the check is two
+// multiplies, no division
+static constexpr float nn_aspect_scale = (float)NNHEIGHT / (float)NNWIDTH;
+
+static constexpr detection_filter_rule_t detection_filter_rule(const ObjectDetectionItem& item) {
+    return {
+        item.filter != 0 && item.objectName != nullptr,
+        item.index,
+        item.minArea,
+        item.maxArea,
+        item.minAspect * nn_aspect_scale,
+        item.maxAspect * nn_aspect_scale
+    };
+}
+
+static constexpr detection_filter_rule_t filter_rules[DETECTION_CLASS_COUNT] = {
+    detection_filter_rule(itemList[CLASS_LED_ON]),
+    detection_filter_rule(itemList[CLASS_MOTHERBOARD]),
+};
+
+static_assert(sizeof(itemList) / sizeof(itemList[0]) >= DETECTION_CLASS_COUNT,
+              "itemList must describe every detection class");
+static_assert(itemList[CLASS_LED_ON].index == CLASS_LED_ON &&
+              itemList[CLASS_MOTHERBOARD].index == CLASS_MOTHERBOARD,
+              "itemList order must match the CLASS_* model indices");
+static_assert(filter_rules[CLASS_MOTHERBOARD].object_class == CLASS_MOTHERBOARD,
+              "filter rule table must be indexed by model class");
+
+// ===== GLOBAL VARIABLES =====
+// Confidence thresholds are runtime settings, everything else is constexpr
+static float filter_thresholds[DETECTION_CLASS_COUNT];
+static detection_filter_stats_t filter_stats = {0};
+
+// ===== FILTER INITIALIZATION =====
+void detection_filter_init() {
+    detection_filter_set_thresholds(system_config.detection_threshold, system_config.motherboard_threshold);
+    detection_filter_reset_stats();
+}
+
+void detection_filter_set_thresholds(float detection_threshold, float motherboard_threshold) {
+    for (uint8_t c = 0; c < DETECTION_CLASS_COUNT; c++) {
+        filter_thresholds[c] = (filter_rules[c].object_class == CLASS_MOTHERBOARD)
+                               ? motherboard_threshold : detection_threshold;
+    }
+}
+
+float detection_filter_get_threshold(uint8_t object_class) {
+    if (object_class >= DETECTION_CLASS_COUNT) {
+        return DETECTION_CONFIDENCE_MAX;
+    }
+    return filter_thresholds[object_class];
+}
+
+// ===== FILTER STAGE =====
+filter_verdict_t detection_filter_check(const detection_frame_t& frame, uint8_t index) {
+    int obj_type = frame.object_type[index];
+    if (obj_type < 0 || obj_type >= DETECTION_CLASS_COUNT || !filter_rules[obj_type].enabled) {
+        return FILTER_REJECT_CLASS;
+    }
+
+    if (frame.confidence[index] <= filter_thresholds[obj_type]) {
+        return FILTER_REJECT_CONFIDENCE;
+    }
+
+    const detection_filter_rule_t& rule = filter_rules[obj_type];
+    const detection_box_t& box = frame.box[index];
+    float w = box.x_max - box.x_min;
+    float h = box.y_max - box.y_min;
+
+    float area = w * h;
+    if (area < rule.min_area || area > rule.max_area) {
+        return FILTER_REJECT_AREA;
+    }
+
+    if (w < rule.min_aspect * h || w > rule.max_aspect * h) {
+        return FILTER_REJECT_ASPECT;
+    }
+
+    return FILTER_PASS;
+}
+
+uint8_t detection_filter_apply(const detection_frame_t& frame, uint8_t* indices, uint8_t* classes) {
+    uint8_t accepted = 0;
+
+    for (uint8_t i = 0; i < frame.result_count; i++) {
+        filter_verdict_t verdict = detection_filter_check(frame, i);
+        if (verdict != FILTER_PASS) {
+            filter_stats.rejected[verdict]++;
+            continue;
+        }
+
+        uint8_t object_class = filter_rules[frame.object_type[i]].object_class;
+        filter_stats.passed[object_class]++;
+        indices[accepted] = i;
+        classes[accepted] = object_class;
+        accepted++;
+    }
+
+    return accepted;
+}
+
+// ===== FILTER STATISTICS =====
+void detection_filter_get_stats(detection_filter_stats_t* stats) {
+    if (stats) {
+        *stats = filter_stats;
+    }
+}
+
+void detection_filter_reset_stats() {
+    memset(&filter_stats, 0, sizeof(filter_stats));
+}
+
+void detection_filter_print() {
+    Serial.println("\n=== DETECTION FILTER ===");
+    for (uint8_t c = 0; c < DETECTION_CLASS_COUNT; c++) {
+        const detection_filter_rule_t& rule = filter_rules[c];
+        Serial.println(String(detection_class_to_string(rule.object_class)) + ": " +
+                       String(rule.enabled ? "ON" : "OFF") +
+                       " conf>" + String(filter_thresholds[c], 2) +
+                       " area " + String(rule.min_area, 3) + "-" + String(rule.max_area, 3) +
+                       " aspect " + String(rule.min_aspect / nn_aspect_scale, 2) + "-" +
+                       String(rule.max_aspect / nn_aspect_scale, 2) +
+                       " (passed " + String(filter_stats.passed[c]) + ")");
+    }
+
+    Serial.println("Rejected:");
+    for (uint8_t v = FILTER_REJECT_CLASS; v < FILTER_VERDICT_COUNT; v++) {
+        Serial.println("  " + String(detection_filter_verdict_to_string((filter_verdict_t)v)) + ": " +
+                       String(filter_stats.rejected[v]));
+    }
+    Serial.println("========================\n");
+}
+
+const char* detection_filter_verdict_to_string(filter_verdict_t verdict) {
+    switch (verdict) {
+        case FILTER_PASS: return "PASS";
+        case FILTER_REJECT_CLASS: return "CLASS";
+        case FILTER_REJECT_CONFIDENCE: return "CONFIDENCE";
+        case FILTER_REJECT_AREA: return "AREA";
+        case FILTER_REJECT_ASPECT: return "ASPECT";
+        default: return "UNKNOWN";
+    }
+}
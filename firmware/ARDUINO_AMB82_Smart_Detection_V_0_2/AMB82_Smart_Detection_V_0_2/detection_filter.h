@@ -0,0 +1,55 @@
+// detection_filter.h - Per-Class Detection Post-Filter
+#ifndef DETECTION_FILTER_H
+#define DETECTION_FILTER_H
+
+#include "config.h"
+#include "detection_queue.h"
+
+// Cheap per-result rejection before the tracker, flash and LoRa see a result.
+// Rules are indexed by the raw model class, built at compile time from
+// ObjectClassList.h itemList, so the hot loop does no string lookups.
+
+// ===== FILTER VERDICTS =====
+typedef enum {
+    FILTER_PASS = 0,
+    FILTER_REJECT_CLASS,            // Unknown class or filter disabled in itemList
+    FILTER_REJECT_CONFIDENCE,
+    FILTER_REJECT_AREA,
+    FILTER_REJECT_ASPECT,
+    FILTER_VERDICT_COUNT
+} filter_verdict_t;
+
+// ===== FILTER RULE =====
+typedef struct {
+    bool enabled;
+    uint8_t object_class;           // CLASS_* reported downstream
+    float min_area;                 // Fraction of the NN frame
+    float max_area;
+    float min_aspect;               // Width/height in normalized units, i.e.
+    float max_aspect;               // pixel aspect scaled by NNHEIGHT/NNWIDTH
+} detection_filter_rule_t;
+
+// ===== FILTER STATISTICS =====
+typedef struct {
+    uint32_t passed[DETECTION_CLASS_COUNT];
+    uint32_t rejected[FILTER_VERDICT_COUNT];    // Indexed by verdict, [FILTER_PASS] unused
+} detection_filter_stats_t;
+
+// ===== FILTER OPERATIONS =====
+void detection_filter_init();
+void detection_filter_set_thresholds(float detection_threshold, float motherboard_threshold);
+float detection_filter_get_threshold(uint8_t object_class);
+filter_verdict_t detection_filter_check(const detection_frame_t& frame, uint8_t index);
+
+// Runs every result of the frame through the rules and writes the accepted
+// result indices and their CLASS_* into the caller's arrays
+// (MAX_DETECTION_RESULTS each). Returns the number accepted.
+uint8_t detection_filter_apply(const detection_frame_t& frame, uint8_t* indices, uint8_t* classes);
+
+// ===== FILTER STATISTICS =====
+void detection_filter_get_stats(detection_filter_stats_t* stats);
+void detection_filter_reset_stats();
+void detection_filter_print();
+const char* detection_filter_verdict_to_string(filter_verdict_t verdict);
+
+#endif // DETECTION_FILTER_H
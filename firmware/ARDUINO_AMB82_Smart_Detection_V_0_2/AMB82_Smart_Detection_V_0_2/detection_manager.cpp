@@ -0,0 +1,675 @@
+// detection_manager.cpp - Object Detection Pipeline Implementation
+#include "detection_manager.h"
+#include "motherboard_counter.h"
+#include "class_counter.h"
+#include "amb82_flash.h"
+#include "amb82_gpio.h"
+#include "lora_rak3172.h"
+#include "heap_probe.h"
+#include "detection_filter.h"
+#include "object_tracker.h"
+#include "roi_zones.h"
+#include "nn_governor.h"
+#include "trigger_rules.h"
+#include "ObjectClassList.h"
+
+// ===== GLOBAL DETECTION MANAGER =====
+detection_manager_t detection_manager = {0};
+
+// External functions/state from main file
+extern void safe_serial_print(const char* message);
+extern bool init_neural_network_core();
+extern bool init_wifi_on_demand();
+extern bool start_rtsp_streaming();
+extern bool neural_network_loaded;
+extern bool wifi_connected;
+extern bool rtsp_streaming;
+extern char wifi_ssid[32];
+extern char wifi_password[32];
+
+static const uint8_t object_class_count = sizeof(itemList) / sizeof(itemList[0]);
+
+// Close a pipeline stage, returns the time the next one starts at
+static inline uint32_t detection_stage_end(detection_stage_t stage, uint32_t start_us) {
+    uint32_t now_us = micros();
+    detection_manager.stats.stage_time_us[stage] += now_us - start_us;
+    detection_manager.stats.stage_calls[stage]++;
+    return now_us;
+}
+
+// ===== DETECTION INITIALIZATION =====
+detection_result_code_t detection_init() {
+    INFO_PRINT("Initializing detection manager...");
+
+    memset(&detection_manager, 0, sizeof(detection_manager));
+    detection_manager.enabled = system_config.detection_enabled;
+    detection_manager.process_interval = DETECTION_DEFAULT_INTERVAL;
+    detection_manager.confidence_threshold = system_config.detection_threshold;
+    detection_manager.motherboard_threshold = system_config.motherboard_threshold;
+
+    detection_queue_init();
+    detection_filter_init();
+    roi_init();
+    trigger_rules_init();
+    tracker_init();
+    detection_reset_statistics();
+
+    detection_manager.initialized = true;
+    INFO_PRINT("Detection manager initialized (queue depth " + String(DETECTION_QUEUE_DEPTH) + ")");
+    return DETECTION_SUCCESS;
+}
+
+detection_result_code_t detection_init_camera() {
+    // Camera and model are brought up together by the SDK sequence
+    if (!init_neural_network_core()) {
+        detection_manager.camera_active = false;
+        detection_manager.model_loaded = false;
+        return DETECTION_ERROR_CAMERA;
+    }
+
+    detection_manager.camera_active = true;
+    detection_manager.model_loaded = true;
+    return DETECTION_SUCCESS;
+}
+
+detection_result_code_t detection_init_model() {
+    detection_manager.model_loaded = neural_network_loaded;
+    return neural_network_loaded ? DETECTION_SUCCESS : DETECTION_ERROR_MODEL;
+}
+
+detection_result_code_t detection_init_streaming() {
+    detection_manager.rtsp_active = start_rtsp_streaming();
+    return detection_manager.rtsp_active ? DETECTION_SUCCESS : DETECTION_ERROR_INIT;
+}
+
+bool detection_is_initialized() {
+    return detection_manager.initialized;
+}
+
+// ===== DETECTION PROCESSING =====
+detection_result_code_t detection_process() {
+    if (!detection_manager.initialized) {
+        return DETECTION_SUCCESS;
+    }
+    if (!detection_manager.enabled) {
+        // The NN keeps producing; drop its frames now rather than let them
+        // fill the queue and run through the pipeline stale once re-enabled
+        detection_queue_discard();
+        return DETECTION_SUCCESS;
+    }
+
+    uint32_t now = millis();
+    if (detection_manager.process_interval > 0 &&
+        now - detection_manager.last_process_time < detection_manager.process_interval) {
+        return DETECTION_SUCCESS;
+    }
+    detection_manager.last_process_time = now;
+
+    detection_result_code_t result = DETECTION_SUCCESS;
+
+    try {
+        // Drain every frame the NN produced since the last call
+        uint32_t allocations_before = heap_probe_allocation_count();
+        detection_frame_t* frame;
+        while ((frame = detection_queue_peek()) != NULL) {
+            detection_process_frame(*frame);
+            detection_queue_pop();
+        }
+        detection_manager.stats.heap_allocations += heap_probe_allocation_count() - allocations_before;
+    } catch (...) {
+        detection_manager.stats.processing_errors++;
+        result = DETECTION_ERROR_PROCESSING;
+    }
+
+    // Close the frame rate window
+    detection_stats_t* stats = &detection_manager.stats;
+    uint32_t window = now - stats->fps_window_start;
+    if (window >= DETECTION_FPS_WINDOW_MS) {
+        stats->frames_per_second = (stats->fps_window_frames * 1000.0f) / window;
+        stats->fps_window_frames = 0;
+        stats->fps_window_start = now;
+    }
+
+    return result;
+}
+
+detection_result_code_t detection_process_frame(const detection_frame_t& frame) {
+    uint32_t start_us = micros();
+
+    detection_result_code_t result = detection_analyze_results(frame);
+
+    // Per-frame performance statistics
+    uint32_t elapsed_us = micros() - start_us;
+    detection_stats_t* stats = &detection_manager.stats;
+
+    stats->total_frames_processed++;
+    stats->fps_window_frames++;
+    stats->total_results_seen += frame.raw_result_count;
+    if (frame.raw_result_count > stats->max_results_per_frame) {
+        stats->max_results_per_frame = frame.raw_result_count;
+    }
+    stats->avg_results_per_frame = (float)stats->total_results_seen / stats->total_frames_processed;
+
+    stats->detection_processing_time_us = elapsed_us;
+    stats->total_processing_time_us += elapsed_us;
+    stats->avg_processing_time_us = (uint32_t)(stats->total_processing_time_us / stats->total_frames_processed);
+    if (elapsed_us < stats->min_processing_time_us) {
+        stats->min_processing_time_us = elapsed_us;
+    }
+    if (elapsed_us > stats->max_processing_time_us) {
+        stats->max_processing_time_us = elapsed_us;
+    }
+
+    return result;
+}
+
+// Keeps the frame for detection_get_result() and the CLI. Only the stored
+// results are copied, so an empty frame costs its header and nothing more.
+static void detection_keep_frame(const detection_frame_t& frame) {
+    detection_frame_t* kept = &detection_manager.current_frame;
+    uint8_t count = frame.result_count;
+
+    kept->sequence = frame.sequence;
+    kept->timestamp = frame.timestamp;
+    kept->result_count = count;
+    kept->raw_result_count = frame.raw_result_count;
+    memcpy(kept->object_type, frame.object_type, count * sizeof(frame.object_type[0]));
+    memcpy(kept->confidence, frame.confidence, count * sizeof(frame.confidence[0]));
+    memcpy(kept->box, frame.box, count * sizeof(frame.box[0]));
+    detection_manager.current_result_count = count;
+}
+
+detection_result_code_t detection_analyze_results(const detection_frame_t& frame) {
+    detection_keep_frame(frame);
+
+    uint32_t stage_us = micros();
+    uint8_t indices[MAX_DETECTION_RESULTS];
+    uint8_t classes[MAX_DETECTION_RESULTS];
+    uint8_t accepted = detection_filter_apply(frame, indices, classes);
+    detection_manager.stats.false_detections += frame.result_count - accepted;
+
+    // Discard results outside every ROI zone before they open a track
+    if (roi_is_active()) {
+        uint8_t kept = 0;
+        for (uint8_t j = 0; j < accepted; j++) {
+            if (roi_accept(frame.box[indices[j]])) {
+                indices[kept] = indices[j];
+                classes[kept] = classes[j];
+                kept++;
+            }
+        }
+        detection_manager.stats.roi_rejected += accepted - kept;
+        accepted = kept;
+    }
+    stage_us = detection_stage_end(DETECTION_STAGE_FILTER, stage_us);
+
+    // Anything that survived filtering keeps the NN at full rate
+    nn_governor_on_frame(accepted > 0);
+
+    // Empty frames still go through the tracker so lost objects expire
+    tracker_event_t events[TRACKER_MAX_EVENTS];
+    uint8_t event_count = tracker_update(frame, indices, classes, accepted, events, TRACKER_MAX_EVENTS);
+    detection_stage_end(DETECTION_STAGE_TRACKER, stage_us);
+
+    for (uint8_t e = 0; e < event_count; e++) {
+        if (events[e].type == TRACK_EVENT_START) {
+            detection_handle_result(frame, events[e].result_index, events[e].object_class);
+        } else {
+            detection_handle_track_end(events[e]);
+        }
+    }
+
+    return frame.result_count == 0 ? DETECTION_ERROR_NO_RESULTS : DETECTION_SUCCESS;
+}
+
+// ===== DETECTION HANDLER =====
+// Steady-state path is heap free: the frame is read in place and all text is
+// formatted into stack buffers.
+static void detection_send_lora(uint8_t object_class, float confidence) {
+    char msg[30];
+    snprintf(msg, sizeof(msg), "%d,%.2f", object_class, confidence);
+
+    lora_result_t result = lora_send_message(LORA_MSG_DETECTION, msg);
+    if (result != LORA_SUCCESS) {
+        DEBUG_PRINT(3, "[LoRa] Failed: " + String(lora_result_to_string(result)));
+    } else {
+        DEBUG_PRINT(3, "[LoRa] Sent: " + String(msg));
+    }
+}
+
+void detection_handle_result(const detection_frame_t& frame, uint8_t index, uint8_t object_class) {
+    float confidence = frame.confidence[index];
+    uint32_t stage_us = micros();
+    uint8_t zone_triggers = 0;
+
+    // Add to the class counter and check if its trigger threshold is reached
+    class_counter_add_detection(object_class, frame.timestamp);
+    class_trigger_event_t trigger_event = class_counter_check_trigger(object_class);
+    bool triggered = trigger_event == CLASS_TRIGGER_START;
+
+    if (object_class == CLASS_MOTHERBOARD) {
+        detection_manager.last_motherboard_confidence = confidence;
+
+        // Per-zone counters and triggers
+        uint8_t zone_mask = roi_zone_mask(frame.box[index]);
+        for (uint8_t zone = 0; zone_mask && zone < ROI_MAX_ZONES; zone++) {
+            if (!(zone_mask & (1 << zone))) {
+                continue;
+            }
+            motherboard_counter_zone_add_detection(zone, frame.timestamp);
+            class_trigger_event_t zone_event = motherboard_counter_zone_check_trigger(zone);
+            if (zone_event == CLASS_TRIGGER_START) {
+                zone_triggers |= (1 << zone);
+            } else if (zone_event == CLASS_TRIGGER_END) {
+                send_zone_trigger_end_lora(zone);
+            }
+        }
+    }
+
+    // Configurable rules, one pass over all of them per event
+    uint8_t rule_triggers = trigger_rules_on_detection(object_class, frame.timestamp);
+    stage_us = detection_stage_end(DETECTION_STAGE_COUNTER, stage_us);
+
+    if (triggered) {
+        // Send LoRa trigger message
+        send_class_trigger_lora(object_class);
+
+        // Special visual indication
+        gpio_status_led_set_pattern(LED_PATTERN_TRIPLE_BLINK);
+
+        char line[64];
+        snprintf(line, sizeof(line), "🚨 %s DETECTION TRIGGER ACTIVATED!", detection_class_to_string(object_class));
+        safe_serial_print(line);
+        safe_serial_print("📡 LoRa trigger message sent");
+    } else if (trigger_event == CLASS_TRIGGER_END) {
+        // Usually ended by class_counter_process(), unless a detection gets there first
+        send_class_trigger_end_lora(object_class);
+    }
+    for (uint8_t zone = 0; zone_triggers && zone < ROI_MAX_ZONES; zone++) {
+        if (zone_triggers & (1 << zone)) {
+            send_zone_trigger_lora(zone);
+            gpio_status_led_set_pattern(LED_PATTERN_TRIPLE_BLINK);
+        }
+    }
+    if (trigger_event != CLASS_TRIGGER_NONE || zone_triggers) {
+        detection_stage_end(DETECTION_STAGE_LORA, stage_us);
+    }
+
+    // Create detection result for logging
+    detection_result_t det_result = { 0 };
+    detection_convert_frame_result(frame, index, &det_result);
+    det_result.object_class = object_class;
+
+    detection_update_statistics(&det_result);
+
+    // Log to flash
+    if (flash_is_initialized()) {
+        stage_us = micros();
+        flash_write_detection_log(&det_result);
+        detection_stage_end(DETECTION_STAGE_FLASH, stage_us);
+    }
+
+    // Visual feedback
+    gpio_status_led_set_pattern(LED_PATTERN_FAST_BLINK);
+    gpio_laser_force_off();
+
+    // Rule actions after the per-detection feedback so their LED and laser stick
+    if (rule_triggers) {
+        stage_us = micros();
+        for (uint8_t rule = 0; rule < TRIGGER_MAX_RULES; rule++) {
+            if (rule_triggers & (1 << rule)) {
+                trigger_rules_run_actions(rule);
+            }
+        }
+        detection_stage_end(DETECTION_STAGE_LORA, stage_us);
+    }
+
+    // LoRa transmission for high-confidence detections
+    if (lora_is_initialized() && confidence >= detection_filter_get_threshold(object_class)) {
+        stage_us = micros();
+        detection_send_lora(object_class, confidence);
+        detection_stage_end(DETECTION_STAGE_LORA, stage_us);
+    }
+
+    // Keep the trigger pattern on the status LED while the motherboard trigger is active
+    if (object_class == CLASS_MOTHERBOARD && motherboard_counter_is_triggered()) {
+        gpio_status_led_set_pattern(LED_PATTERN_TRIPLE_BLINK);
+    }
+
+    if (detection_manager.callback) {
+        detection_manager.callback(&det_result);
+    }
+
+    // Print detection info safely
+    char line[96];
+    snprintf(line, sizeof(line), "🎯 %s detected: %.1f%% (Count: %lu/%u)",
+             detection_class_to_string(object_class), confidence * 100.0f,
+             (unsigned long)class_counter_get_count_in_window(object_class),
+             (unsigned)system_config.class_counters[object_class].count_threshold);
+    safe_serial_print(line);
+}
+
+void detection_handle_track_end(const tracker_event_t& event) {
+    char line[96];
+    snprintf(line, sizeof(line), "%s #%u left after %lums (%u frames, max %.1f%%)",
+             detection_class_to_string(event.object_class), (unsigned)event.track_id,
+             (unsigned long)event.duration_ms, (unsigned)event.hits, event.confidence * 100.0f);
+    DEBUG_PRINT(2, line);
+}
+
+void detection_update_statistics(detection_result_t* result) {
+    if (!result) {
+        return;
+    }
+
+    detection_stats_t* stats = &detection_manager.stats;
+    stats->total_detections_found++;
+    stats->last_detection_time = result->timestamp;
+
+    if (result->object_class == CLASS_LED_ON) {
+        stats->led_on_detections++;
+    } else if (result->object_class == CLASS_MOTHERBOARD) {
+        stats->motherboard_detections++;
+    }
+
+    if (result->object_class >= DETECTION_CLASS_COUNT) {
+        return;
+    }
+
+    detection_class_stats_t* cls = &stats->class_stats[result->object_class];
+    if (cls->count == 0 || result->confidence < cls->min_confidence) {
+        cls->min_confidence = result->confidence;
+    }
+    if (cls->count == 0 || result->confidence > cls->max_confidence) {
+        cls->max_confidence = result->confidence;
+    }
+    cls->sum_confidence += result->confidence;
+    cls->count++;
+}
+
+// ===== DETECTION CONFIGURATION =====
+detection_result_code_t detection_set_thresholds(float detection_threshold, float motherboard_threshold) {
+    if (detection_threshold < 0.0f || detection_threshold > DETECTION_CONFIDENCE_MAX ||
+        motherboard_threshold < 0.0f || motherboard_threshold > DETECTION_CONFIDENCE_MAX) {
+        return DETECTION_ERROR_PROCESSING;
+    }
+
+    detection_manager.confidence_threshold = detection_threshold;
+    detection_manager.motherboard_threshold = motherboard_threshold;
+    system_config.detection_threshold = detection_threshold;
+    system_config.motherboard_threshold = motherboard_threshold;
+    detection_filter_set_thresholds(detection_threshold, motherboard_threshold);
+    return DETECTION_SUCCESS;
+}
+
+detection_result_code_t detection_enable(bool enable) {
+    detection_manager.enabled = enable;
+    system_config.detection_enabled = enable;
+    INFO_PRINT("Detection " + String(enable ? "enabled" : "disabled"));
+    return DETECTION_SUCCESS;
+}
+
+detection_result_code_t detection_set_process_interval(uint32_t interval_ms) {
+    detection_manager.process_interval = interval_ms;
+    return DETECTION_SUCCESS;
+}
+
+void detection_set_callback(detection_callback_t callback) {
+    detection_manager.callback = callback;
+}
+
+// ===== DETECTION RESULTS HANDLING =====
+uint8_t detection_get_result_count() {
+    return detection_manager.current_result_count;
+}
+
+detection_result_code_t detection_get_result(uint8_t index, detection_result_t* result) {
+    if (!result || index >= detection_manager.current_result_count) {
+        return DETECTION_ERROR_NO_RESULTS;
+    }
+
+    return detection_convert_frame_result(detection_manager.current_frame, index, result);
+}
+
+bool detection_has_motherboard_detected() {
+    const detection_frame_t& frame = detection_manager.current_frame;
+    for (uint8_t i = 0; i < frame.result_count; i++) {
+        if (frame.object_type[i] == CLASS_MOTHERBOARD &&
+            detection_filter_check(frame, i) == FILTER_PASS) {
+            return true;
+        }
+    }
+    return false;
+}
+
+float detection_get_last_motherboard_confidence() {
+    return detection_manager.last_motherboard_confidence;
+}
+
+uint32_t detection_get_last_detection_time() {
+    return detection_manager.stats.last_detection_time;
+}
+
+// ===== DETECTION STATISTICS =====
+void detection_get_statistics(detection_stats_t* stats) {
+    if (stats) {
+        *stats = detection_manager.stats;
+    }
+}
+
+void detection_reset_statistics() {
+    memset(&detection_manager.stats, 0, sizeof(detection_manager.stats));
+    detection_manager.stats.min_processing_time_us = UINT32_MAX;
+    detection_manager.stats.fps_window_start = millis();
+    detection_queue_reset_stats();
+    detection_filter_reset_stats();
+    roi_reset_stats();
+}
+
+void detection_print_statistics() {
+    detection_stats_t* stats = &detection_manager.stats;
+    detection_queue_stats_t queue_stats;
+    detection_queue_get_stats(&queue_stats);
+
+    Serial.println("\n=== DETECTION STATISTICS ===");
+    Serial.println("Enabled: " + String(detection_manager.enabled ? "YES" : "NO"));
+    Serial.println("Detection Threshold: " + String(system_config.detection_threshold));
+    Serial.println("Motherboard Threshold: " + String(system_config.motherboard_threshold));
+    Serial.println("Total Detections: " + String(stats->total_detections_found) +
+                   " (LED:" + String(stats->led_on_detections) + ", MB:" + String(stats->motherboard_detections) + ")");
+    Serial.println("Rejected Results: " + String(stats->false_detections) + " (see 'detection filter')");
+    if (roi_is_active()) {
+        Serial.println("Outside ROI: " + String(stats->roi_rejected) + " (see 'roi')");
+    }
+    tracker_stats_t track_stats;
+    tracker_get_stats(&track_stats);
+    if (tracker_is_enabled()) {
+        Serial.println("Tracks: " + String(track_stats.tracks_started) + " started, " +
+                       String(track_stats.tracks_ended) + " ended, " +
+                       String(track_stats.active_tracks) + " active");
+    } else {
+        Serial.println("Tracks: tracker disabled, counting every frame");
+    }
+    Serial.println("Processing Errors: " + String(stats->processing_errors));
+
+    Serial.println("\nThroughput:");
+    Serial.println("  Frames Processed: " + String(stats->total_frames_processed));
+    Serial.println("  Frame Rate: " + String(stats->frames_per_second, 1) + " fps (target " + String(DETECTION_NN_TARGET_FPS) + ")");
+    Serial.println("  Results/Frame: " + String(stats->avg_results_per_frame, 2) + " avg, " +
+                   String(stats->max_results_per_frame) + " max");
+    Serial.println("  Queue: " + String(queue_stats.frames_dropped) + " dropped, high water " +
+                   String(queue_stats.high_water) + "/" + String(DETECTION_QUEUE_DEPTH) +
+                   ", latency " + String(queue_stats.last_latency_ms) + "ms (max " + String(queue_stats.max_latency_ms) + "ms)");
+
+    Serial.println("\nProcessing Time (per frame):");
+    if (stats->total_frames_processed > 0) {
+        Serial.println("  Last: " + String(stats->detection_processing_time_us) + "us");
+        Serial.println("  Avg/Min/Max: " + String(stats->avg_processing_time_us) + "/" +
+                       String(stats->min_processing_time_us) + "/" +
+                       String(stats->max_processing_time_us) + "us");
+    } else {
+        Serial.println("  No frames processed yet");
+    }
+    if (heap_probe_is_enabled()) {
+        Serial.println("  Heap Allocations: " + String(stats->heap_allocations));
+    }
+
+    Serial.println("\nStage Cost (total/calls/avg):");
+    for (uint8_t s = 0; s < DETECTION_STAGE_COUNT; s++) {
+        uint32_t calls = stats->stage_calls[s];
+        Serial.println("  " + String(detection_stage_to_string((detection_stage_t)s)) + ": " +
+                       String((uint32_t)stats->stage_time_us[s]) + "us/" + String(calls) + "/" +
+                       String(calls ? (float)stats->stage_time_us[s] / calls : 0.0f, 1) + "us");
+    }
+
+    Serial.println("\nConfidence per Class (min/avg/max):");
+    for (uint8_t c = 0; c < DETECTION_CLASS_COUNT; c++) {
+        detection_class_stats_t* cls = &stats->class_stats[c];
+        if (cls->count == 0) {
+            Serial.println("  " + String(detection_class_to_string(c)) + ": no detections");
+            continue;
+        }
+        Serial.println("  " + String(detection_class_to_string(c)) + ": " +
+                       String(cls->min_confidence, 2) + "/" +
+                       String(cls->sum_confidence / cls->count, 2) + "/" +
+                       String(cls->max_confidence, 2) + " (" + String(cls->count) + ")");
+    }
+    Serial.println("============================\n");
+}
+
+void detection_print_current_results() {
+    const detection_frame_t& frame = detection_manager.current_frame;
+
+    Serial.println("\n=== CURRENT RESULTS (frame " + String(frame.sequence) + ") ===");
+    if (frame.result_count == 0) {
+        Serial.println("No results");
+    }
+    for (uint8_t i = 0; i < frame.result_count; i++) {
+        Serial.println(String(i) + ": " + String(detection_get_object_name(frame.object_type[i])) +
+                       " conf=" + String(frame.confidence[i], 2) +
+                       " box=(" + String(frame.box[i].x_min, 2) + "," + String(frame.box[i].y_min, 2) +
+                       ")-(" + String(frame.box[i].x_max, 2) + "," + String(frame.box[i].y_max, 2) + ")");
+    }
+    Serial.println("=================================\n");
+}
+
+// ===== WIFI AND STREAMING =====
+detection_result_code_t detection_setup_wifi(const char* ssid, const char* password) {
+    if (!ssid || !password) {
+        return DETECTION_ERROR_INIT;
+    }
+
+    strncpy(wifi_ssid, ssid, 31);
+    wifi_ssid[31] = '\0';
+    strncpy(wifi_password, password, 31);
+    wifi_password[31] = '\0';
+
+    detection_manager.wifi_connected = init_wifi_on_demand();
+    return detection_manager.wifi_connected ? DETECTION_SUCCESS : DETECTION_ERROR_INIT;
+}
+
+bool detection_is_wifi_connected() {
+    return wifi_connected;
+}
+
+const char* detection_get_rtsp_url() {
+    return rtsp_streaming ? "rtsp://<device-ip>:554/testStream" : "";
+}
+
+void detection_print_network_info() {
+    Serial.println("WiFi: " + String(wifi_connected ? "CONNECTED" : "DISCONNECTED") + " (" + String(wifi_ssid) + ")");
+    Serial.println("RTSP: " + String(rtsp_streaming ? "ACTIVE" : "INACTIVE"));
+}
+
+// ===== DETECTION UTILITIES =====
+const char* detection_result_code_to_string(detection_result_code_t code) {
+    switch (code) {
+        case DETECTION_SUCCESS: return "SUCCESS";
+        case DETECTION_ERROR_INIT: return "INIT_ERROR";
+        case DETECTION_ERROR_CAMERA: return "CAMERA_ERROR";
+        case DETECTION_ERROR_MODEL: return "MODEL_ERROR";
+        case DETECTION_ERROR_PROCESSING: return "PROCESSING_ERROR";
+        case DETECTION_ERROR_NO_RESULTS: return "NO_RESULTS";
+        default: return "UNKNOWN_ERROR";
+    }
+}
+
+const char* detection_class_to_string(uint8_t class_id) {
+    switch (class_id) {
+        case CLASS_LED_ON: return "LED";
+        case CLASS_MOTHERBOARD: return "MOTHERBOARD";
+        default: return "UNKNOWN";
+    }
+}
+
+const char* detection_stage_to_string(detection_stage_t stage) {
+    switch (stage) {
+        case DETECTION_STAGE_FILTER: return "Filter";
+        case DETECTION_STAGE_TRACKER: return "Tracker";
+        case DETECTION_STAGE_COUNTER: return "Counter";
+        case DETECTION_STAGE_FLASH: return "Flash";
+        case DETECTION_STAGE_LORA: return "LoRa";
+        default: return "Unknown";
+    }
+}
+
+uint8_t detection_string_to_class(const char* class_name) {
+    if (!class_name) {
+        return CLASS_UNKNOWN;
+    }
+
+    for (uint8_t i = 0; i < object_class_count; i++) {
+        if (itemList[i].objectName && strcasecmp(class_name, itemList[i].objectName) == 0) {
+            return itemList[i].index;
+        }
+    }
+    return CLASS_UNKNOWN;
+}
+
+// ===== OBJECT CLASS HELPERS =====
+bool detection_is_object_filtered(int obj_type) {
+    if (obj_type < 0 || obj_type >= object_class_count || !itemList[obj_type].objectName) {
+        return true;
+    }
+    return itemList[obj_type].filter == 0;
+}
+
+const char* detection_get_object_name(int obj_type) {
+    if (obj_type < 0 || obj_type >= object_class_count || !itemList[obj_type].objectName) {
+        return "unknown";
+    }
+    return itemList[obj_type].objectName;
+}
+
+int detection_get_object_count() {
+    return object_class_count;
+}
+
+// ===== DETECTION CONVERSION HELPERS =====
+detection_result_code_t detection_convert_frame_result(const detection_frame_t& frame, uint8_t index, detection_result_t* our_result) {
+    if (!our_result || index >= frame.result_count) {
+        return DETECTION_ERROR_NO_RESULTS;
+    }
+
+    int obj_type = frame.object_type[index];
+    our_result->timestamp = frame.timestamp;
+    our_result->object_class = (obj_type >= 0 && obj_type < DETECTION_CLASS_COUNT) ? obj_type : CLASS_UNKNOWN;
+    our_result->confidence = frame.confidence[index];
+    our_result->x_min = frame.box[index].x_min;
+    our_result->y_min = frame.box[index].y_min;
+    our_result->x_max = frame.box[index].x_max;
+    our_result->y_max = frame.box[index].y_max;
+    our_result->valid = 1;
+    return DETECTION_SUCCESS;
+}
+
+void detection_scale_coordinates(detection_result_t* result, uint16_t img_width, uint16_t img_height) {
+    if (!result) {
+        return;
+    }
+
+    result->x_min *= img_width;
+    result->x_max *= img_width;
+    result->y_min *= img_height;
+    result->y_max *= img_height;
+}
@@ -3,8 +3,8 @@
 #define DETECTION_MANAGER_H
 
 #include "config.h"
-#include "NNObjectDetection.h"
-#include <vector>
+#include "detection_queue.h"
+#include "object_tracker.h"
 
 // Don't include ObjectClassList.h here to avoid multiple definitions
 // Use helper functions instead of direct itemList access
@@ -19,27 +19,57 @@ typedef enum {
     DETECTION_ERROR_NO_RESULTS
 } detection_result_code_t;
 
+// ===== PIPELINE STAGES =====
+// Cost of each stage is accumulated separately so a trace replay (or the
+// 'detection' command on target) shows where a frame's time goes
+typedef enum {
+    DETECTION_STAGE_FILTER = 0,     // Post-filter and ROI
+    DETECTION_STAGE_TRACKER,
+    DETECTION_STAGE_COUNTER,        // Global and per-zone counters, triggers
+    DETECTION_STAGE_FLASH,
+    DETECTION_STAGE_LORA,
+    DETECTION_STAGE_COUNT
+} detection_stage_t;
+
+// ===== PER-CLASS CONFIDENCE STATISTICS =====
+typedef struct {
+    uint32_t count;
+    float min_confidence;
+    float max_confidence;
+    float sum_confidence;           // avg = sum / count
+} detection_class_stats_t;
+
 // ===== DETECTION STATISTICS =====
 typedef struct {
     uint32_t total_frames_processed;
+    uint32_t total_results_seen;    // Raw NN results in processed frames
     uint32_t total_detections_found;
     uint32_t led_on_detections;
     uint32_t motherboard_detections;
-    uint32_t false_detections;
+    uint32_t false_detections;      // Results rejected by the post-filter
+    uint32_t roi_rejected;          // Results outside every ROI zone
     uint32_t processing_errors;
     
-    float avg_confidence_led;
-    float avg_confidence_motherboard;
-    float max_confidence_led;
-    float max_confidence_motherboard;
+    detection_class_stats_t class_stats[DETECTION_CLASS_COUNT];
     
     uint32_t last_detection_time;
-    uint32_t detection_processing_time_ms;
+    uint32_t detection_processing_time_us;  // Last frame
     
     // Performance metrics
-    uint32_t avg_processing_time_ms;
-    uint32_t min_processing_time_ms;
-    uint32_t max_processing_time_ms;
+    uint32_t avg_processing_time_us;
+    uint32_t min_processing_time_us;
+    uint32_t max_processing_time_us;
+    uint64_t total_processing_time_us;
+    float frames_per_second;        // Drained frames over the last window
+    float avg_results_per_frame;
+    uint8_t max_results_per_frame;
+    uint32_t heap_allocations;      // Seen on the drain path (heap_probe)
+    uint64_t stage_time_us[DETECTION_STAGE_COUNT];
+    uint32_t stage_calls[DETECTION_STAGE_COUNT];
+    
+    // Frame rate window
+    uint32_t fps_window_start;
+    uint32_t fps_window_frames;
 } detection_stats_t;
 
 // ===== DETECTION EVENT CALLBACKS =====
@@ -56,11 +86,12 @@ typedef struct {
     detection_callback_t callback;
     
     uint32_t last_process_time;
-    uint32_t process_interval;
+    uint32_t process_interval;      // 0 = drain the queue every call
     
-    // Current detection results
-    std::vector<ObjectDetectionResult>* current_results;
+    // Current detection results (copy of the last drained frame)
+    detection_frame_t current_frame;
     uint8_t current_result_count;
+    float last_motherboard_confidence;
     
     // Filtering and thresholds
     float confidence_threshold;
@@ -81,9 +112,11 @@ detection_result_code_t detection_init_streaming();
 bool detection_is_initialized();
 
 // ===== DETECTION PROCESSING =====
-void detection_process();
-detection_result_code_t detection_process_frame();
-detection_result_code_t detection_analyze_results();
+detection_result_code_t detection_process();
+detection_result_code_t detection_process_frame(const detection_frame_t& frame);
+detection_result_code_t detection_analyze_results(const detection_frame_t& frame);
+void detection_handle_result(const detection_frame_t& frame, uint8_t index, uint8_t object_class);
+void detection_handle_track_end(const tracker_event_t& event);
 void detection_update_statistics(detection_result_t* result);
 
 // ===== DETECTION CONFIGURATION =====
@@ -114,6 +147,7 @@ void detection_print_network_info();
 // ===== DETECTION UTILITIES =====
 const char* detection_result_code_to_string(detection_result_code_t code);
 const char* detection_class_to_string(uint8_t class_id);
+const char* detection_stage_to_string(detection_stage_t stage);
 uint8_t detection_string_to_class(const char* class_name);
 
 // ===== OBJECT CLASS HELPERS =====
@@ -123,7 +157,7 @@ const char* detection_get_object_name(int obj_type);
 int detection_get_object_count();
 
 // ===== DETECTION CONVERSION HELPERS =====
-detection_result_code_t detection_convert_yolo_result(ObjectDetectionResult* yolo_result, detection_result_t* our_result);
+detection_result_code_t detection_convert_frame_result(const detection_frame_t& frame, uint8_t index, detection_result_t* our_result);
 void detection_scale_coordinates(detection_result_t* result, uint16_t img_width, uint16_t img_height);
 
 // ===== GLOBAL DETECTION MANAGER =====
@@ -138,10 +172,12 @@ extern detection_manager_t detection_manager;
 
 
 // ===== DETECTION CONSTANTS =====
-#define DETECTION_DEFAULT_INTERVAL      100     // 100ms between processing
+#define DETECTION_DEFAULT_INTERVAL      0       // Drain queued frames every loop
 #define DETECTION_MAX_RESULTS           10      // Maximum results to process
 #define DETECTION_CONFIDENCE_MIN        0.1f    // Minimum confidence to consider
 #define DETECTION_CONFIDENCE_MAX        1.0f    // Maximum confidence possible
+#define DETECTION_FPS_WINDOW_MS         1000    // Frame rate averaging window
+#define DETECTION_NN_TARGET_FPS         10      // configNN frame rate
 
 // ===== WIFI CONSTANTS =====
 #define WIFI_CONNECT_TIMEOUT           10000    // 10 seconds
@@ -0,0 +1,218 @@
+// detection_queue.cpp - Bounded NN Result Queue Implementation
+#include "detection_queue.h"
+
+// ===== GLOBAL VARIABLES =====
+static detection_frame_t queue_frames[DETECTION_QUEUE_DEPTH];
+static volatile uint32_t queue_head = 0;   // Written by producer only
+static volatile uint32_t queue_tail = 0;   // Written by consumer only
+static uint32_t next_sequence = 0;
+static detection_queue_stats_t queue_stats = {0};
+static detection_queue_stats_t queue_baseline = {0};   // Producer counts at the last reset
+static detection_sim_t detection_sim = {0};
+
+#define DETECTION_QUEUE_MASK (DETECTION_QUEUE_DEPTH - 1)
+
+// ===== QUEUE INITIALIZATION =====
+void detection_queue_init() {
+    queue_head = 0;
+    queue_tail = 0;
+    next_sequence = 0;
+    memset(&queue_stats, 0, sizeof(queue_stats));
+    memset(&queue_baseline, 0, sizeof(queue_baseline));
+    memset(&detection_sim, 0, sizeof(detection_sim));
+}
+
+// ===== PRODUCER SIDE =====
+detection_frame_t* detection_queue_reserve() {
+    uint32_t head = queue_head;
+
+    if (head - queue_tail >= DETECTION_QUEUE_DEPTH) {
+        // Consumer is behind by a full queue - drop the newest frame
+        queue_stats.frames_dropped++;
+        next_sequence++;
+        return NULL;
+    }
+
+    detection_frame_t* frame = &queue_frames[head & DETECTION_QUEUE_MASK];
+    frame->sequence = next_sequence++;
+    frame->timestamp = millis();
+    frame->result_count = 0;
+    frame->raw_result_count = 0;
+    return frame;
+}
+
+void detection_queue_commit() {
+    detection_frame_t* frame = &queue_frames[queue_head & DETECTION_QUEUE_MASK];
+    if (frame->raw_result_count > frame->result_count) {
+        queue_stats.results_truncated += frame->raw_result_count - frame->result_count;
+    }
+
+    // Frame contents must be visible before the consumer sees the new head
+    __sync_synchronize();
+    queue_head = queue_head + 1;
+    queue_stats.frames_pushed++;
+}
+
+// ===== CONSUMER SIDE =====
+detection_frame_t* detection_queue_peek() {
+    uint32_t tail = queue_tail;
+    uint8_t depth = (uint8_t)(queue_head - tail);
+    if (depth == 0) {
+        return NULL;
+    }
+
+    // Depth only grows between two peeks, so the consumer sees every peak
+    if (depth > queue_stats.high_water) {
+        queue_stats.high_water = depth;
+    }
+
+    __sync_synchronize();
+    return &queue_frames[tail & DETECTION_QUEUE_MASK];
+}
+
+void detection_queue_pop() {
+    uint32_t tail = queue_tail;
+    if (tail == queue_head) {
+        return;
+    }
+
+    detection_frame_t* frame = &queue_frames[tail & DETECTION_QUEUE_MASK];
+    queue_stats.last_latency_ms = millis() - frame->timestamp;
+    if (queue_stats.last_latency_ms > queue_stats.max_latency_ms) {
+        queue_stats.max_latency_ms = queue_stats.last_latency_ms;
+    }
+    queue_stats.frames_popped++;
+
+    __sync_synchronize();
+    queue_tail = tail + 1;
+}
+
+void detection_queue_discard() {
+    uint32_t head = queue_head;
+    queue_stats.frames_discarded += head - queue_tail;
+
+    __sync_synchronize();
+    queue_tail = head;
+}
+
+uint8_t detection_queue_depth() {
+    return (uint8_t)(queue_head - queue_tail);
+}
+
+// ===== QUEUE STATISTICS =====
+void detection_queue_get_stats(detection_queue_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+
+    *stats = queue_stats;
+    stats->frames_pushed -= queue_baseline.frames_pushed;
+    stats->frames_dropped -= queue_baseline.frames_dropped;
+    stats->results_truncated -= queue_baseline.results_truncated;
+    stats->depth = detection_queue_depth();
+}
+
+// Runs on the consumer side: the fields the NN callback counts are only read
+// into the baseline, never written, so a frame pushed meanwhile is not lost
+void detection_queue_reset_stats() {
+    queue_baseline.frames_pushed = queue_stats.frames_pushed;
+    queue_baseline.frames_dropped = queue_stats.frames_dropped;
+    queue_baseline.results_truncated = queue_stats.results_truncated;
+    queue_stats.frames_popped = 0;
+    queue_stats.frames_discarded = 0;
+    queue_stats.last_latency_ms = 0;
+    queue_stats.max_latency_ms = 0;
+    queue_stats.high_water = 0;
+}
+
+void detection_queue_print_stats() {
+    detection_queue_stats_t stats;
+    detection_queue_get_stats(&stats);
+
+    Serial.println("\n=== DETECTION QUEUE ===");
+    Serial.println("Frames Pushed: " + String(stats.frames_pushed));
+    Serial.println("Frames Drained: " + String(stats.frames_popped));
+    Serial.println("Frames Discarded: " + String(stats.frames_discarded) + " (detection off)");
+    Serial.println("Frames Dropped: " + String(stats.frames_dropped));
+    Serial.println("Results Truncated: " + String(stats.results_truncated));
+    Serial.println("Depth: " + String(stats.depth) + "/" + String(DETECTION_QUEUE_DEPTH) +
+                   " (high water " + String(stats.high_water) + ")");
+    Serial.println("Latency: " + String(stats.last_latency_ms) + "ms (max " + String(stats.max_latency_ms) + "ms)");
+    if (detection_sim.active) {
+        Serial.println("Simulated Source: " + String(detection_sim.fps) + " fps, " +
+                       String(detection_sim.frames_emitted) + " frames emitted");
+    } else {
+        Serial.println("Simulated Source: OFF");
+    }
+    Serial.println("=======================\n");
+}
+
+// ===== SIMULATED NN SOURCE =====
+bool detection_sim_start(uint16_t fps) {
+    if (fps < 1 || fps > DETECTION_SIM_MAX_FPS) {
+        ERROR_PRINT("Invalid simulated frame rate. Use 1-" + String(DETECTION_SIM_MAX_FPS) + " fps.");
+        return false;
+    }
+
+    detection_sim.active = true;
+    detection_sim.fps = fps;
+    detection_sim.start_time = millis();
+    detection_sim.frames_emitted = 0;
+
+    INFO_PRINT("Simulated NN source started at " + String(fps) + " fps");
+    return true;
+}
+
+void detection_sim_stop() {
+    if (detection_sim.active) {
+        INFO_PRINT("Simulated NN source stopped after " + String(detection_sim.frames_emitted) + " frames");
+    }
+    detection_sim.active = false;
+}
+
+bool detection_sim_is_active() {
+    return detection_sim.active;
+}
+
+void detection_sim_process() {
+    if (!detection_sim.active) {
+        return;
+    }
+
+    // Emit every frame that is due since start, so a stalled consumer shows
+    // up as dropped frames exactly like it would with the real NN task
+    uint32_t elapsed = millis() - detection_sim.start_time;
+    uint32_t frames_due = (uint32_t)(((uint64_t)elapsed * detection_sim.fps) / 1000);
+
+    while (detection_sim.frames_emitted < frames_due) {
+        uint32_t n = detection_sim.frames_emitted++;
+
+        detection_frame_t* frame = detection_queue_reserve();
+        if (!frame) {
+            continue;
+        }
+
+        // One motherboard sweeping across the frame, an LED every 10th frame
+        float x = (float)(n % 40) / 40.0f;
+        uint8_t i = frame->result_count++;
+        frame->object_type[i] = CLASS_MOTHERBOARD;
+        frame->confidence[i] = 0.9f;
+        frame->box[i].x_min = x * 0.75f;
+        frame->box[i].y_min = 0.3f;
+        frame->box[i].x_max = x * 0.75f + 0.25f;
+        frame->box[i].y_max = 0.7f;
+
+        if (n % 10 == 0) {
+            i = frame->result_count++;
+            frame->object_type[i] = CLASS_LED_ON;
+            frame->confidence[i] = 0.8f;
+            frame->box[i].x_min = 0.05f;
+            frame->box[i].y_min = 0.05f;
+            frame->box[i].x_max = 0.10f;
+            frame->box[i].y_max = 0.10f;
+        }
+
+        frame->raw_result_count = frame->result_count;
+        detection_queue_commit();
+    }
+}
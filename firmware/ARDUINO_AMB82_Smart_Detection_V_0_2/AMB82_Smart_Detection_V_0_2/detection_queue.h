@@ -0,0 +1,74 @@
+// detection_queue.h - Bounded NN Result Queue (result-ready delivery)
+#ifndef DETECTION_QUEUE_H
+#define DETECTION_QUEUE_H
+
+#include "config.h"
+
+// The NN task pushes one frame per finished inference, the main loop drains
+// every queued frame. Single producer / single consumer, no locks, no heap.
+
+// ===== DETECTION BOX =====
+typedef struct {
+    float x_min, y_min, x_max, y_max;   // Normalized 0.0-1.0
+} detection_box_t;
+
+// ===== QUEUED DETECTION FRAME =====
+// Struct-of-arrays, filled once per inference and handed to the pipeline by
+// reference. Nothing on the detection path copies or allocates per result.
+typedef struct {
+    uint32_t sequence;              // Frame number assigned by the producer
+    uint32_t timestamp;             // millis() when the inference finished
+    uint8_t result_count;           // Results stored in this frame
+    uint8_t raw_result_count;       // Results reported by the NN (may be more)
+    int16_t object_type[MAX_DETECTION_RESULTS];     // Raw model class index
+    float confidence[MAX_DETECTION_RESULTS];
+    detection_box_t box[MAX_DETECTION_RESULTS];
+} detection_frame_t;
+
+// ===== QUEUE STATISTICS =====
+// The producer counts pushed, dropped and truncated, the consumer the rest
+typedef struct {
+    uint32_t frames_pushed;
+    uint32_t frames_popped;
+    uint32_t frames_discarded;      // Released unprocessed while detection is off
+    uint32_t frames_dropped;        // Producer found the queue full
+    uint32_t results_truncated;     // Results beyond MAX_DETECTION_RESULTS
+    uint32_t last_latency_ms;       // Inference done -> frame drained
+    uint32_t max_latency_ms;
+    uint8_t depth;
+    uint8_t high_water;             // Deepest queue the consumer found
+} detection_queue_stats_t;
+
+// ===== SIMULATED NN SOURCE =====
+typedef struct {
+    bool active;
+    uint16_t fps;
+    uint32_t start_time;
+    uint32_t frames_emitted;
+} detection_sim_t;
+
+// ===== QUEUE OPERATIONS =====
+void detection_queue_init();
+detection_frame_t* detection_queue_reserve();   // Producer: NULL when full
+void detection_queue_commit();                  // Producer: publish reserved frame
+detection_frame_t* detection_queue_peek();      // Consumer: NULL when empty
+void detection_queue_pop();                     // Consumer: release peeked frame
+void detection_queue_discard();                 // Consumer: release every queued frame unprocessed
+uint8_t detection_queue_depth();
+void detection_queue_get_stats(detection_queue_stats_t* stats);
+void detection_queue_reset_stats();
+void detection_queue_print_stats();
+
+// ===== SIMULATED NN SOURCE =====
+// Emits synthetic frames at a fixed rate through the same queue so the drain
+// path can be exercised without the camera (on target or on a host build).
+bool detection_sim_start(uint16_t fps);
+void detection_sim_stop();
+bool detection_sim_is_active();
+void detection_sim_process();
+
+// ===== QUEUE CONSTANTS =====
+#define DETECTION_QUEUE_DEPTH          8        // Frames, must be a power of two
+#define DETECTION_SIM_MAX_FPS          60
+
+#endif // DETECTION_QUEUE_H
@@ -0,0 +1,129 @@
+// flash_wear.cpp - Flash Sector Wear Leveling Implementation
+#include "flash_wear.h"
+
+static_assert(FLASH_CONFIG_OFFSET % FLASH_SECTOR_SIZE == 0 && FLASH_CHECKPOINT_OFFSET % FLASH_SECTOR_SIZE == 0 &&
+              FLASH_LOG_OFFSET % FLASH_SECTOR_SIZE == 0,
+              "wear areas must start on a sector boundary");
+static_assert(FLASH_CHECKPOINT_OFFSET + FLASH_CHECKPOINT_SLOTS * FLASH_SECTOR_SIZE <= FLASH_LOG_OFFSET,
+              "checkpoint slots overlap the detection log");
+static_assert(FLASH_LOG_OFFSET + FLASH_LOG_SECTORS * FLASH_SECTOR_SIZE <= FLASH_APP_AREA_SIZE,
+              "detection log runs past the application flash area");
+
+// ===== GLOBAL VARIABLES =====
+static flash_wear_area_t* wear_areas[FLASH_WEAR_MAX_AREAS];
+static uint8_t wear_area_count = 0;
+
+// ===== WEAR OPERATIONS =====
+static uint32_t wear_sector_offset(const flash_wear_area_t* area, uint16_t sector) {
+    return area->offset + (uint32_t)sector * FLASH_SECTOR_SIZE;
+}
+
+void flash_wear_init(flash_wear_area_t* area, const char* name, uint32_t offset, uint16_t sectors) {
+    area->name = name;
+    area->offset = offset;
+    area->sectors = sectors;
+    area->erase_count_min = UINT32_MAX;
+    area->erase_count_max = 0;
+    area->boot_erases = 0;
+
+    for (uint16_t sector = 0; sector < sectors; sector++) {
+        uint32_t erase_count = 0;
+        if (FlashMemory.readWord(wear_sector_offset(area, sector)) == FLASH_WEAR_MAGIC) {
+            erase_count = FlashMemory.readWord(wear_sector_offset(area, sector) + 4);
+        }
+        area->erase_count_min = min(area->erase_count_min, erase_count);
+        area->erase_count_max = max(area->erase_count_max, erase_count);
+    }
+    area->erase_count_lost = area->erase_count_max;
+
+    bool registered = false;
+    for (uint8_t i = 0; i < wear_area_count; i++) {
+        registered |= wear_areas[i] == area;
+    }
+    if (!registered && wear_area_count < FLASH_WEAR_MAX_AREAS) {
+        wear_areas[wear_area_count++] = area;
+    }
+}
+
+bool flash_wear_read_header(const flash_wear_area_t* area, uint16_t sector, flash_sector_header_t* header) {
+    uint32_t* words = (uint32_t*)header;
+    for (uint32_t i = 0; i < sizeof(flash_sector_header_t) / 4; i++) {
+        words[i] = FlashMemory.readWord(wear_sector_offset(area, sector) + i * 4);
+    }
+    return header->magic == FLASH_WEAR_MAGIC;
+}
+
+void flash_wear_erase(flash_wear_area_t* area, uint16_t sector, uint32_t tag, uint32_t sequence) {
+    uint32_t offset = wear_sector_offset(area, sector);
+    uint32_t erase_count = area->erase_count_lost;
+    if (FlashMemory.readWord(offset) == FLASH_WEAR_MAGIC) {
+        erase_count = FlashMemory.readWord(offset + 4);
+    }
+    erase_count++;
+
+    FlashMemory.eraseSector(offset);
+    FlashMemory.writeWord(offset + 4, erase_count);
+    FlashMemory.writeWord(offset + 8, tag);
+    FlashMemory.writeWord(offset + 12, sequence);
+    FlashMemory.writeWord(offset, FLASH_WEAR_MAGIC);
+
+    area->boot_erases++;
+    area->erase_count_max = max(area->erase_count_max, erase_count);
+    if (erase_count - 1 == area->erase_count_min) {
+        // The minimum only moves once no sector is left at it
+        uint32_t lowest = UINT32_MAX;
+        for (uint16_t i = 0; i < area->sectors; i++) {
+            uint32_t count = 0;
+            if (FlashMemory.readWord(wear_sector_offset(area, i)) == FLASH_WEAR_MAGIC) {
+                count = FlashMemory.readWord(wear_sector_offset(area, i) + 4);
+            }
+            lowest = min(lowest, count);
+        }
+        area->erase_count_min = lowest;
+    }
+
+    DEBUG_PRINT(3, String(area->name) + " sector " + String(sector) + " erased, count " + String(erase_count));
+}
+
+uint32_t flash_wear_data_offset(const flash_wear_area_t* area, uint16_t sector) {
+    return wear_sector_offset(area, sector) + sizeof(flash_sector_header_t);
+}
+
+// ===== LIFETIME =====
+float flash_wear_lifetime_years(const flash_wear_area_t* area) {
+    uint32_t uptime_ms = millis();
+    if (area->boot_erases == 0 || uptime_ms == 0) {
+        return -1.0f;
+    }
+
+    float per_sector_per_day = (float)area->boot_erases / area->sectors * 86400000.0f / uptime_ms;
+    uint32_t remaining = FLASH_SECTOR_ENDURANCE > area->erase_count_max ? FLASH_SECTOR_ENDURANCE - area->erase_count_max : 0;
+    return remaining / per_sector_per_day / 365.0f;
+}
+
+float flash_wear_design_years(const flash_wear_area_t* area) {
+    if (area->design_erases_per_day <= 0.0f) {
+        return -1.0f;
+    }
+
+    uint32_t remaining = FLASH_SECTOR_ENDURANCE > area->erase_count_max ? FLASH_SECTOR_ENDURANCE - area->erase_count_max : 0;
+    return remaining / area->design_erases_per_day / 365.0f;
+}
+
+void flash_wear_print(const flash_wear_area_t* area) {
+    Serial.println(String(area->name) + " Wear: " + String(area->sectors) + " sectors at 0x" + String(area->offset, HEX) +
+                   ", erases " + String(area->erase_count_min) + "-" + String(area->erase_count_max) + " of " +
+                   String(FLASH_SECTOR_ENDURANCE) + ", " + String(area->boot_erases) + " since boot");
+
+    float lifetime = flash_wear_lifetime_years(area);
+    float design = flash_wear_design_years(area);
+    Serial.println("  Projected Lifetime: " + (lifetime < 0.0f ? String("no erases since boot") :
+                   String(lifetime, 1) + " years at the current rate") +
+                   (design < 0.0f ? String("") : ", " + String(design, 1) + " years at " + String(area->design_load)));
+}
+
+void flash_wear_print_all() {
+    for (uint8_t i = 0; i < wear_area_count; i++) {
+        flash_wear_print(wear_areas[i]);
+    }
+}
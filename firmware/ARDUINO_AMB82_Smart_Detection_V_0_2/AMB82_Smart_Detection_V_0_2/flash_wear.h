@@ -0,0 +1,56 @@
+// flash_wear.h - Flash Sector Wear Leveling
+#ifndef FLASH_WEAR_H
+#define FLASH_WEAR_H
+
+#include "config.h"
+#include <FlashMemory.h>
+
+// An area is a ring of FLASH_SECTOR_SIZE sectors that its owner (the
+// detection log, the counter checkpoints) fills in turn, so every sector sees
+// the same number of erases. Data is only programmed into erased words; a
+// sector is erased once per lap, right before it is reused.
+//
+// Each sector starts with a header carrying its erase count, so the counts
+// survive reboots. If a reset hits between erase and header, the sector
+// takes the highest count the area had at boot. The owner's tag and sequence number in the
+// header tell it which sectors hold its current layout and in which order.
+
+#define FLASH_WEAR_MAGIC        0x52414557      // "WEAR"
+#define FLASH_WEAR_MAX_AREAS    4
+
+// ===== SECTOR HEADER =====
+typedef struct {
+    uint32_t magic;                 // Written last
+    uint32_t erase_count;
+    uint32_t tag;                   // Owner's layout
+    uint32_t sequence;              // Owner's order, 0 = not in use
+} flash_sector_header_t;
+
+#define FLASH_SECTOR_DATA_SIZE  (FLASH_SECTOR_SIZE - sizeof(flash_sector_header_t))
+
+// ===== WEAR AREA =====
+typedef struct {
+    const char* name;
+    uint32_t offset;
+    uint16_t sectors;
+    uint32_t erase_count_min;
+    uint32_t erase_count_max;
+    uint32_t erase_count_lost;      // Taken by a sector whose header was lost
+    uint32_t boot_erases;           // For the erase rate
+    float design_erases_per_day;    // Per sector at design_load, set by the owner
+    const char* design_load;
+} flash_wear_area_t;
+
+// ===== WEAR OPERATIONS =====
+void flash_wear_init(flash_wear_area_t* area, const char* name, uint32_t offset, uint16_t sectors);
+bool flash_wear_read_header(const flash_wear_area_t* area, uint16_t sector, flash_sector_header_t* header);
+void flash_wear_erase(flash_wear_area_t* area, uint16_t sector, uint32_t tag, uint32_t sequence);
+uint32_t flash_wear_data_offset(const flash_wear_area_t* area, uint16_t sector);
+
+// ===== LIFETIME =====
+float flash_wear_lifetime_years(const flash_wear_area_t* area);   // At the rate since boot, < 0 = no erases yet
+float flash_wear_design_years(const flash_wear_area_t* area);     // At design_load
+void flash_wear_print(const flash_wear_area_t* area);
+void flash_wear_print_all();                                       // Every initialized area
+
+#endif // FLASH_WEAR_H
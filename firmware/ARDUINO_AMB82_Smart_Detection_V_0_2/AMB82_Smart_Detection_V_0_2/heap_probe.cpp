@@ -0,0 +1,106 @@
+// heap_probe.cpp - Heap Allocation Counter Implementation
+#include "heap_probe.h"
+#include <new>
+
+// ===== GLOBAL VARIABLES =====
+static volatile uint32_t probe_allocations = 0;
+static volatile uint32_t probe_frees = 0;
+static volatile uint32_t probe_bytes = 0;
+
+static inline void heap_probe_note_alloc(size_t size) {
+    probe_allocations = probe_allocations + 1;
+    probe_bytes = probe_bytes + size;
+}
+
+static inline void heap_probe_note_free(void* ptr) {
+    if (ptr) {
+        probe_frees = probe_frees + 1;
+    }
+}
+
+// ===== HEAP PROBE FUNCTIONS =====
+bool heap_probe_is_enabled() {
+    return HEAP_PROBE_ENABLED;
+}
+
+uint32_t heap_probe_allocation_count() {
+    return probe_allocations;
+}
+
+void heap_probe_get_stats(heap_probe_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+
+    stats->allocations = probe_allocations;
+    stats->frees = probe_frees;
+    stats->bytes_requested = probe_bytes;
+}
+
+#if HEAP_PROBE_ENABLED
+
+#ifdef HEAP_PROBE_WRAP_MALLOC
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+}
+#define HEAP_PROBE_RAW_MALLOC __real_malloc
+#else
+#define HEAP_PROBE_RAW_MALLOC malloc
+#endif
+
+// ===== OPERATOR NEW / DELETE =====
+void* operator new(size_t size) {
+    heap_probe_note_alloc(size);
+    void* ptr = HEAP_PROBE_RAW_MALLOC(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    heap_probe_note_free(ptr);
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+#ifdef HEAP_PROBE_WRAP_MALLOC
+
+// ===== MALLOC FAMILY (linker --wrap) =====
+extern "C" {
+void* __wrap_malloc(size_t size) {
+    heap_probe_note_alloc(size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    heap_probe_note_alloc(count * size);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    heap_probe_note_alloc(size);
+    return __real_realloc(ptr, size);
+}
+}
+
+#endif // HEAP_PROBE_WRAP_MALLOC
+
+#endif // HEAP_PROBE_ENABLED
@@ -0,0 +1,36 @@
+// heap_probe.h - Heap Allocation Counter
+#ifndef HEAP_PROBE_H
+#define HEAP_PROBE_H
+
+#include "config.h"
+
+// Counts heap allocations so the steady-state detection path can be shown to
+// be allocation free. Replacing the global operator new is only safe when the
+// core does not ship its own, so the probe is off on target unless requested
+// with -DHEAP_PROBE_ENABLED=1 and always on for host builds.
+//
+// Arduino String and C code allocate through malloc directly. To count those
+// too, link with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc and define
+// HEAP_PROBE_WRAP_MALLOC.
+
+#ifndef HEAP_PROBE_ENABLED
+#ifdef ARDUINO
+#define HEAP_PROBE_ENABLED 0
+#else
+#define HEAP_PROBE_ENABLED 1
+#endif
+#endif
+
+// ===== HEAP PROBE STATISTICS =====
+typedef struct {
+    uint32_t allocations;
+    uint32_t frees;
+    uint32_t bytes_requested;
+} heap_probe_stats_t;
+
+// ===== HEAP PROBE FUNCTIONS =====
+bool heap_probe_is_enabled();
+uint32_t heap_probe_allocation_count();
+void heap_probe_get_stats(heap_probe_stats_t* stats);
+
+#endif // HEAP_PROBE_H
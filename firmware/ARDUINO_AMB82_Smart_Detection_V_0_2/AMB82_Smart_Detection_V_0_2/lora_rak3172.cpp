@@ -2,6 +2,7 @@
 #include "lora_rak3172.h"
 #include "amb82_flash.h"
 #include "amb82_gpio.h"
+#include "state_checkpoint.h"
 
 // ===== GLOBAL VARIABLES =====
 lora_module_t lora_module = {
@@ -27,6 +28,30 @@ String string_to_hex(const char* str) {
     return hex;
 }
 
+// ===== UTILITY FUNCTION: Hex Encode Into Caller Buffer (no heap) =====
+size_t lora_hex_encode(const char* str, char* out, size_t out_size) {
+    static const char hex_digits[] = "0123456789ABCDEF";
+    size_t n = 0;
+
+    if (!out || out_size == 0) {
+        return 0;
+    }
+
+    for (int i = 0; str[i] != '\0' && n + 2 < out_size; i++) {
+        unsigned char c = (unsigned char)str[i];
+        out[n++] = hex_digits[c >> 4];
+        out[n++] = hex_digits[c & 0x0F];
+    }
+    out[n] = '\0';
+    return n;
+}
+
+// Counts go out as at most 5 digits so every message format has a fixed
+// worst case that fits LORA_MAX_MESSAGE_LENGTH.
+uint16_t lora_saturate_u16(uint32_t value) {
+    return value > UINT16_MAX ? UINT16_MAX : (uint16_t)value;
+}
+
 // ===== LORA INITIALIZATION - FIXED =====
 lora_result_t lora_init() {
     INFO_PRINT("Initializing LoRa RAK3172 module...");
@@ -151,28 +176,32 @@ lora_result_t lora_send_message(lora_message_type_t type, const char* payload) {
     lora_module.state = LORA_STATE_SENDING;
     
     // FIXED: Limit payload size more strictly
-    if (strlen(payload) > 20) {
+    if (strlen(payload) > LORA_MAX_MESSAGE_LENGTH) {
         ERROR_PRINT("LoRa payload too long: " + String(strlen(payload)) + " chars");
         lora_module.state = LORA_STATE_CONNECTED;
         return LORA_ERROR_SEND;
     }
     
     // Convert payload to hex format for RAK3172
-    String hex_payload = string_to_hex(payload);
+    char hex_payload[48];
+    size_t hex_length = lora_hex_encode(payload, hex_payload, sizeof(hex_payload));
     
     // Check hex payload size (40 hex characters = 20 bytes for safety)
-    if (hex_payload.length() > 40) {
-        ERROR_PRINT("LoRa hex payload too long: " + String(hex_payload.length()/2) + " bytes");
+    if (hex_length > 40) {
+        ERROR_PRINT("LoRa hex payload too long: " + String(hex_length/2) + " bytes");
         lora_module.state = LORA_STATE_CONNECTED;
         return LORA_ERROR_SEND;
     }
     
     // Format AT command
     char at_command[100];
-    snprintf(at_command, sizeof(at_command), "AT+SEND=2:%s", hex_payload.c_str());
+    snprintf(at_command, sizeof(at_command), "AT+SEND=2:%s", hex_payload);
     
-    INFO_PRINT("Sending LoRa message: " + String(payload));
-    DEBUG_PRINT(3, "Hex payload: " + hex_payload);
+    if (system_config.debug_level >= 2) {
+        Serial.print("[INFO] Sending LoRa message: ");
+        Serial.println(payload);
+    }
+    DEBUG_PRINT(3, "Hex payload: " + String(hex_payload));
     DEBUG_PRINT(3, "AT command: " + String(at_command));
     
     // FIXED: Shorter timeout for send commands
@@ -246,6 +275,25 @@ lora_result_t lora_send_alert(const char* alert_message) {
     return lora_send_message(LORA_MSG_ALERT, formatted_message);
 }
 
+// Sent by lora_process() on its next pass, so a message that follows another
+// one does not go out back to back.
+lora_result_t lora_queue_message(lora_message_type_t type, const char* payload) {
+    if (!payload || strlen(payload) > LORA_MAX_MESSAGE_LENGTH) {
+        return LORA_ERROR_SEND;
+    }
+    if (lora_module.pending_message.pending) {
+        return LORA_ERROR_BUFFER_FULL;
+    }
+
+    lora_module.pending_message.type = type;
+    lora_module.pending_message.timestamp = millis();
+    lora_module.pending_message.payload_length = strlen(payload);
+    strcpy(lora_module.pending_message.payload, payload);
+    lora_module.pending_message.retry_count = 0;
+    lora_module.pending_message.pending = true;
+    return LORA_SUCCESS;
+}
+
 // ===== LORA PROCESSING =====
 void lora_process() {
     // Handle received data
@@ -358,18 +406,19 @@ lora_result_t lora_send_at_command(const char* command, char* response, uint32_t
                         strcpy(response, lora_module.response_buffer);
                     }
                     
-                    // FIXED: More flexible response checking
-                    String resp = String(lora_module.response_buffer);
-                    resp.trim();
+                    // FIXED: More flexible response checking (in place, no String copy)
+                    const char* resp = lora_module.response_buffer;
+                    while (*resp == ' ' || *resp == '\t') {
+                        resp++;
+                    }
                     
-                    if (resp.equals("OK") || 
-                        resp.indexOf("OK") >= 0 ||
-                        resp.indexOf("+") == 0 ||  // Response that starts with +
-                        resp.indexOf("EVT:") >= 0) {
-                        DEBUG_PRINT(3, "LoRa Response: " + resp);
+                    if (strstr(resp, "OK") ||
+                        resp[0] == '+' ||  // Response that starts with +
+                        strstr(resp, "EVT:")) {
+                        DEBUG_PRINT(3, "LoRa Response: " + String(resp));
                         return LORA_SUCCESS;
-                    } else if (resp.indexOf("ERROR") >= 0 || resp.indexOf("FAIL") >= 0) {
-                        ERROR_PRINT("LoRa AT Error: " + resp);
+                    } else if (strstr(resp, "ERROR") || strstr(resp, "FAIL")) {
+                        ERROR_PRINT("LoRa AT Error: " + String(resp));
                         return LORA_ERROR_AT_COMMAND;
                     }
                     
@@ -577,6 +626,7 @@ void lora_execute_reset_command() {
     delay(2000);
     
     config_save_to_flash();
+    checkpoint_save();
     gpio_trigger_system_reset();
     
     delay(1000);
@@ -75,6 +75,7 @@ lora_result_t lora_send_detection_data(detection_result_t* result);
 lora_result_t lora_send_status_update();
 lora_result_t lora_send_heartbeat();
 lora_result_t lora_send_alert(const char* alert_message);
+lora_result_t lora_queue_message(lora_message_type_t type, const char* payload);
 
 // ===== LORA PROCESSING =====
 void lora_process();
@@ -105,12 +106,20 @@ lora_result_t lora_format_heartbeat_message(char* buffer, size_t buffer_size);
 
 // ===== UTILITY FUNCTIONS =====
 String string_to_hex(const char* str);
+size_t lora_hex_encode(const char* str, char* out, size_t out_size);
+uint16_t lora_saturate_u16(uint32_t value);
 
 // ===== GLOBAL LORA INSTANCE =====
 extern lora_module_t lora_module;
 
 // ===== LORA CONFIGURATION CONSTANTS =====
 #define LORA_MAX_PAYLOAD_SIZE       200
+#define LORA_MAX_MESSAGE_LENGTH     20      // Longest payload lora_send_message accepts
+
+// True when the worst case of a message format, spelled out as a string
+// literal, fits. millis()/1000 is at most 4294967, counts are sent through
+// lora_saturate_u16().
+#define LORA_MESSAGE_FITS(worst_case) (sizeof(worst_case) - 1 <= LORA_MAX_MESSAGE_LENGTH)
 #define LORA_AT_TIMEOUT             5000    // 5 seconds
 #define LORA_JOIN_TIMEOUT           30000   // 30 seconds
 #define LORA_SEND_TIMEOUT           10000   // 10 seconds
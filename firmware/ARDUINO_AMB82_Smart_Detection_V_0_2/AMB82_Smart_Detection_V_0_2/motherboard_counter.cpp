@@ -2,210 +2,316 @@
 #include "motherboard_counter.h"
 #include "lora_rak3172.h"
 
-// ===== GLOBAL MOTHERBOARD COUNTER =====
-motherboard_counter_t motherboard_counter = {0};
+// ===== PER-ZONE COUNTERS =====
+static class_counter_t<CLASS_MOTHERBOARD> zone_counters[ROI_MAX_ZONES];
 
 // ===== MOTHERBOARD COUNTER INITIALIZATION =====
 void motherboard_counter_init() {
-    INFO_PRINT("Initializing motherboard detection counter...");
-    
-    // Initialize counter structure
-    memset(motherboard_counter.detection_timestamps, 0, sizeof(motherboard_counter.detection_timestamps));
-    motherboard_counter.buffer_index = 0;
-    motherboard_counter.buffer_count = 0;
-    motherboard_counter.total_motherboard_detections = 0;
-    motherboard_counter.lora_triggers_sent = 0;
-    motherboard_counter.last_lora_trigger_time = 0;
-    
-    // Load settings from config
-    motherboard_counter.enabled = system_config.motherboard_count_enabled;
-    motherboard_counter.count_threshold = system_config.motherboard_count_threshold;
-    motherboard_counter.time_window_ms = system_config.motherboard_count_window_ms;
-    
-    INFO_PRINT("Motherboard counter initialized:");
-    INFO_PRINT("- Enabled: " + String(motherboard_counter.enabled ? "YES" : "NO"));
-    INFO_PRINT("- Threshold: " + String(motherboard_counter.count_threshold) + " detections");
-    INFO_PRINT("- Window: " + String(motherboard_counter.time_window_ms/1000) + " seconds");
+    class_counter_init();
+
+    for (uint8_t zone = 0; zone < ROI_MAX_ZONES; zone++) {
+        zone_counters[zone].clear();
+    }
+    motherboard_counter_zones_configure();
 }
 
 // ===== ADD MOTHERBOARD DETECTION =====
 void motherboard_counter_add_detection(uint32_t timestamp) {
-    if (!motherboard_counter.enabled) {
-        return;
-    }
-    
-    // Add timestamp to circular buffer
-    motherboard_counter.detection_timestamps[motherboard_counter.buffer_index] = timestamp;
-    motherboard_counter.buffer_index = (motherboard_counter.buffer_index + 1) % MOTHERBOARD_DETECTION_BUFFER_SIZE;
-    
-    // Update count (max is buffer size)
-    if (motherboard_counter.buffer_count < MOTHERBOARD_DETECTION_BUFFER_SIZE) {
-        motherboard_counter.buffer_count++;
-    }
-    
-    // Update total counter
-    motherboard_counter.total_motherboard_detections++;
-    
-    DEBUG_PRINT(3, "MB detection added: total=" + String(motherboard_counter.total_motherboard_detections) + 
-                   ", in_window=" + String(motherboard_counter_get_count_in_window()));
+    class_counter_add_detection(CLASS_MOTHERBOARD, timestamp);
 }
 
 // ===== CHECK IF TRIGGER THRESHOLD REACHED =====
-bool motherboard_counter_check_trigger() {
-    if (!motherboard_counter.enabled) {
-        return false;
-    }
-    
-    uint32_t current_count = motherboard_counter_get_count_in_window();
-    
-    // Check if we've reached the threshold
-    if (current_count >= motherboard_counter.count_threshold) {
-        
-        // Prevent rapid repeated triggers (minimum 30 seconds between triggers)
-        uint32_t current_time = millis();
-        if (current_time - motherboard_counter.last_lora_trigger_time > 30000) {
-            
-            motherboard_counter.last_lora_trigger_time = current_time;
-            motherboard_counter.lora_triggers_sent++;
-            
-            // Update config statistics
-            system_config.total_motherboard_count_triggers++;
-            system_config.last_motherboard_trigger_time = current_time;
-            
-            INFO_PRINT("🚨 MOTHERBOARD TRIGGER: " + String(current_count) + " detections in " + 
-                      String(motherboard_counter.time_window_ms/1000) + "s window");
-            
-            return true;
-        } else {
-            DEBUG_PRINT(3, "MB trigger suppressed (too soon since last trigger)");
-        }
-    }
-    
-    return false;
+class_trigger_event_t motherboard_counter_check_trigger() {
+    return class_counter_check_trigger(CLASS_MOTHERBOARD);
+}
+
+bool motherboard_counter_is_triggered() {
+    class_counter_stats_t stats;
+    class_counter_get_stats(CLASS_MOTHERBOARD, &stats);
+    return stats.state == CLASS_TRIGGER_TRIGGERED;
 }
 
 // ===== GET COUNT IN CURRENT TIME WINDOW =====
 uint32_t motherboard_counter_get_count_in_window() {
-    if (!motherboard_counter.enabled || motherboard_counter.buffer_count == 0) {
-        return 0;
-    }
-    
-    uint32_t current_time = millis();
-    uint32_t window_start = current_time - motherboard_counter.time_window_ms;
-    uint32_t count = 0;
-    
-    // Count detections within the time window
-    for (int i = 0; i < motherboard_counter.buffer_count; i++) {
-        uint32_t detection_time = motherboard_counter.detection_timestamps[i];
-        
-        // Handle timer overflow (rare but possible)
-        if (detection_time > current_time) {
-            continue;
-        }
-        
-        if (detection_time >= window_start) {
-            count++;
-        }
-    }
-    
-    return count;
+    return class_counter_get_count_in_window(CLASS_MOTHERBOARD);
+}
+
+float motherboard_counter_get_rate() {
+    return class_counter_get_rate(CLASS_MOTHERBOARD);
 }
 
 // ===== RESET MOTHERBOARD COUNTER =====
 void motherboard_counter_reset() {
     INFO_PRINT("Resetting motherboard detection counter...");
-    
-    memset(motherboard_counter.detection_timestamps, 0, sizeof(motherboard_counter.detection_timestamps));
-    motherboard_counter.buffer_index = 0;
-    motherboard_counter.buffer_count = 0;
-    motherboard_counter.total_motherboard_detections = 0;
-    motherboard_counter.lora_triggers_sent = 0;
-    motherboard_counter.last_lora_trigger_time = 0;
-    
-    // Reset config statistics
-    system_config.total_motherboard_count_triggers = 0;
-    system_config.last_motherboard_trigger_time = 0;
-    
+
+    class_counter_reset();
+    for (uint8_t zone = 0; zone < ROI_MAX_ZONES; zone++) {
+        zone_counters[zone].clear();
+    }
+
     INFO_PRINT("Motherboard counter reset complete");
 }
 
 // ===== PRINT MOTHERBOARD COUNTER STATISTICS =====
 void motherboard_counter_print_stats() {
+    class_counter_stats_t stats;
+    class_counter_get_stats(CLASS_MOTHERBOARD, &stats);
+    const class_counter_config_t* cfg = &system_config.class_counters[CLASS_MOTHERBOARD];
+
     Serial.println("\n=== MOTHERBOARD COUNTER STATS ===");
-    Serial.println("Enabled: " + String(motherboard_counter.enabled ? "YES" : "NO"));
-    Serial.println("Threshold: " + String(motherboard_counter.count_threshold) + " detections");
-    Serial.println("Time Window: " + String(motherboard_counter.time_window_ms/1000) + " seconds");
-    Serial.println("Total MB Detections: " + String(motherboard_counter.total_motherboard_detections));
-    Serial.println("Current Window Count: " + String(motherboard_counter_get_count_in_window()));
-    Serial.println("LoRa Triggers Sent: " + String(motherboard_counter.lora_triggers_sent));
-    
-    if (motherboard_counter.last_lora_trigger_time > 0) {
-        Serial.println("Last Trigger: " + String((millis() - motherboard_counter.last_lora_trigger_time)/1000) + "s ago");
+    Serial.println("Enabled: " + String(stats.enabled ? "YES" : "NO"));
+    Serial.println("Threshold: " + String(stats.count_threshold) + " detections");
+    Serial.println("Time Window: " + String(stats.window_ms/1000) + " seconds");
+    Serial.println("Total MB Detections: " + String(stats.total_detections));
+    Serial.println("Trigger Mode: " + String(class_counter_mode_to_string(stats.mode)) +
+                   (stats.mode == CLASS_COUNTER_MODE_EWMA ? " (level " + String(stats.trigger_level) + ")" : String("")));
+    Serial.println("Current Window Count: " + String(stats.count_in_window));
+    Serial.println("Rate (EWMA): " + String(stats.rate_per_s, 2) + "/s, " + String(stats.rate_per_s * 60.0f, 1) + "/min");
+    Serial.println("Clear Threshold: " + String(stats.clear_threshold) + " detections" +
+                   (cfg->clear_threshold ? String("") : String(" (auto)")));
+    Serial.println("Cooldown: " + String(stats.cooldown_ms/1000) + " seconds");
+    Serial.println("Trigger State: " + String(class_trigger_state_to_string(stats.state)));
+    Serial.println("LoRa Triggers Sent: " + String(stats.triggers_sent));
+
+    if (stats.triggers_sent > 0) {
+        Serial.println("Last Trigger: " + String((millis() - stats.last_trigger_time)/1000) + "s ago, peak " +
+                       String(stats.peak_count) + ", " + String(stats.trigger_duration_ms/1000) + "s" +
+                       (stats.state == CLASS_TRIGGER_TRIGGERED ? String(" so far") : String("")));
     } else {
         Serial.println("Last Trigger: Never");
     }
-    
-    Serial.println("Buffer Usage: " + String(motherboard_counter.buffer_count) + "/" + String(MOTHERBOARD_DETECTION_BUFFER_SIZE));
+
+    Serial.println("Resolution: " + String(stats.resolution_ms) + "ms (" +
+                   String(stats.slots) + "/" + String(CLASS_COUNTER_SLOTS) + " slots" +
+                   (cfg->resolution_ms ? String(")") : String(", auto)")));
+    motherboard_counter_print_zone_stats();
     Serial.println("==================================\n");
 }
 
 // ===== SEND MOTHERBOARD TRIGGER LORA MESSAGE =====
 void send_motherboard_trigger_lora() {
-    if (!lora_is_initialized()) {
-        return;
-    }
-    
-    uint32_t current_count = motherboard_counter_get_count_in_window();
-    
-    // Format: MT,<count>,<threshold>,<window_seconds>,<timestamp>
-    char message_buffer[200];
-    snprintf(message_buffer, sizeof(message_buffer),
-             "MT,%lu,%lu,%lu,%lu",
-             current_count, 
-             motherboard_counter.count_threshold,
-             motherboard_counter.time_window_ms/1000,
-             millis()/1000);
-    
-    lora_result_t result = lora_send_message(LORA_MSG_MOTHERBOARD_TRIGGER, message_buffer);
-    
-    if (result == LORA_SUCCESS) {
-        INFO_PRINT("[LoRa] Motherboard trigger sent: " + String(message_buffer));
-    } else {
-        ERROR_PRINT("[LoRa] Motherboard trigger failed: " + String(lora_result_to_string(result)));
-    }
+    send_class_trigger_lora(CLASS_MOTHERBOARD);
 }
 
 // ===== MOTHERBOARD COUNTER CONFIGURATION FUNCTIONS =====
 bool motherboard_counter_set_enabled(bool enabled) {
-    motherboard_counter.enabled = enabled;
-    system_config.motherboard_count_enabled = enabled;
-    
-    INFO_PRINT("Motherboard counter " + String(enabled ? "enabled" : "disabled"));
+    if (!class_counter_set_enabled(CLASS_MOTHERBOARD, enabled)) {
+        return false;
+    }
+    motherboard_counter_zones_configure();
     return true;
 }
 
 bool motherboard_counter_set_threshold(uint32_t threshold) {
-    if (threshold < 1 || threshold > 1000) {
-        ERROR_PRINT("Invalid threshold range. Use 1-1000.");
+    if (threshold < 1) {
+        ERROR_PRINT("Invalid threshold range. Use 1-" + String(CLASS_COUNTER_MAX_THRESHOLD) + ".");
         return false;
     }
-    
-    motherboard_counter.count_threshold = threshold;
-    system_config.motherboard_count_threshold = threshold;
-    
-    INFO_PRINT("Motherboard counter threshold set to " + String(threshold));
-    return true;
+    return class_counter_set_threshold(CLASS_MOTHERBOARD, threshold);
 }
 
 bool motherboard_counter_set_window(uint32_t window_seconds) {
-    if (window_seconds < 1 || window_seconds > 300) {
-        ERROR_PRINT("Invalid window range. Use 1-300 seconds.");
+    if (!class_counter_set_window(CLASS_MOTHERBOARD, window_seconds)) {
+        return false;
+    }
+    motherboard_counter_zones_configure();
+    return true;
+}
+
+bool motherboard_counter_set_resolution(uint32_t resolution_ms) {
+    if (!class_counter_set_resolution(CLASS_MOTHERBOARD, resolution_ms)) {
+        return false;
+    }
+    motherboard_counter_zones_configure();
+    return true;
+}
+
+bool motherboard_counter_set_mode(uint8_t mode) {
+    if (!class_counter_set_mode(CLASS_MOTHERBOARD, mode)) {
         return false;
     }
-    
-    motherboard_counter.time_window_ms = window_seconds * 1000;
-    system_config.motherboard_count_window_ms = window_seconds * 1000;
-    
-    INFO_PRINT("Motherboard counter window set to " + String(window_seconds) + " seconds");
+    motherboard_counter_zones_configure();
     return true;
-}
\ No newline at end of file
+}
+
+bool motherboard_counter_set_clear_threshold(uint32_t threshold) {
+    return class_counter_set_clear_threshold(CLASS_MOTHERBOARD, threshold);
+}
+
+bool motherboard_counter_set_cooldown(uint32_t cooldown_seconds) {
+    if (!class_counter_set_cooldown(CLASS_MOTHERBOARD, cooldown_seconds)) {
+        return false;
+    }
+    motherboard_counter_zones_configure();
+    return true;
+}
+
+uint32_t motherboard_counter_get_resolution() {
+    class_counter_stats_t stats;
+    class_counter_get_stats(CLASS_MOTHERBOARD, &stats);
+    return stats.resolution_ms;
+}
+
+// ===== PER-ZONE COUNTERS =====
+void motherboard_counter_zones_configure() {
+    const class_counter_config_t* mb = &system_config.class_counters[CLASS_MOTHERBOARD];
+
+    for (uint8_t zone = 0; zone < ROI_MAX_ZONES; zone++) {
+        const roi_zone_config_t* cfg = &system_config.roi_zones[zone];
+        class_counter_t<CLASS_MOTHERBOARD>* counter = &zone_counters[zone];
+
+        bool was_enabled = counter->enabled;
+        // Zones clear at half their own threshold
+        counter->configure(cfg->enabled && mb->enabled, mb->mode, cfg->count_threshold, (uint32_t)mb->window_s * 1000,
+                           mb->resolution_ms, 0, (uint32_t)mb->cooldown_s * 1000);
+
+        if (counter->enabled && !was_enabled) {
+            counter->clear();
+        }
+    }
+}
+
+void motherboard_counter_zone_add_detection(uint8_t zone, uint32_t timestamp) {
+    if (zone >= ROI_MAX_ZONES) {
+        return;
+    }
+
+    zone_counters[zone].add(timestamp);
+
+    DEBUG_PRINT(3, "MB detection added to zone " + String(zone) + ": in_window=" +
+                   String(zone_counters[zone].count()));
+}
+
+class_trigger_event_t motherboard_counter_zone_check_trigger(uint8_t zone) {
+    if (zone >= ROI_MAX_ZONES) {
+        return CLASS_TRIGGER_NONE;
+    }
+
+    uint32_t current_count = 0;
+    class_trigger_event_t event = zone_counters[zone].check_trigger(&current_count);
+
+    if (event == CLASS_TRIGGER_START) {
+        if (system_config.debug_level >= 2) {
+            Serial.print("[INFO] 🚨 ZONE ");
+            Serial.print(zone);
+            Serial.print(" TRIGGER: ");
+            Serial.print(current_count);
+            Serial.print(" detections in ");
+            Serial.print(zone_counters[zone].wheel.window_ms/1000);
+            Serial.println("s window");
+        }
+    } else if (event == CLASS_TRIGGER_END) {
+        if (system_config.debug_level >= 2) {
+            Serial.print("[INFO] ✅ ZONE ");
+            Serial.print(zone);
+            Serial.print(" TRIGGER ENDED: peak ");
+            Serial.print(zone_counters[zone].peak_count);
+            Serial.print(" after ");
+            Serial.print(zone_counters[zone].last_duration_ms/1000);
+            Serial.println("s");
+        }
+    }
+    return event;
+}
+
+void motherboard_counter_zones_process() {
+    for (uint8_t zone = 0; zone < ROI_MAX_ZONES; zone++) {
+        if (zone_counters[zone].triggered() &&
+            motherboard_counter_zone_check_trigger(zone) == CLASS_TRIGGER_END) {
+            send_zone_trigger_end_lora(zone);
+        }
+    }
+}
+
+uint32_t motherboard_counter_zone_get_count_in_window(uint8_t zone) {
+    if (zone >= ROI_MAX_ZONES) {
+        return 0;
+    }
+    return zone_counters[zone].count();
+}
+
+void motherboard_counter_print_zone_stats() {
+    for (uint8_t zone = 0; zone < ROI_MAX_ZONES; zone++) {
+        class_counter_t<CLASS_MOTHERBOARD>* counter = &zone_counters[zone];
+        if (!system_config.roi_zones[zone].enabled) {
+            continue;
+        }
+        Serial.println("Zone " + String(zone) + ": " + String(counter->total_detections) + " total, " +
+                       String(counter->count()) + " in window" +
+                       (counter->count_threshold ? ", trigger at " + String(counter->count_threshold) : String(", count only")) +
+                       ", " + String(class_trigger_state_to_string(counter->state)) +
+                       ", " + String(counter->triggers_sent) + " triggers");
+    }
+}
+
+// ===== CHECKPOINT =====
+void motherboard_counter_checkpoint_save(checkpoint_write_t write, uint32_t now) {
+    for (uint8_t zone = 0; zone < ROI_MAX_ZONES; zone++) {
+        class_counter_t<CLASS_MOTHERBOARD> snapshot = zone_counters[zone];
+        snapshot.rebase(now, 0);
+        write(&snapshot, sizeof(snapshot));
+    }
+}
+
+bool motherboard_counter_checkpoint_restore(checkpoint_read_t read) {
+    for (uint8_t zone = 0; zone < ROI_MAX_ZONES; zone++) {
+        class_counter_t<CLASS_MOTHERBOARD> snapshot = zone_counters[zone];
+        if (!read(&snapshot, sizeof(snapshot))) {
+            return false;
+        }
+        zone_counters[zone] = snapshot;
+    }
+    motherboard_counter_zones_configure();
+    return true;
+}
+
+void send_zone_trigger_lora(uint8_t zone) {
+    if (!lora_is_initialized() || zone >= ROI_MAX_ZONES) {
+        return;
+    }
+
+    // Format: ZT,<zone>,<count>
+    static_assert(LORA_MESSAGE_FITS("ZT,255,65535"), "ZT uplink exceeds the LoRa payload limit");
+    char message_buffer[LORA_MAX_PAYLOAD_SIZE];
+    snprintf(message_buffer, sizeof(message_buffer),
+             "ZT,%u,%u",
+             (unsigned)zone,
+             (unsigned)lora_saturate_u16(motherboard_counter_zone_get_count_in_window(zone)));
+
+    lora_result_t result = lora_send_message(LORA_MSG_MOTHERBOARD_TRIGGER, message_buffer);
+
+    if (result == LORA_SUCCESS) {
+        if (system_config.debug_level >= 2) {
+            Serial.print("[INFO] [LoRa] Zone trigger sent: ");
+            Serial.println(message_buffer);
+        }
+    } else {
+        ERROR_PRINT("[LoRa] Zone trigger failed: " + String(lora_result_to_string(result)));
+    }
+}
+
+void send_zone_trigger_end_lora(uint8_t zone) {
+    if (!lora_is_initialized() || zone >= ROI_MAX_ZONES) {
+        return;
+    }
+
+    // Format: ZE,<zone>,<peak>,<duration_seconds>
+    static_assert(LORA_MESSAGE_FITS("ZE,255,65535,4294967"), "ZE uplink exceeds the LoRa payload limit");
+    char message_buffer[LORA_MAX_PAYLOAD_SIZE];
+    snprintf(message_buffer, sizeof(message_buffer),
+             "ZE,%u,%u,%lu",
+             (unsigned)zone,
+             (unsigned)lora_saturate_u16(zone_counters[zone].peak_count),
+             (unsigned long)(zone_counters[zone].last_duration_ms/1000));
+
+    lora_result_t result = lora_send_message(LORA_MSG_MOTHERBOARD_TRIGGER, message_buffer);
+
+    if (result == LORA_SUCCESS) {
+        if (system_config.debug_level >= 2) {
+            Serial.print("[INFO] [LoRa] Zone trigger end sent: ");
+            Serial.println(message_buffer);
+        }
+    } else {
+        ERROR_PRINT("[LoRa] Zone trigger end failed: " + String(lora_result_to_string(result)));
+    }
+}
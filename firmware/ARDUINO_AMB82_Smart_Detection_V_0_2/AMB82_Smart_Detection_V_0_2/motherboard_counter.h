@@ -3,15 +3,19 @@
 #define MOTHERBOARD_COUNTER_H
 
 #include "config.h"
+#include "class_counter.h"
 
-// ===== GLOBAL MOTHERBOARD COUNTER =====
-extern motherboard_counter_t motherboard_counter;
+// The motherboard counter is the CLASS_MOTHERBOARD entry of the per-class
+// counters (class_counter.h). This module keeps its historic API and adds
+// the motherboard-only pieces: per-ROI-zone counters and the MT uplink.
 
 // ===== MOTHERBOARD COUNTER FUNCTIONS =====
 void motherboard_counter_init();
 void motherboard_counter_add_detection(uint32_t timestamp);
-bool motherboard_counter_check_trigger();
+class_trigger_event_t motherboard_counter_check_trigger();
+bool motherboard_counter_is_triggered();            // Between trigger start and end
 uint32_t motherboard_counter_get_count_in_window();
+float motherboard_counter_get_rate();               // EWMA detections per second
 void motherboard_counter_reset();
 void motherboard_counter_print_stats();
 
@@ -19,8 +23,30 @@ void motherboard_counter_print_stats();
 bool motherboard_counter_set_enabled(bool enabled);
 bool motherboard_counter_set_threshold(uint32_t threshold);
 bool motherboard_counter_set_window(uint32_t window_seconds);
+bool motherboard_counter_set_resolution(uint32_t resolution_ms);    // 0 = auto
+bool motherboard_counter_set_mode(uint8_t mode);    // class_counter_mode_t
+bool motherboard_counter_set_clear_threshold(uint32_t threshold);   // 0 = auto
+bool motherboard_counter_set_cooldown(uint32_t cooldown_seconds);
+uint32_t motherboard_counter_get_resolution();      // Effective slot width
+
+// ===== PER-ZONE COUNTERS =====
+// One counter and trigger per ROI zone, sharing the motherboard window,
+// cooldown and trigger state machine
+void motherboard_counter_zones_configure();
+void motherboard_counter_zones_process();           // Main loop, ends zone triggers
+void motherboard_counter_zone_add_detection(uint8_t zone, uint32_t timestamp);
+class_trigger_event_t motherboard_counter_zone_check_trigger(uint8_t zone);
+uint32_t motherboard_counter_zone_get_count_in_window(uint8_t zone);
+void motherboard_counter_print_zone_stats();
+
+// ===== CHECKPOINT =====
+// Zone counters, same rules as class_counter_checkpoint_save/restore
+void motherboard_counter_checkpoint_save(checkpoint_write_t write, uint32_t now);
+bool motherboard_counter_checkpoint_restore(checkpoint_read_t read);
 
 // ===== LORA TRIGGER FUNCTIONS =====
 void send_motherboard_trigger_lora();
+void send_zone_trigger_lora(uint8_t zone);
+void send_zone_trigger_end_lora(uint8_t zone);      // ZE,<zone>,<peak>,<duration_s>
 
-#endif // MOTHERBOARD_COUNTER_H
\ No newline at end of file
+#endif // MOTHERBOARD_COUNTER_H
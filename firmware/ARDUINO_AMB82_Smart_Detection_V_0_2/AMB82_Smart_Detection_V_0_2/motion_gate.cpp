@@ -0,0 +1,234 @@
+// motion_gate.cpp - Motion-Gated Inference Implementation
+#include "motion_gate.h"
+#include "detection_manager.h"
+#include "nn_governor.h"
+
+// Host builds can force the DSP path against an emulated __usada8
+#ifndef MOTION_GATE_USE_DSP
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define MOTION_GATE_USE_DSP 1
+#else
+#define MOTION_GATE_USE_DSP 0
+#endif
+#endif
+
+#if MOTION_GATE_USE_DSP
+#include <arm_acle.h>
+#endif
+
+// ===== GLOBAL VARIABLES =====
+static uint8_t motion_thumbs[2][MOTION_THUMB_SIZE] __attribute__((aligned(4)));
+static uint8_t motion_current = 0;          // Thumbnail written next
+static bool motion_have_reference = false;
+static bool motion_open = true;
+static bool motion_initialized = false;
+static uint32_t motion_last_check = 0;
+static uint32_t motion_last_activity = 0;
+static motion_gate_stats_t motion_stats = {0};
+
+// External functions from main file
+extern bool motion_capture_frame(const uint8_t** data, uint32_t* length);
+extern bool motion_channel_set_running(bool running);
+
+// The motion channel only streams while the gate uses it. A channel that
+// won't start leaves the gate failing open, as with missing frames.
+static void motion_gate_channel(bool enabled) {
+    if (!motion_channel_set_running(enabled) && enabled) {
+        ERROR_PRINT("Motion channel did not start, inference stays on");
+    }
+}
+
+// ===== MOTION GATE KERNELS =====
+uint32_t motion_sad_u8(const uint8_t* a, const uint8_t* b, uint32_t len) {
+    uint32_t sad = 0;
+    uint32_t i = 0;
+
+#if MOTION_GATE_USE_DSP
+    // Four pixels per USADA8, unrolled by four words. Callers pass
+    // word-aligned buffers.
+    const uint32_t* wa = (const uint32_t*)a;
+    const uint32_t* wb = (const uint32_t*)b;
+    uint32_t words = len / 4;
+    uint32_t w = 0;
+    for (; w + 4 <= words; w += 4) {
+        sad = __usada8(wa[w], wb[w], sad);
+        sad = __usada8(wa[w + 1], wb[w + 1], sad);
+        sad = __usada8(wa[w + 2], wb[w + 2], sad);
+        sad = __usada8(wa[w + 3], wb[w + 3], sad);
+    }
+    for (; w < words; w++) {
+        sad = __usada8(wa[w], wb[w], sad);
+    }
+    i = words * 4;
+#endif
+
+    for (; i < len; i++) {
+        sad += (a[i] > b[i]) ? (a[i] - b[i]) : (b[i] - a[i]);
+    }
+    return sad;
+}
+
+void motion_downsample_luma(const uint8_t* luma, uint16_t width, uint16_t height, uint8_t* thumb) {
+    // Average four samples per block, at its quarter points
+    const uint16_t bw = width / MOTION_THUMB_W;
+    const uint16_t bh = height / MOTION_THUMB_H;
+
+    for (uint16_t ty = 0; ty < MOTION_THUMB_H; ty++) {
+        const uint8_t* row0 = luma + (uint32_t)(ty * bh + bh / 4) * width;
+        const uint8_t* row1 = row0 + (uint32_t)(bh / 2) * width;
+
+        for (uint16_t tx = 0; tx < MOTION_THUMB_W; tx++) {
+            uint32_t x0 = (uint32_t)tx * bw + bw / 4;
+            uint32_t x1 = x0 + bw / 2;
+            *thumb++ = (uint8_t)((row0[x0] + row0[x1] + row1[x0] + row1[x1]) >> 2);
+        }
+    }
+}
+
+// ===== MOTION GATE INITIALIZATION =====
+void motion_gate_init() {
+    motion_have_reference = false;
+    motion_open = true;
+    motion_last_check = 0;
+    motion_last_activity = millis();
+    motion_gate_reset_stats();
+    motion_gate_channel(system_config.motion_gate_enabled);
+    motion_initialized = true;
+
+    INFO_PRINT("Motion gate " + String(system_config.motion_gate_enabled ? "enabled" : "disabled") +
+               " (threshold " + String(system_config.motion_threshold) +
+               ", " + String(MOTION_GATE_USE_DSP ? "DSP" : "scalar") + " kernel)");
+}
+
+// ===== MOTION GATE PROCESSING =====
+void motion_gate_process() {
+    if (!motion_initialized || !system_config.motion_gate_enabled) {
+        return;
+    }
+
+    // One check per NN frame period
+    uint32_t now = millis();
+    if (now - motion_last_check < 1000 / DETECTION_NN_TARGET_FPS) {
+        return;
+    }
+    motion_last_check = now;
+
+    uint32_t start_us = micros();
+
+    // The Y plane leads an NV12 frame
+    const uint8_t* frame = NULL;
+    uint32_t length = 0;
+    if (!motion_capture_frame(&frame, &length) || !frame ||
+        length < (uint32_t)MOTION_CAPTURE_W * MOTION_CAPTURE_H) {
+        // Fail open: never starve the NN because the gate can't see, but say so
+        motion_stats.capture_failures++;
+        if (++motion_stats.failure_run == MOTION_GATE_FAILURE_REPORT) {
+            ERROR_PRINT("Motion gate gets no frames from the motion channel, inference stays on");
+        }
+        motion_have_reference = false;
+        motion_open = true;
+        nn_link_hold(NN_LINK_HOLD_MOTION, false);
+        return;
+    }
+    motion_stats.failure_run = 0;
+
+    uint8_t* thumb = motion_thumbs[motion_current];
+    motion_downsample_luma(frame, MOTION_CAPTURE_W, MOTION_CAPTURE_H, thumb);
+
+    bool motion = true;
+    if (motion_have_reference) {
+        uint32_t sad = motion_sad_u8(thumb, motion_thumbs[motion_current ^ 1], MOTION_THUMB_SIZE);
+        motion_stats.last_sad = sad;
+        motion = sad > (uint32_t)system_config.motion_threshold * MOTION_THUMB_SIZE;
+    }
+    motion_have_reference = true;
+    motion_current ^= 1;
+
+    uint32_t cost_us = micros() - start_us;
+    motion_stats.checks++;
+    motion_stats.last_cost_us = cost_us;
+    motion_stats.total_cost_us += cost_us;
+    if (cost_us > motion_stats.max_cost_us) {
+        motion_stats.max_cost_us = cost_us;
+    }
+
+    if (motion) {
+        motion_last_activity = now;
+        if (!motion_open) {
+            motion_open = true;
+            motion_stats.motion_events++;
+            DEBUG_PRINT(3, "Motion gate opened (SAD " + String(motion_stats.last_sad) + ")");
+        }
+    } else if (motion_open && now - motion_last_activity > MOTION_GATE_HOLD_MS) {
+        motion_open = false;
+        DEBUG_PRINT(3, "Motion gate closed");
+    }
+
+    if (!motion_open) {
+        motion_stats.checks_skipped++;
+    }
+    nn_link_hold(NN_LINK_HOLD_MOTION, !motion_open);
+}
+
+bool motion_gate_is_open() {
+    return !system_config.motion_gate_enabled || motion_open;
+}
+
+// ===== MOTION GATE CONFIGURATION =====
+bool motion_gate_set_enabled(bool enabled) {
+    system_config.motion_gate_enabled = enabled;
+    motion_have_reference = false;
+    motion_open = true;
+    motion_last_activity = millis();
+    nn_link_hold(NN_LINK_HOLD_MOTION, false);
+    motion_gate_channel(enabled);
+
+    INFO_PRINT("Motion gate " + String(enabled ? "enabled" : "disabled"));
+    return true;
+}
+
+bool motion_gate_set_threshold(uint8_t threshold) {
+    if (threshold < 1 || threshold > MOTION_GATE_MAX_THRESHOLD) {
+        ERROR_PRINT("Invalid motion threshold. Use 1-" + String(MOTION_GATE_MAX_THRESHOLD) + ".");
+        return false;
+    }
+
+    system_config.motion_threshold = threshold;
+    INFO_PRINT("Motion threshold set to " + String(threshold));
+    return true;
+}
+
+// ===== MOTION GATE STATISTICS =====
+void motion_gate_get_stats(motion_gate_stats_t* stats) {
+    if (stats) {
+        *stats = motion_stats;
+    }
+}
+
+void motion_gate_reset_stats() {
+    memset(&motion_stats, 0, sizeof(motion_stats));
+}
+
+void motion_gate_print_status() {
+    Serial.println("\n=== MOTION GATE ===");
+    Serial.println("Enabled: " + String(system_config.motion_gate_enabled ? "YES" : "NO") +
+                   " (" + String(MOTION_GATE_USE_DSP ? "DSP" : "scalar") + " kernel)");
+    Serial.println("State: " + String(motion_gate_is_open() ? "OPEN" : "CLOSED") +
+                   (motion_stats.failure_run >= MOTION_GATE_FAILURE_REPORT ? String(" (no frames, failing open)")
+                                                                          : String("")));
+    Serial.println("Threshold: " + String(system_config.motion_threshold) + " (mean abs diff, " +
+                   String(MOTION_THUMB_W) + "x" + String(MOTION_THUMB_H) + " thumbnail of a " +
+                   String(MOTION_CAPTURE_W) + "x" + String(MOTION_CAPTURE_H) + " channel)");
+    Serial.println("Last Diff: " + String((float)motion_stats.last_sad / MOTION_THUMB_SIZE, 2));
+    Serial.println("Checks: " + String(motion_stats.checks) + ", skipped " + String(motion_stats.checks_skipped) +
+                   " (" + String(motion_stats.checks ? motion_stats.checks_skipped * 100.0f / motion_stats.checks : 0.0f, 1) + "%)");
+    Serial.println("Motion Events: " + String(motion_stats.motion_events));
+    Serial.println("Capture Failures: " + String(motion_stats.capture_failures) + " (" +
+                   String(motion_stats.failure_run) + " in a row)");
+    if (motion_stats.checks > 0) {
+        Serial.println("Gate Cost: " + String(motion_stats.last_cost_us) + "us last, " +
+                       String((uint32_t)(motion_stats.total_cost_us / motion_stats.checks)) + "us avg, " +
+                       String(motion_stats.max_cost_us) + "us max");
+    }
+    Serial.println("===================\n");
+}
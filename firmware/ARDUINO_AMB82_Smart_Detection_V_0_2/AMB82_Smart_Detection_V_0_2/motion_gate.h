@@ -0,0 +1,63 @@
+// motion_gate.h - Motion-Gated Inference
+#ifndef MOTION_GATE_H
+#define MOTION_GATE_H
+
+#include "config.h"
+
+// Once per NN frame period the latest frame of the motion channel, a small
+// NV12 channel of its own (CHANNELMD), is reduced to a MOTION_THUMB_W x
+// MOTION_THUMB_H luminance thumbnail and compared with the previous one.
+// CHANNELNN is not read: its frames belong to the StreamIO link feeding ObjDet.
+// CHANNELMD itself only runs while the gate is enabled.
+// While the mean absolute difference stays below motion_threshold the NN link
+// is held paused, so static scenes cost no inference. Any motion reopens the
+// link for at least MOTION_GATE_HOLD_MS. Without frames the gate stays open
+// and reports it.
+
+// ===== MOTION GATE STATISTICS =====
+typedef struct {
+    uint32_t checks;                // Thumbnails compared (one per frame period)
+    uint32_t checks_skipped;        // Frame periods with the NN link held closed
+    uint32_t motion_events;         // Closed -> open transitions
+    uint32_t capture_failures;      // Frame not available or unexpected size
+    uint32_t failure_run;           // Consecutive capture failures
+    uint32_t last_sad;              // Sum of absolute differences, last check
+    uint32_t last_cost_us;          // Capture + downsample + diff
+    uint32_t max_cost_us;
+    uint64_t total_cost_us;
+} motion_gate_stats_t;
+
+// ===== MOTION GATE OPERATIONS =====
+void motion_gate_init();
+void motion_gate_process();         // Main loop
+bool motion_gate_is_open();
+
+// ===== MOTION GATE CONFIGURATION =====
+bool motion_gate_set_enabled(bool enabled);
+bool motion_gate_set_threshold(uint8_t threshold);
+
+// ===== MOTION GATE KERNELS =====
+// Sum of absolute differences over len bytes. Uses the Cortex-M33 DSP
+// extension (USADA8, four pixels per instruction) when available and a
+// portable scalar loop otherwise.
+uint32_t motion_sad_u8(const uint8_t* a, const uint8_t* b, uint32_t len);
+// Thumbnail from a luminance plane (NV12 Y), each pixel the mean of four
+// samples at the quarter points of its block, rounded down
+void motion_downsample_luma(const uint8_t* luma, uint16_t width, uint16_t height, uint8_t* thumb);
+
+// ===== MOTION GATE STATISTICS =====
+void motion_gate_get_stats(motion_gate_stats_t* stats);
+void motion_gate_reset_stats();
+void motion_gate_print_status();
+
+// ===== MOTION GATE CONSTANTS =====
+#define MOTION_CAPTURE_W               288      // Motion channel, NNWIDTH / 2
+#define MOTION_CAPTURE_H               160      // NNHEIGHT / 2
+#define MOTION_THUMB_W                 36       // MOTION_CAPTURE_W / 8
+#define MOTION_THUMB_H                 20       // MOTION_CAPTURE_H / 8
+#define MOTION_THUMB_SIZE              (MOTION_THUMB_W * MOTION_THUMB_H)
+#define MOTION_GATE_HOLD_MS            2000     // Keep inferring after motion
+#define MOTION_GATE_FAILURE_REPORT     10       // Consecutive capture failures before an error
+#define MOTION_GATE_MAX_THRESHOLD      64
+
+#endif // MOTION_GATE_H
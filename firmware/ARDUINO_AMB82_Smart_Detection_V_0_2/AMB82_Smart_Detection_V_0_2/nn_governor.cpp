@@ -0,0 +1,218 @@
+// nn_governor.cpp - Activity-Adaptive NN Frame Rate Governor Implementation
+#include "nn_governor.h"
+#include "detection_manager.h"
+
+// ===== GLOBAL VARIABLES =====
+static nn_governor_t nn_governor = {0};
+static uint8_t nn_link_holds = 0;
+
+// External functions from main file
+extern void nn_link_set_running(bool running);
+
+// ===== INTERNAL HELPERS =====
+static uint32_t nn_governor_sample_period() {
+    uint8_t fps = system_config.nn_idle_fps;
+    if (fps < 1) {
+        fps = 1;
+    }
+    return 1000 / fps;
+}
+
+static void nn_governor_set_link(bool running) {
+    nn_governor.link_running = running;
+    nn_link_hold(NN_LINK_HOLD_GOVERNOR, !running);
+}
+
+// ===== NN LINK ARBITRATION =====
+void nn_link_hold(uint8_t source, bool hold) {
+    uint8_t holds = hold ? (nn_link_holds | source) : (nn_link_holds & ~source);
+    if ((holds != 0) != (nn_link_holds != 0)) {
+        nn_link_set_running(holds == 0);
+    }
+    nn_link_holds = holds;
+}
+
+uint8_t nn_link_get_holds() {
+    return nn_link_holds;
+}
+
+static void nn_governor_switch_rate(nn_rate_t rate) {
+    if (rate == nn_governor.rate) {
+        return;
+    }
+
+    uint32_t now = millis();
+    nn_governor.time_in_rate_ms[nn_governor.rate] += now - nn_governor.rate_since;
+    nn_governor.rate_since = now;
+    nn_governor.rate = rate;
+    nn_governor.transitions++;
+    nn_governor.sample_open_time = 0;
+
+    if (rate == NN_RATE_FULL) {
+        nn_governor_set_link(true);
+        INFO_PRINT("NN governor: activity, back to " + String(DETECTION_NN_TARGET_FPS) + " fps");
+    } else {
+        nn_governor_set_link(false);
+        nn_governor.next_sample_time = now + nn_governor_sample_period();
+        INFO_PRINT("NN governor: idle for " + String(system_config.nn_idle_timeout_ms / 1000) +
+                   "s, dropping to " + String(system_config.nn_idle_fps) + " fps");
+    }
+}
+
+// ===== GOVERNOR INITIALIZATION =====
+void nn_governor_init() {
+    memset(&nn_governor, 0, sizeof(nn_governor));
+    nn_link_holds = 0;
+    nn_governor.rate = NN_RATE_FULL;
+    nn_governor.link_running = true;
+    nn_governor.last_activity_time = millis();
+    nn_governor.rate_since = nn_governor.last_activity_time;
+    nn_governor.initialized = true;
+
+    INFO_PRINT("NN governor " + String(system_config.nn_governor_enabled ? "enabled" : "disabled") +
+               " (idle " + String(system_config.nn_idle_fps) + " fps after " +
+               String(system_config.nn_idle_timeout_ms / 1000) + "s)");
+}
+
+// ===== GOVERNOR PROCESSING =====
+void nn_governor_process() {
+    if (!nn_governor.initialized || !system_config.nn_governor_enabled) {
+        return;
+    }
+
+    uint32_t now = millis();
+
+    if (nn_governor.rate == NN_RATE_FULL) {
+        if (now - nn_governor.last_activity_time >= system_config.nn_idle_timeout_ms) {
+            nn_governor_switch_rate(NN_RATE_IDLE);
+        }
+        return;
+    }
+
+    // Idle: open the link for one frame per sample period
+    if (nn_governor.sample_open_time == 0) {
+        if ((int32_t)(now - nn_governor.next_sample_time) >= 0) {
+            nn_governor.sample_open_time = now;
+            nn_governor.idle_samples++;
+            nn_governor_set_link(true);
+        }
+    } else if (now - nn_governor.sample_open_time > NN_GOVERNOR_SAMPLE_TIMEOUT) {
+        // No frame came through, try again next period
+        nn_governor_set_link(false);
+        nn_governor.sample_open_time = 0;
+        nn_governor.next_sample_time = now + nn_governor_sample_period();
+    }
+}
+
+void nn_governor_on_frame(bool activity) {
+    if (!nn_governor.initialized) {
+        return;
+    }
+
+    if (activity) {
+        nn_governor_notify_activity();
+        return;
+    }
+
+    if (nn_governor.rate == NN_RATE_IDLE && nn_governor.sample_open_time != 0) {
+        // Sampled frame was empty, close the link until the next period
+        nn_governor_set_link(false);
+        nn_governor.sample_open_time = 0;
+
+        uint32_t now = millis();
+        nn_governor.next_sample_time += nn_governor_sample_period();
+        if ((int32_t)(nn_governor.next_sample_time - now) < 0) {
+            nn_governor.next_sample_time = now + nn_governor_sample_period();
+        }
+    }
+}
+
+void nn_governor_notify_activity() {
+    nn_governor.last_activity_time = millis();
+    if (nn_governor.rate != NN_RATE_FULL) {
+        nn_governor_switch_rate(NN_RATE_FULL);
+    }
+}
+
+// ===== GOVERNOR CONFIGURATION =====
+bool nn_governor_set_enabled(bool enabled) {
+    system_config.nn_governor_enabled = enabled;
+    if (!enabled) {
+        nn_governor_switch_rate(NN_RATE_FULL);
+    }
+    nn_governor.last_activity_time = millis();
+
+    INFO_PRINT("NN governor " + String(enabled ? "enabled" : "disabled"));
+    return true;
+}
+
+bool nn_governor_set_idle_timeout(uint32_t timeout_seconds) {
+    if (timeout_seconds < NN_GOVERNOR_MIN_IDLE_TIMEOUT || timeout_seconds > NN_GOVERNOR_MAX_IDLE_TIMEOUT) {
+        ERROR_PRINT("Invalid idle timeout. Use " + String(NN_GOVERNOR_MIN_IDLE_TIMEOUT) + "-" +
+                    String(NN_GOVERNOR_MAX_IDLE_TIMEOUT) + " seconds.");
+        return false;
+    }
+
+    system_config.nn_idle_timeout_ms = timeout_seconds * 1000;
+    INFO_PRINT("NN idle timeout set to " + String(timeout_seconds) + " seconds");
+    return true;
+}
+
+bool nn_governor_set_idle_fps(uint8_t fps) {
+    if (fps < 1 || fps > NN_GOVERNOR_MAX_IDLE_FPS) {
+        ERROR_PRINT("Invalid idle frame rate. Use 1-" + String(NN_GOVERNOR_MAX_IDLE_FPS) + " fps.");
+        return false;
+    }
+
+    system_config.nn_idle_fps = fps;
+    INFO_PRINT("NN idle frame rate set to " + String(fps) + " fps");
+    return true;
+}
+
+// ===== GOVERNOR STATUS =====
+nn_rate_t nn_governor_get_rate() {
+    return nn_governor.rate;
+}
+
+uint8_t nn_governor_get_target_fps() {
+    return nn_governor.rate == NN_RATE_IDLE ? system_config.nn_idle_fps : DETECTION_NN_TARGET_FPS;
+}
+
+uint32_t nn_governor_get_time_in_rate(nn_rate_t rate) {
+    if (rate >= NN_RATE_COUNT) {
+        return 0;
+    }
+
+    uint32_t total = nn_governor.time_in_rate_ms[rate];
+    if (rate == nn_governor.rate) {
+        total += millis() - nn_governor.rate_since;
+    }
+    return total;
+}
+
+void nn_governor_print_status() {
+    uint32_t full_s = nn_governor_get_time_in_rate(NN_RATE_FULL) / 1000;
+    uint32_t idle_s = nn_governor_get_time_in_rate(NN_RATE_IDLE) / 1000;
+    uint32_t total_s = full_s + idle_s;
+
+    Serial.println("\n=== NN FRAME RATE GOVERNOR ===");
+    Serial.println("Enabled: " + String(system_config.nn_governor_enabled ? "YES" : "NO"));
+    Serial.println("Rate: " + String(nn_rate_to_string(nn_governor.rate)) + " (" +
+                   String(nn_governor_get_target_fps()) + " fps target, " +
+                   String(detection_manager.stats.frames_per_second, 1) + " fps measured)");
+    Serial.println("Idle After: " + String(system_config.nn_idle_timeout_ms / 1000) + "s at " +
+                   String(system_config.nn_idle_fps) + " fps");
+    Serial.println("Last Activity: " + String((millis() - nn_governor.last_activity_time) / 1000) + "s ago");
+    Serial.println("Time Full: " + String(full_s) + "s (" + String(total_s ? full_s * 100 / total_s : 100) + "%)");
+    Serial.println("Time Idle: " + String(idle_s) + "s (" + String(total_s ? idle_s * 100 / total_s : 0) + "%)");
+    Serial.println("Transitions: " + String(nn_governor.transitions) + ", idle samples: " + String(nn_governor.idle_samples));
+    Serial.println("==============================\n");
+}
+
+const char* nn_rate_to_string(nn_rate_t rate) {
+    switch (rate) {
+        case NN_RATE_FULL: return "FULL";
+        case NN_RATE_IDLE: return "IDLE";
+        default: return "UNKNOWN";
+    }
+}
@@ -0,0 +1,68 @@
+// nn_governor.h - Activity-Adaptive NN Frame Rate Governor
+#ifndef NN_GOVERNOR_H
+#define NN_GOVERNOR_H
+
+#include "config.h"
+
+// Drops inference to nn_idle_fps after nn_idle_timeout_ms without detections
+// and returns to the full configNN rate on the first frame with activity.
+// The camera channel keeps its configured rate; the idle rate is produced by
+// pausing the CHANNELNN -> ObjDet StreamIO link and letting a single frame
+// through every 1/nn_idle_fps seconds, so no init_neural_network_core()
+// re-run is needed to switch.
+
+// ===== NN LINK HOLDS =====
+// Each source can hold the StreamIO link paused; it runs when no hold is set
+#define NN_LINK_HOLD_GOVERNOR   0x01
+#define NN_LINK_HOLD_MOTION     0x02
+
+// ===== GOVERNOR RATES =====
+typedef enum {
+    NN_RATE_FULL = 0,
+    NN_RATE_IDLE,
+    NN_RATE_COUNT
+} nn_rate_t;
+
+// ===== GOVERNOR STATE =====
+typedef struct {
+    bool initialized;
+    nn_rate_t rate;
+    bool link_running;              // Governor wants the link passing frames
+    uint32_t last_activity_time;
+    uint32_t rate_since;            // millis() of the last rate change
+    uint32_t time_in_rate_ms[NN_RATE_COUNT];    // Closed periods only
+    uint32_t transitions;
+    uint32_t next_sample_time;      // Idle: when to let the next frame through
+    uint32_t sample_open_time;      // Idle: link resumed for a sample, 0 = closed
+    uint32_t idle_samples;
+} nn_governor_t;
+
+// ===== GOVERNOR OPERATIONS =====
+void nn_governor_init();
+void nn_governor_process();                 // Main loop, runs the idle schedule
+void nn_governor_on_frame(bool activity);   // Once per drained NN frame
+void nn_governor_notify_activity();         // Force full rate (commands, triggers)
+
+// ===== NN LINK ARBITRATION =====
+void nn_link_hold(uint8_t source, bool hold);
+uint8_t nn_link_get_holds();
+
+// ===== GOVERNOR CONFIGURATION =====
+bool nn_governor_set_enabled(bool enabled);
+bool nn_governor_set_idle_timeout(uint32_t timeout_seconds);
+bool nn_governor_set_idle_fps(uint8_t fps);
+
+// ===== GOVERNOR STATUS =====
+nn_rate_t nn_governor_get_rate();
+uint8_t nn_governor_get_target_fps();
+uint32_t nn_governor_get_time_in_rate(nn_rate_t rate);
+void nn_governor_print_status();
+const char* nn_rate_to_string(nn_rate_t rate);
+
+// ===== GOVERNOR CONSTANTS =====
+#define NN_GOVERNOR_MAX_IDLE_FPS        5
+#define NN_GOVERNOR_MIN_IDLE_TIMEOUT    10          // Seconds
+#define NN_GOVERNOR_MAX_IDLE_TIMEOUT    86400       // Seconds
+#define NN_GOVERNOR_SAMPLE_TIMEOUT      1000        // Close a sample that produced no frame
+
+#endif // NN_GOVERNOR_H
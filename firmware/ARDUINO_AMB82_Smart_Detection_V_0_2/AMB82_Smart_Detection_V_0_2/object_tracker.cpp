@@ -0,0 +1,277 @@
+// object_tracker.cpp - IoU Multi-Object Tracker Implementation
+#include "object_tracker.h"
+
+// ===== GLOBAL VARIABLES =====
+static tracker_track_t tracks[TRACKER_MAX_TRACKS];
+static tracker_stats_t tracker_stats = {0};
+static uint16_t next_track_id = 1;
+static bool tracker_enabled = true;
+
+// ===== TRACKER INITIALIZATION =====
+void tracker_init() {
+    tracker_reset();
+    tracker_enabled = true;
+    INFO_PRINT("Object tracker initialized (" + String(TRACKER_MAX_TRACKS) + " tracks)");
+}
+
+void tracker_reset() {
+    memset(tracks, 0, sizeof(tracks));
+    memset(&tracker_stats, 0, sizeof(tracker_stats));
+    next_track_id = 1;
+}
+
+void tracker_set_enabled(bool enable) {
+    if (enable != tracker_enabled) {
+        // Open tracks would never see their end event otherwise
+        memset(tracks, 0, sizeof(tracks));
+        tracker_stats.active_tracks = 0;
+    }
+    tracker_enabled = enable;
+    INFO_PRINT("Object tracker " + String(enable ? "enabled" : "disabled"));
+}
+
+bool tracker_is_enabled() {
+    return tracker_enabled;
+}
+
+// ===== MATCHING =====
+float tracker_iou(const detection_box_t& a, const detection_box_t& b) {
+    float ix = min(a.x_max, b.x_max) - max(a.x_min, b.x_min);
+    float iy = min(a.y_max, b.y_max) - max(a.y_min, b.y_min);
+    if (ix <= 0.0f || iy <= 0.0f) {
+        return 0.0f;
+    }
+
+    float inter = ix * iy;
+    float area_a = (a.x_max - a.x_min) * (a.y_max - a.y_min);
+    float area_b = (b.x_max - b.x_min) * (b.y_max - b.y_min);
+    float uni = area_a + area_b - inter;
+    return uni > 0.0f ? inter / uni : 0.0f;
+}
+
+// Match score between a track and a result. IoU matches always rank above
+// centroid matches; 0 means the pair may not be associated.
+static float tracker_match_score(const tracker_track_t& track, const detection_box_t& box) {
+    float iou = tracker_iou(track.box, box);
+    if (iou >= TRACKER_IOU_THRESHOLD) {
+        return iou;
+    }
+
+    float dx = (track.box.x_min + track.box.x_max - box.x_min - box.x_max) * 0.5f;
+    float dy = (track.box.y_min + track.box.y_max - box.y_min - box.y_max) * 0.5f;
+    float dist_sq = dx * dx + dy * dy;
+    const float max_sq = TRACKER_MAX_CENTROID_DISTANCE * TRACKER_MAX_CENTROID_DISTANCE;
+    if (dist_sq >= max_sq) {
+        return 0.0f;
+    }
+    return TRACKER_IOU_THRESHOLD * (1.0f - dist_sq / max_sq);
+}
+
+static void tracker_push_event(tracker_event_t* events, uint8_t max_events, uint8_t* event_count,
+                               track_event_type_t type, const tracker_track_t& track, uint8_t result_index) {
+    if (*event_count >= max_events) {
+        return;
+    }
+
+    tracker_event_t* ev = &events[(*event_count)++];
+    ev->type = type;
+    ev->track_id = track.id;
+    ev->object_class = track.object_class;
+    ev->result_index = result_index;
+    ev->confidence = (type == TRACK_EVENT_START) ? track.confidence : track.max_confidence;
+    ev->hits = track.hits;
+    ev->duration_ms = track.last_seen - track.first_seen;
+}
+
+static void tracker_confirm(tracker_track_t* track, uint8_t result_index,
+                            tracker_event_t* events, uint8_t max_events, uint8_t* event_count) {
+    track->confirmed = true;
+    tracker_stats.tracks_started++;
+    tracker_push_event(events, max_events, event_count, TRACK_EVENT_START, *track, result_index);
+}
+
+// ===== TRACKER UPDATE =====
+uint8_t tracker_update(const detection_frame_t& frame, const uint8_t* indices, const uint8_t* classes,
+                       uint8_t count, tracker_event_t* events, uint8_t max_events) {
+    uint8_t event_count = 0;
+    if (count > MAX_DETECTION_RESULTS) {
+        count = MAX_DETECTION_RESULTS;
+    }
+
+    if (!tracker_enabled) {
+        for (uint8_t j = 0; j < count && event_count < max_events; j++) {
+            tracker_event_t* ev = &events[event_count++];
+            memset(ev, 0, sizeof(*ev));
+            ev->type = TRACK_EVENT_START;
+            ev->object_class = classes[j];
+            ev->result_index = indices[j];
+            ev->confidence = frame.confidence[indices[j]];
+            ev->hits = 1;
+        }
+        return event_count;
+    }
+
+    // Score every (result, track) pair of the same class
+    float scores[MAX_DETECTION_RESULTS][TRACKER_MAX_TRACKS];
+    bool result_matched[MAX_DETECTION_RESULTS] = {false};
+    bool track_matched[TRACKER_MAX_TRACKS] = {false};
+
+    for (uint8_t j = 0; j < count; j++) {
+        const detection_box_t& box = frame.box[indices[j]];
+        for (uint8_t t = 0; t < TRACKER_MAX_TRACKS; t++) {
+            scores[j][t] = (tracks[t].active && tracks[t].object_class == classes[j])
+                           ? tracker_match_score(tracks[t], box) : 0.0f;
+        }
+    }
+
+    // Greedy assignment, best pair first
+    while (true) {
+        float best = 0.0f;
+        uint8_t best_j = 0;
+        uint8_t best_t = 0;
+        for (uint8_t j = 0; j < count; j++) {
+            if (result_matched[j]) {
+                continue;
+            }
+            for (uint8_t t = 0; t < TRACKER_MAX_TRACKS; t++) {
+                if (!track_matched[t] && scores[j][t] > best) {
+                    best = scores[j][t];
+                    best_j = j;
+                    best_t = t;
+                }
+            }
+        }
+        if (best <= 0.0f) {
+            break;
+        }
+
+        result_matched[best_j] = true;
+        track_matched[best_t] = true;
+        tracker_stats.results_matched++;
+
+        tracker_track_t* track = &tracks[best_t];
+        uint8_t index = indices[best_j];
+        track->box = frame.box[index];
+        track->confidence = frame.confidence[index];
+        if (track->confidence > track->max_confidence) {
+            track->max_confidence = track->confidence;
+        }
+        track->hits++;
+        track->missed_frames = 0;
+        track->last_seen = frame.timestamp;
+
+        if (!track->confirmed && track->hits >= TRACKER_MIN_HITS) {
+            tracker_confirm(track, index, events, max_events, &event_count);
+        }
+    }
+
+    // Age tracks that were not seen in this frame
+    for (uint8_t t = 0; t < TRACKER_MAX_TRACKS; t++) {
+        tracker_track_t* track = &tracks[t];
+        if (!track->active || track_matched[t]) {
+            continue;
+        }
+
+        if (++track->missed_frames > TRACKER_MAX_MISSED_FRAMES) {
+            if (track->confirmed) {
+                tracker_stats.tracks_ended++;
+                tracker_push_event(events, max_events, &event_count, TRACK_EVENT_END, *track, 0);
+            } else {
+                tracker_stats.tentative_dropped++;
+            }
+            track->active = false;
+        }
+    }
+
+    // Open a track for every result nobody claimed
+    for (uint8_t j = 0; j < count; j++) {
+        if (result_matched[j]) {
+            continue;
+        }
+
+        tracker_track_t* track = NULL;
+        for (uint8_t t = 0; t < TRACKER_MAX_TRACKS; t++) {
+            if (!tracks[t].active) {
+                track = &tracks[t];
+                break;
+            }
+        }
+        if (!track) {
+            tracker_stats.table_full++;
+            continue;
+        }
+
+        uint8_t index = indices[j];
+        memset(track, 0, sizeof(*track));
+        track->active = true;
+        track->id = next_track_id++;
+        if (next_track_id == 0) {
+            next_track_id = 1;
+        }
+        track->object_class = classes[j];
+        track->hits = 1;
+        track->confidence = frame.confidence[index];
+        track->max_confidence = track->confidence;
+        track->box = frame.box[index];
+        track->first_seen = frame.timestamp;
+        track->last_seen = frame.timestamp;
+
+        if (TRACKER_MIN_HITS <= 1) {
+            tracker_confirm(track, index, events, max_events, &event_count);
+        }
+    }
+
+    uint8_t active = tracker_get_active_count();
+    tracker_stats.active_tracks = active;
+    if (active > tracker_stats.max_active_tracks) {
+        tracker_stats.max_active_tracks = active;
+    }
+
+    return event_count;
+}
+
+// ===== TRACKER UTILITIES =====
+uint8_t tracker_get_active_count() {
+    uint8_t active = 0;
+    for (uint8_t t = 0; t < TRACKER_MAX_TRACKS; t++) {
+        if (tracks[t].active) {
+            active++;
+        }
+    }
+    return active;
+}
+
+void tracker_get_stats(tracker_stats_t* stats) {
+    if (stats) {
+        *stats = tracker_stats;
+    }
+}
+
+void tracker_print_status() {
+    Serial.println("\n=== OBJECT TRACKER ===");
+    Serial.println("Enabled: " + String(tracker_enabled ? "YES" : "NO"));
+    Serial.println("Match: IoU >= " + String(TRACKER_IOU_THRESHOLD, 2) +
+                   " or centroid < " + String(TRACKER_MAX_CENTROID_DISTANCE, 2));
+    Serial.println("Confirm/Expire: " + String(TRACKER_MIN_HITS) + " hits / " +
+                   String(TRACKER_MAX_MISSED_FRAMES) + " missed frames");
+    Serial.println("Tracks Started: " + String(tracker_stats.tracks_started));
+    Serial.println("Tracks Ended: " + String(tracker_stats.tracks_ended));
+    Serial.println("Tentative Dropped: " + String(tracker_stats.tentative_dropped));
+    Serial.println("Results Matched: " + String(tracker_stats.results_matched));
+    Serial.println("Table Full: " + String(tracker_stats.table_full));
+    Serial.println("Active: " + String(tracker_stats.active_tracks) + "/" + String(TRACKER_MAX_TRACKS) +
+                   " (max " + String(tracker_stats.max_active_tracks) + ")");
+
+    for (uint8_t t = 0; t < TRACKER_MAX_TRACKS; t++) {
+        const tracker_track_t& track = tracks[t];
+        if (!track.active) {
+            continue;
+        }
+        Serial.println("  #" + String(track.id) + " class " + String(track.object_class) +
+                       (track.confirmed ? "" : " (tentative)") +
+                       " hits=" + String(track.hits) + " missed=" + String(track.missed_frames) +
+                       " conf=" + String(track.confidence, 2) +
+                       " age=" + String(track.last_seen - track.first_seen) + "ms");
+    }
+    Serial.println("======================\n");
+}
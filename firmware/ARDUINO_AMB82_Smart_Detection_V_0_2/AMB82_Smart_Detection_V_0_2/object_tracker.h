@@ -0,0 +1,82 @@
+// object_tracker.h - IoU Multi-Object Tracker
+#ifndef OBJECT_TRACKER_H
+#define OBJECT_TRACKER_H
+
+#include "config.h"
+#include "detection_queue.h"
+
+// Associates boxes across frames so the pipeline reacts once per object
+// instead of once per frame. Only track-start and track-end events leave the
+// tracker. Fixed-size tables, no heap.
+
+// ===== TRACK EVENT TYPES =====
+typedef enum {
+    TRACK_EVENT_START = 0,
+    TRACK_EVENT_END
+} track_event_type_t;
+
+// ===== TRACK STATE =====
+typedef struct {
+    bool active;
+    bool confirmed;                 // Seen TRACKER_MIN_HITS times, start event sent
+    uint16_t id;
+    uint8_t object_class;
+    uint8_t missed_frames;          // Consecutive frames without a match
+    uint16_t hits;                  // Frames the track was matched in
+    float confidence;               // Last matched confidence
+    float max_confidence;
+    detection_box_t box;            // Last matched box
+    uint32_t first_seen;
+    uint32_t last_seen;
+} tracker_track_t;
+
+// ===== TRACK EVENT =====
+typedef struct {
+    track_event_type_t type;
+    uint16_t track_id;
+    uint8_t object_class;
+    uint8_t result_index;           // START: result in the frame that confirmed the track
+    float confidence;               // START: current, END: max over the track
+    uint16_t hits;
+    uint32_t duration_ms;           // END: first to last sighting
+} tracker_event_t;
+
+// ===== TRACKER STATISTICS =====
+typedef struct {
+    uint32_t tracks_started;
+    uint32_t tracks_ended;
+    uint32_t tentative_dropped;     // Tracks that never reached TRACKER_MIN_HITS
+    uint32_t results_matched;       // Results folded into an existing track
+    uint32_t table_full;            // Results ignored because no slot was free
+    uint8_t active_tracks;
+    uint8_t max_active_tracks;
+} tracker_stats_t;
+
+// ===== TRACKER OPERATIONS =====
+void tracker_init();
+void tracker_reset();
+void tracker_set_enabled(bool enable);
+bool tracker_is_enabled();
+
+// Feed one frame's accepted results (indices into the frame plus their class).
+// Must be called for every frame, including empty ones, so that tracks age.
+// Returns the number of events written. With the tracker disabled every
+// result is reported as a track start, which is the old per-frame behaviour.
+uint8_t tracker_update(const detection_frame_t& frame, const uint8_t* indices, const uint8_t* classes,
+                       uint8_t count, tracker_event_t* events, uint8_t max_events);
+
+// ===== TRACKER UTILITIES =====
+float tracker_iou(const detection_box_t& a, const detection_box_t& b);
+uint8_t tracker_get_active_count();
+void tracker_get_stats(tracker_stats_t* stats);
+void tracker_print_status();
+
+// ===== TRACKER CONSTANTS =====
+#define TRACKER_MAX_TRACKS             16
+#define TRACKER_MAX_EVENTS             (MAX_DETECTION_RESULTS + TRACKER_MAX_TRACKS)
+#define TRACKER_IOU_THRESHOLD          0.3f     // Box overlap to continue a track
+#define TRACKER_MAX_CENTROID_DISTANCE  0.1f     // Normalized, fallback when boxes don't overlap
+#define TRACKER_MIN_HITS               2        // Frames before a track is reported
+#define TRACKER_MAX_MISSED_FRAMES      5        // Frames before a lost track ends
+
+#endif // OBJECT_TRACKER_H
@@ -0,0 +1,182 @@
+// roi_zones.cpp - Region of Interest Zones Implementation
+#include "roi_zones.h"
+#include "detection_manager.h"
+#include "motherboard_counter.h"
+
+// ===== GLOBAL VARIABLES =====
+static uint8_t roi_grid[ROI_GRID_ROWS][ROI_GRID_COLS];    // Zone bitmask per cell
+static uint8_t roi_enabled_mask = 0;
+static roi_stats_t roi_stats = {0};
+
+// ===== ROI INITIALIZATION =====
+void roi_init() {
+    roi_rebuild();
+    roi_reset_stats();
+    INFO_PRINT("ROI zones initialized (" + String(roi_is_active() ? "active" : "whole frame") + ")");
+}
+
+// A cell belongs to the zone when its centre does. Returns the zone's cells,
+// marking them in roi_grid when mark is set.
+static uint16_t roi_rasterize(const roi_zone_config_t* cfg, uint8_t zone, bool mark) {
+    uint16_t cells = 0;
+    for (uint8_t r = 0; r < ROI_GRID_ROWS; r++) {
+        uint32_t cy = ((2 * r + 1) * NNHEIGHT) / (2 * ROI_GRID_ROWS);
+        if (cy < cfg->y_min || cy >= cfg->y_max) {
+            continue;
+        }
+        for (uint8_t c = 0; c < ROI_GRID_COLS; c++) {
+            uint32_t cx = ((2 * c + 1) * NNWIDTH) / (2 * ROI_GRID_COLS);
+            if (cx >= cfg->x_min && cx < cfg->x_max) {
+                cells++;
+                if (mark) {
+                    roi_grid[r][c] |= (1 << zone);
+                }
+            }
+        }
+    }
+    return cells;
+}
+
+void roi_rebuild() {
+    memset(roi_grid, 0, sizeof(roi_grid));
+    roi_enabled_mask = 0;
+
+    for (uint8_t zone = 0; zone < ROI_MAX_ZONES; zone++) {
+        const roi_zone_config_t* cfg = &system_config.roi_zones[zone];
+        if (!cfg->enabled) {
+            continue;
+        }
+
+        // An enabled zone without cells would reject every result
+        if (roi_rasterize(cfg, zone, true) == 0) {
+            ERROR_PRINT("ROI zone " + String(zone) + " covers no grid cell centre, ignored");
+            continue;
+        }
+        roi_enabled_mask |= (1 << zone);
+    }
+
+    motherboard_counter_zones_configure();
+}
+
+bool roi_is_active() {
+    return roi_enabled_mask != 0;
+}
+
+// ===== ZONE LOOKUP =====
+uint8_t roi_zone_mask(const detection_box_t& box) {
+    if (!roi_enabled_mask) {
+        return 0;
+    }
+
+    int col = (int)((box.x_min + box.x_max) * 0.5f * ROI_GRID_COLS);
+    int row = (int)((box.y_min + box.y_max) * 0.5f * ROI_GRID_ROWS);
+    col = constrain(col, 0, ROI_GRID_COLS - 1);
+    row = constrain(row, 0, ROI_GRID_ROWS - 1);
+    return roi_grid[row][col];
+}
+
+bool roi_accept(const detection_box_t& box) {
+    if (!roi_enabled_mask) {
+        return true;
+    }
+
+    uint8_t mask = roi_zone_mask(box);
+    if (!mask) {
+        roi_stats.results_outside++;
+        return false;
+    }
+
+    for (uint8_t zone = 0; zone < ROI_MAX_ZONES; zone++) {
+        if (mask & (1 << zone)) {
+            roi_stats.results_inside[zone]++;
+        }
+    }
+    return true;
+}
+
+// ===== ROI CONFIGURATION =====
+roi_result_t roi_set_zone(uint8_t zone, uint16_t x_min, uint16_t y_min, uint16_t x_max, uint16_t y_max,
+                          uint16_t count_threshold) {
+    if (zone >= ROI_MAX_ZONES) {
+        return ROI_ERROR_INVALID_ZONE;
+    }
+    if (x_min >= x_max || y_min >= y_max || x_max > NNWIDTH || y_max > NNHEIGHT) {
+        return ROI_ERROR_INVALID_RECT;
+    }
+
+    roi_zone_config_t candidate = system_config.roi_zones[zone];
+    candidate.enabled = 1;
+    candidate.x_min = x_min;
+    candidate.y_min = y_min;
+    candidate.x_max = x_max;
+    candidate.y_max = y_max;
+    candidate.count_threshold = count_threshold;
+    if (roi_rasterize(&candidate, zone, false) == 0) {
+        ERROR_PRINT("ROI zone must contain the centre of at least one " + String(NNWIDTH / ROI_GRID_COLS) + "x" +
+                    String(NNHEIGHT / ROI_GRID_ROWS) + " px grid cell");
+        return ROI_ERROR_INVALID_RECT;
+    }
+
+    system_config.roi_zones[zone] = candidate;
+    roi_rebuild();
+    INFO_PRINT("ROI zone " + String(zone) + " set to (" + String(x_min) + "," + String(y_min) + ")-(" +
+               String(x_max) + "," + String(y_max) + ")");
+    return ROI_SUCCESS;
+}
+
+roi_result_t roi_disable_zone(uint8_t zone) {
+    if (zone >= ROI_MAX_ZONES) {
+        return ROI_ERROR_INVALID_ZONE;
+    }
+
+    system_config.roi_zones[zone].enabled = 0;
+    roi_rebuild();
+    INFO_PRINT("ROI zone " + String(zone) + " disabled");
+    return ROI_SUCCESS;
+}
+
+// ===== ROI STATISTICS =====
+void roi_get_stats(roi_stats_t* stats) {
+    if (stats) {
+        *stats = roi_stats;
+    }
+}
+
+void roi_reset_stats() {
+    memset(&roi_stats, 0, sizeof(roi_stats));
+}
+
+void roi_print_status() {
+    Serial.println("\n=== ROI ZONES ===");
+    Serial.println("Frame: " + String(NNWIDTH) + "x" + String(NNHEIGHT) + ", grid " +
+                   String(ROI_GRID_COLS) + "x" + String(ROI_GRID_ROWS));
+    if (!roi_is_active()) {
+        Serial.println("No zones enabled - whole frame counts");
+    }
+
+    for (uint8_t zone = 0; zone < ROI_MAX_ZONES; zone++) {
+        const roi_zone_config_t* cfg = &system_config.roi_zones[zone];
+        if (!cfg->enabled) {
+            Serial.println("Zone " + String(zone) + ": OFF");
+            continue;
+        }
+        uint16_t cells = roi_rasterize(cfg, zone, false);
+        Serial.println("Zone " + String(zone) + ": (" + String(cfg->x_min) + "," + String(cfg->y_min) + ")-(" +
+                       String(cfg->x_max) + "," + String(cfg->y_max) + ") " +
+                       (cells ? String(cells) + " cells," : String("no cells, ignored,")) +
+                       " trigger " + (cfg->count_threshold ? String(cfg->count_threshold) : String("off")) +
+                       ", " + String(roi_stats.results_inside[zone]) + " results, " +
+                       String(motherboard_counter_zone_get_count_in_window(zone)) + " MB in window");
+    }
+    Serial.println("Outside All Zones: " + String(roi_stats.results_outside));
+    Serial.println("=================\n");
+}
+
+const char* roi_result_to_string(roi_result_t result) {
+    switch (result) {
+        case ROI_SUCCESS: return "SUCCESS";
+        case ROI_ERROR_INVALID_ZONE: return "INVALID_ZONE";
+        case ROI_ERROR_INVALID_RECT: return "INVALID_RECT";
+        default: return "UNKNOWN_ERROR";
+    }
+}
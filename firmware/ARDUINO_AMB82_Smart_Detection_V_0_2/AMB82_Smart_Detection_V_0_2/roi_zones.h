@@ -0,0 +1,49 @@
+// roi_zones.h - Region of Interest Zones
+#ifndef ROI_ZONES_H
+#define ROI_ZONES_H
+
+#include "config.h"
+#include "detection_queue.h"
+
+// Zones are rectangles in NN frame pixels, persisted in system_config.
+// They are rasterized into a ROI_GRID_COLS x ROI_GRID_ROWS grid holding one
+// zone bit per cell, so classifying a result is a single table lookup at the
+// box centre no matter how many zones are configured.
+
+// ===== ROI OPERATION RESULTS =====
+typedef enum {
+    ROI_SUCCESS = 0,
+    ROI_ERROR_INVALID_ZONE,
+    ROI_ERROR_INVALID_RECT
+} roi_result_t;
+
+// ===== ROI STATISTICS =====
+typedef struct {
+    uint32_t results_inside[ROI_MAX_ZONES];
+    uint32_t results_outside;       // Discarded, centre outside every zone
+} roi_stats_t;
+
+// ===== ROI OPERATIONS =====
+void roi_init();
+void roi_rebuild();                 // Re-rasterize after system_config changes
+bool roi_is_active();               // At least one zone enabled
+
+// Bit n set when the box centre lies in zone n. With no zone enabled the
+// whole frame counts and 0 is returned.
+uint8_t roi_zone_mask(const detection_box_t& box);
+
+// Returns false when zones are active and the box is outside all of them
+bool roi_accept(const detection_box_t& box);
+
+// ===== ROI CONFIGURATION =====
+roi_result_t roi_set_zone(uint8_t zone, uint16_t x_min, uint16_t y_min, uint16_t x_max, uint16_t y_max,
+                          uint16_t count_threshold);
+roi_result_t roi_disable_zone(uint8_t zone);
+
+// ===== ROI STATISTICS =====
+void roi_get_stats(roi_stats_t* stats);
+void roi_reset_stats();
+void roi_print_status();
+const char* roi_result_to_string(roi_result_t result);
+
+#endif // ROI_ZONES_H
@@ -4,6 +4,13 @@
 #include "lora_rak3172.h"
 #include "amb82_flash.h"
 #include "amb82_gpio.h"
+#include "detection_manager.h"
+#include "detection_filter.h"
+#include "roi_zones.h"
+#include "trigger_rules.h"
+#include "nn_governor.h"
+#include "motion_gate.h"
+#include "state_checkpoint.h"
 
 // Add WiFi include
 #include "WiFi.h"
@@ -112,6 +119,15 @@ command_result_t serial_commands_parse_input(const char* input, parsed_command_t
     return CMD_SUCCESS;
 }
 
+// Settings commands, autosaved CONFIG_AUTOSAVE_DELAY_MS after the last one;
+// a save that finds nothing changed programs nothing
+static command_result_t config_autosave_after(command_result_t result) {
+    if (result == CMD_SUCCESS) {
+        config_mark_dirty();
+    }
+    return result;
+}
+
 command_result_t serial_commands_execute(parsed_command_t* cmd) {
     if (!cmd) {
         return CMD_ERROR_INVALID_PARAMETER;
@@ -127,7 +143,7 @@ command_result_t serial_commands_execute(parsed_command_t* cmd) {
             Serial.println("Usage: set <parameter> <value>");
             return CMD_ERROR_MISSING_PARAMETER;
         }
-        return cmd_set_parameter(cmd->parameter, cmd->value);
+        return config_autosave_after(cmd_set_parameter(cmd->parameter, cmd->value));
     } else if (strcmp(cmd->command, CMD_GET) == 0) {
         if (!cmd->has_parameter) {
             Serial.println("Usage: get <parameter>");
@@ -143,6 +159,9 @@ command_result_t serial_commands_execute(parsed_command_t* cmd) {
     } else if (strcmp(cmd->command, CMD_REBOOT) == 0) {
         return cmd_reboot();
     } else if (strcmp(cmd->command, CMD_LOGS) == 0) {
+        if (cmd->has_parameter && cmd->has_value) {
+            return cmd_logs_range(cmd->parameter, cmd->value);
+        }
         const char* count = cmd->has_parameter ? cmd->parameter : "10";
         return cmd_logs(count);
     } else if (strcmp(cmd->command, CMD_CLEAR_LOGS) == 0) {
@@ -164,7 +183,19 @@ command_result_t serial_commands_execute(parsed_command_t* cmd) {
     } else if (strcmp(cmd->command, CMD_FLASH) == 0) {
         return cmd_flash_status();
     } else if (strcmp(cmd->command, CMD_DETECTION) == 0) {
-        return cmd_detection_stats();
+        return cmd_detection_stats(cmd->has_parameter ? cmd->parameter : NULL);
+    } else if (strcmp(cmd->command, "tracker") == 0) {
+        return cmd_tracker(cmd->has_parameter ? cmd->parameter : NULL);
+    } else if (strcmp(cmd->command, "roi") == 0) {
+        return config_autosave_after(cmd_roi(cmd->has_parameter ? cmd->parameter : NULL,
+                                             cmd->has_value ? cmd->value : NULL));
+    } else if (strcmp(cmd->command, "rule") == 0) {
+        return config_autosave_after(cmd_rule(cmd->has_parameter ? cmd->parameter : NULL,
+                                              cmd->has_value ? cmd->value : NULL));
+    } else if (strcmp(cmd->command, "motion") == 0) {
+        return cmd_motion(cmd->has_parameter ? cmd->parameter : NULL);
+    } else if (strcmp(cmd->command, "checkpoint") == 0) {
+        return cmd_checkpoint(cmd->has_parameter ? cmd->parameter : NULL);
     } else if (strcmp(cmd->command, "nn_status") == 0) {
         return cmd_nn_status();
     } else if (strcmp(cmd->command, "nn_reset") == 0) {
@@ -173,6 +204,12 @@ command_result_t serial_commands_execute(parsed_command_t* cmd) {
         return cmd_nn_restart();
     } else if (strcmp(cmd->command, "camera_reset") == 0) {
         return cmd_camera_reset();
+    } else if (strcmp(cmd->command, "nn_sim") == 0) {
+        if (!cmd->has_parameter) {
+            Serial.println("Usage: nn_sim <fps|0>");
+            return CMD_ERROR_MISSING_PARAMETER;
+        }
+        return cmd_nn_sim(cmd->parameter);
     }
     
     // WiFi/RTSP commands
@@ -193,6 +230,9 @@ command_result_t serial_commands_execute(parsed_command_t* cmd) {
         return cmd_motherboard_counter();
     } else if (strcmp(cmd->command, "mb_reset") == 0) {
         return cmd_motherboard_reset();
+    } else if (strcmp(cmd->command, "counter") == 0) {
+        return config_autosave_after(cmd_class_counter(cmd->has_parameter ? cmd->parameter : NULL,
+                                                       cmd->has_value ? cmd->value : NULL));
     }
     
     return CMD_ERROR_UNKNOWN_COMMAND;
@@ -240,6 +280,35 @@ command_result_t cmd_set_parameter(const char* parameter, const char* value) {
         return set_motherboard_count_threshold(value);
     } else if (strcmp(parameter, PARAM_MOTHERBOARD_COUNT_WINDOW) == 0) {
         return set_motherboard_count_window(value);
+    } else if (strcmp(parameter, PARAM_MOTHERBOARD_COUNT_RESOLUTION) == 0) {
+        return set_motherboard_count_resolution(value);
+    } else if (strcmp(parameter, PARAM_MOTHERBOARD_COUNT_CLEAR) == 0) {
+        return set_motherboard_count_clear(value);
+    } else if (strcmp(parameter, PARAM_MOTHERBOARD_COUNT_COOLDOWN) == 0) {
+        return set_motherboard_count_cooldown(value);
+    } else if (strcmp(parameter, PARAM_MOTHERBOARD_COUNT_MODE) == 0) {
+        return set_motherboard_count_mode(value);
+    }
+    // NN governor parameters
+    else if (strcmp(parameter, PARAM_NN_GOVERNOR_ENABLED) == 0) {
+        return set_nn_governor_enabled(value);
+    } else if (strcmp(parameter, PARAM_NN_IDLE_TIMEOUT) == 0) {
+        return set_nn_idle_timeout(value);
+    } else if (strcmp(parameter, PARAM_NN_IDLE_FPS) == 0) {
+        return set_nn_idle_fps(value);
+    }
+    // Motion gate parameters
+    else if (strcmp(parameter, PARAM_MOTION_GATE_ENABLED) == 0) {
+        return set_motion_gate_enabled(value);
+    } else if (strcmp(parameter, PARAM_MOTION_THRESHOLD) == 0) {
+        return set_motion_threshold(value);
+    }
+    // State checkpoint parameters
+    else if (strcmp(parameter, PARAM_CHECKPOINT_INTERVAL) == 0) {
+        return set_checkpoint_interval(value);
+    }
+    else if (strcmp(parameter, PARAM_LOG_EVENT_GAP) == 0) {
+        return set_log_event_gap(value);
     }
     
     return CMD_ERROR_INVALID_PARAMETER;
@@ -274,6 +343,35 @@ command_result_t cmd_get_parameter(const char* parameter) {
         return get_motherboard_count_threshold();
     } else if (strcmp(parameter, PARAM_MOTHERBOARD_COUNT_WINDOW) == 0) {
         return get_motherboard_count_window();
+    } else if (strcmp(parameter, PARAM_MOTHERBOARD_COUNT_RESOLUTION) == 0) {
+        return get_motherboard_count_resolution();
+    } else if (strcmp(parameter, PARAM_MOTHERBOARD_COUNT_CLEAR) == 0) {
+        return get_motherboard_count_clear();
+    } else if (strcmp(parameter, PARAM_MOTHERBOARD_COUNT_COOLDOWN) == 0) {
+        return get_motherboard_count_cooldown();
+    } else if (strcmp(parameter, PARAM_MOTHERBOARD_COUNT_MODE) == 0) {
+        return get_motherboard_count_mode();
+    }
+    // NN governor parameters
+    else if (strcmp(parameter, PARAM_NN_GOVERNOR_ENABLED) == 0) {
+        return get_nn_governor_enabled();
+    } else if (strcmp(parameter, PARAM_NN_IDLE_TIMEOUT) == 0) {
+        return get_nn_idle_timeout();
+    } else if (strcmp(parameter, PARAM_NN_IDLE_FPS) == 0) {
+        return get_nn_idle_fps();
+    }
+    // Motion gate parameters
+    else if (strcmp(parameter, PARAM_MOTION_GATE_ENABLED) == 0) {
+        return get_motion_gate_enabled();
+    } else if (strcmp(parameter, PARAM_MOTION_THRESHOLD) == 0) {
+        return get_motion_threshold();
+    }
+    // State checkpoint parameters
+    else if (strcmp(parameter, PARAM_CHECKPOINT_INTERVAL) == 0) {
+        return get_checkpoint_interval();
+    }
+    else if (strcmp(parameter, PARAM_LOG_EVENT_GAP) == 0) {
+        return get_log_event_gap();
     }
     
     return CMD_ERROR_INVALID_PARAMETER;
@@ -345,6 +443,56 @@ command_result_t cmd_motherboard_reset() {
     return CMD_SUCCESS;
 }
 
+command_result_t cmd_class_counter(const char* class_str, const char* spec_str) {
+    if (!class_str) {
+        Serial.println("\n=== DETECTION COUNTERS ===");
+        class_counter_print_stats(CLASS_UNKNOWN);
+        Serial.println("==========================\n");
+        return CMD_SUCCESS;
+    }
+
+    uint8_t object_class = is_numeric_value(class_str) ? parse_int_value(class_str) : detection_string_to_class(class_str);
+    if (object_class >= DETECTION_CLASS_COUNT) {
+        Serial.println("Unknown class. Use an ObjectClassList.h name or 0-" + String(DETECTION_CLASS_COUNT - 1));
+        return CMD_ERROR_INVALID_PARAMETER;
+    }
+
+    bool ok = true;
+    if (!spec_str) {
+        class_counter_print_stats(object_class);
+        return CMD_SUCCESS;
+    } else if (strcmp(spec_str, "on") == 0 || strcmp(spec_str, "off") == 0) {
+        ok = class_counter_set_enabled(object_class, strcmp(spec_str, "on") == 0);
+    } else if (class_counter_string_to_mode(spec_str) != CLASS_COUNTER_MODE_COUNT) {
+        ok = class_counter_set_mode(object_class, class_counter_string_to_mode(spec_str));
+    } else {
+        const class_counter_config_t* cfg = &system_config.class_counters[object_class];
+        unsigned int threshold, window_s, resolution_ms = cfg->resolution_ms;
+        unsigned int clear_threshold = cfg->clear_threshold, cooldown_s = cfg->cooldown_s;
+        if (sscanf(spec_str, "%u,%u,%u,%u,%u", &threshold, &window_s, &resolution_ms, &clear_threshold,
+                   &cooldown_s) < 2) {
+            Serial.println("Usage: counter <class> <threshold,window_s[,resolution_ms[,clear[,cooldown_s]]]> | "
+                           "counter <class> on|off|window|ewma");
+            return CMD_ERROR_INVALID_VALUE;
+        }
+        ok = class_counter_set_threshold(object_class, threshold) &&
+             class_counter_set_window(object_class, window_s) &&
+             class_counter_set_resolution(object_class, resolution_ms) &&
+             class_counter_set_clear_threshold(object_class, clear_threshold) &&
+             class_counter_set_cooldown(object_class, cooldown_s);
+    }
+
+    if (!ok) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    if (object_class == CLASS_MOTHERBOARD) {
+        motherboard_counter_zones_configure();
+    }
+    class_counter_print_stats(object_class);
+    Serial.println("✓ Counter updated (autosaved in " + String(CONFIG_AUTOSAVE_DELAY_MS / 1000) + "s, 'save' to persist now)");
+    return CMD_SUCCESS;
+}
+
 // ===== MOTHERBOARD COUNTER PARAMETER SETTERS =====
 command_result_t set_motherboard_count_enabled(const char* value) {
     if (!is_boolean_value(value)) {
@@ -366,8 +514,8 @@ command_result_t set_motherboard_count_threshold(const char* value) {
     }
     
     int threshold = parse_int_value(value);
-    if (threshold < 1 || threshold > 1000) {
-        Serial.println("Invalid range. Use 1-1000 detections.");
+    if (threshold < 1 || threshold > CLASS_COUNTER_MAX_THRESHOLD) {
+        Serial.println("Invalid range. Use 1-" + String(CLASS_COUNTER_MAX_THRESHOLD) + " detections.");
         return CMD_ERROR_INVALID_VALUE;
     }
     
@@ -385,8 +533,8 @@ command_result_t set_motherboard_count_window(const char* value) {
     }
     
     int window_seconds = parse_int_value(value);
-    if (window_seconds < 1 || window_seconds > 300) {
-        Serial.println("Invalid range. Use 1-300 seconds.");
+    if (window_seconds < 1 || window_seconds > CLASS_COUNTER_MAX_WINDOW) {
+        Serial.println("Invalid range. Use 1-" + String(CLASS_COUNTER_MAX_WINDOW) + " seconds.");
         return CMD_ERROR_INVALID_VALUE;
     }
     
@@ -398,22 +546,270 @@ command_result_t set_motherboard_count_window(const char* value) {
     }
 }
 
+command_result_t set_motherboard_count_resolution(const char* value) {
+    if (!is_numeric_value(value)) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    int resolution_ms = parse_int_value(value);
+    if (resolution_ms < 0 || resolution_ms > CLASS_COUNTER_MAX_RESOLUTION) {
+        Serial.println("Invalid range. Use 0 (auto) or 1-" + String(CLASS_COUNTER_MAX_RESOLUTION) + " ms.");
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    if (motherboard_counter_set_resolution(resolution_ms)) {
+        Serial.println("Motherboard counter resolution set to " + String(motherboard_counter_get_resolution()) + "ms");
+        return CMD_SUCCESS;
+    } else {
+        return CMD_ERROR_SYSTEM_ERROR;
+    }
+}
+
+command_result_t set_motherboard_count_clear(const char* value) {
+    if (!is_numeric_value(value)) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    int threshold = parse_int_value(value);
+    if (threshold < 0 || threshold >= system_config.class_counters[CLASS_MOTHERBOARD].count_threshold) {
+        Serial.println("Invalid range. Use 0 (auto) or 1-" +
+                       String(system_config.class_counters[CLASS_MOTHERBOARD].count_threshold - 1) +
+                       ", below " + String(PARAM_MOTHERBOARD_COUNT_THRESHOLD) + ".");
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    if (motherboard_counter_set_clear_threshold(threshold)) {
+        Serial.println("Motherboard trigger ends at " + String(threshold) + " detections" +
+                       (threshold ? String("") : String(" (auto)")));
+        return CMD_SUCCESS;
+    } else {
+        return CMD_ERROR_SYSTEM_ERROR;
+    }
+}
+
+command_result_t set_motherboard_count_cooldown(const char* value) {
+    if (!is_numeric_value(value)) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    int cooldown_seconds = parse_int_value(value);
+    if (cooldown_seconds < 0 || cooldown_seconds > CLASS_COUNTER_MAX_COOLDOWN) {
+        Serial.println("Invalid range. Use 0-" + String(CLASS_COUNTER_MAX_COOLDOWN) + " seconds.");
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    if (motherboard_counter_set_cooldown(cooldown_seconds)) {
+        Serial.println("Motherboard counter cooldown set to " + String(cooldown_seconds) + " seconds");
+        return CMD_SUCCESS;
+    } else {
+        return CMD_ERROR_SYSTEM_ERROR;
+    }
+}
+
+command_result_t set_motherboard_count_mode(const char* value) {
+    uint8_t mode = is_numeric_value(value) ? parse_int_value(value) : class_counter_string_to_mode(value);
+    if (mode >= CLASS_COUNTER_MODE_COUNT) {
+        Serial.println("Invalid mode. Use window (0) or ewma (1).");
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    if (motherboard_counter_set_mode(mode)) {
+        Serial.println("Motherboard counter mode set to " + String(class_counter_mode_to_string(mode)));
+        return CMD_SUCCESS;
+    } else {
+        return CMD_ERROR_SYSTEM_ERROR;
+    }
+}
+
 // ===== MOTHERBOARD COUNTER PARAMETER GETTERS =====
 command_result_t get_motherboard_count_enabled() {
     Serial.println(String(PARAM_MOTHERBOARD_COUNT_ENABLED) + " = " + 
-                  String(system_config.motherboard_count_enabled ? "1" : "0"));
+                  String(system_config.class_counters[CLASS_MOTHERBOARD].enabled ? "1" : "0"));
     return CMD_SUCCESS;
 }
 
 command_result_t get_motherboard_count_threshold() {
     Serial.println(String(PARAM_MOTHERBOARD_COUNT_THRESHOLD) + " = " + 
-                  String(system_config.motherboard_count_threshold));
+                  String(system_config.class_counters[CLASS_MOTHERBOARD].count_threshold));
     return CMD_SUCCESS;
 }
 
 command_result_t get_motherboard_count_window() {
     Serial.println(String(PARAM_MOTHERBOARD_COUNT_WINDOW) + " = " + 
-                  String(system_config.motherboard_count_window_ms/1000) + " seconds");
+                  String(system_config.class_counters[CLASS_MOTHERBOARD].window_s) + " seconds");
+    return CMD_SUCCESS;
+}
+
+command_result_t get_motherboard_count_resolution() {
+    Serial.println(String(PARAM_MOTHERBOARD_COUNT_RESOLUTION) + " = " +
+                  String(system_config.class_counters[CLASS_MOTHERBOARD].resolution_ms) + " ms (effective " +
+                  String(motherboard_counter_get_resolution()) + " ms)");
+    return CMD_SUCCESS;
+}
+
+command_result_t get_motherboard_count_clear() {
+    Serial.println(String(PARAM_MOTHERBOARD_COUNT_CLEAR) + " = " +
+                  String(system_config.class_counters[CLASS_MOTHERBOARD].clear_threshold) +
+                  (system_config.class_counters[CLASS_MOTHERBOARD].clear_threshold ? String("") : String(" (auto)")));
+    return CMD_SUCCESS;
+}
+
+command_result_t get_motherboard_count_cooldown() {
+    Serial.println(String(PARAM_MOTHERBOARD_COUNT_COOLDOWN) + " = " +
+                  String(system_config.class_counters[CLASS_MOTHERBOARD].cooldown_s) + " seconds");
+    return CMD_SUCCESS;
+}
+
+command_result_t get_motherboard_count_mode() {
+    Serial.println(String(PARAM_MOTHERBOARD_COUNT_MODE) + " = " +
+                  String(class_counter_mode_to_string(system_config.class_counters[CLASS_MOTHERBOARD].mode)) +
+                  " (rate " + String(motherboard_counter_get_rate(), 2) + "/s)");
+    return CMD_SUCCESS;
+}
+
+// ===== NN GOVERNOR PARAMETER HANDLERS =====
+command_result_t set_nn_governor_enabled(const char* value) {
+    if (!is_boolean_value(value)) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    bool enabled = parse_bool_value(value);
+    nn_governor_set_enabled(enabled);
+    Serial.println("NN governor " + String(enabled ? "enabled" : "disabled"));
+    return CMD_SUCCESS;
+}
+
+command_result_t set_nn_idle_timeout(const char* value) {
+    if (!is_numeric_value(value)) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    int timeout_seconds = parse_int_value(value);
+    if (!nn_governor_set_idle_timeout(timeout_seconds)) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    Serial.println("NN idle timeout set to " + String(timeout_seconds) + " seconds");
+    return CMD_SUCCESS;
+}
+
+command_result_t set_nn_idle_fps(const char* value) {
+    if (!is_numeric_value(value)) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    int fps = parse_int_value(value);
+    if (fps < 1 || fps > NN_GOVERNOR_MAX_IDLE_FPS || !nn_governor_set_idle_fps(fps)) {
+        Serial.println("Invalid range. Use 1-" + String(NN_GOVERNOR_MAX_IDLE_FPS) + " fps.");
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    Serial.println("NN idle frame rate set to " + String(fps) + " fps");
+    return CMD_SUCCESS;
+}
+
+command_result_t get_nn_governor_enabled() {
+    Serial.println(String(PARAM_NN_GOVERNOR_ENABLED) + " = " + 
+                  String(system_config.nn_governor_enabled ? "1" : "0"));
+    return CMD_SUCCESS;
+}
+
+command_result_t get_nn_idle_timeout() {
+    Serial.println(String(PARAM_NN_IDLE_TIMEOUT) + " = " + 
+                  String(system_config.nn_idle_timeout_ms/1000) + " seconds");
+    return CMD_SUCCESS;
+}
+
+command_result_t get_nn_idle_fps() {
+    Serial.println(String(PARAM_NN_IDLE_FPS) + " = " + String(system_config.nn_idle_fps) + " fps");
+    return CMD_SUCCESS;
+}
+
+// ===== MOTION GATE PARAMETER HANDLERS =====
+command_result_t set_motion_gate_enabled(const char* value) {
+    if (!is_boolean_value(value)) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    bool enabled = parse_bool_value(value);
+    motion_gate_set_enabled(enabled);
+    Serial.println("Motion gate " + String(enabled ? "enabled" : "disabled"));
+    return CMD_SUCCESS;
+}
+
+command_result_t set_motion_threshold(const char* value) {
+    if (!is_numeric_value(value)) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    int threshold = parse_int_value(value);
+    if (threshold < 1 || threshold > MOTION_GATE_MAX_THRESHOLD || !motion_gate_set_threshold(threshold)) {
+        Serial.println("Invalid range. Use 1-" + String(MOTION_GATE_MAX_THRESHOLD) + ".");
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    Serial.println("Motion threshold set to " + String(threshold));
+    return CMD_SUCCESS;
+}
+
+command_result_t get_motion_gate_enabled() {
+    Serial.println(String(PARAM_MOTION_GATE_ENABLED) + " = " + 
+                  String(system_config.motion_gate_enabled ? "1" : "0"));
+    return CMD_SUCCESS;
+}
+
+command_result_t get_motion_threshold() {
+    Serial.println(String(PARAM_MOTION_THRESHOLD) + " = " + String(system_config.motion_threshold));
+    return CMD_SUCCESS;
+}
+
+// ===== STATE CHECKPOINT PARAMETER HANDLERS =====
+command_result_t set_checkpoint_interval(const char* value) {
+    if (!is_numeric_value(value)) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    int interval_seconds = parse_int_value(value);
+    if (interval_seconds < 0 || !checkpoint_set_interval(interval_seconds)) {
+        Serial.println("Invalid range. Use 0 (off) or " + String(CHECKPOINT_MIN_INTERVAL) + "-65535 seconds.");
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    Serial.println("Checkpoint interval set to " + String(interval_seconds) + " seconds" +
+                  (interval_seconds ? String("") : String(" (off)")));
+    return CMD_SUCCESS;
+}
+
+command_result_t get_checkpoint_interval() {
+    Serial.println(String(PARAM_CHECKPOINT_INTERVAL) + " = " +
+                  String(system_config.checkpoint_interval_s) + " seconds");
+    return CMD_SUCCESS;
+}
+
+// ===== DETECTION LOG PARAMETER HANDLERS =====
+command_result_t set_log_event_gap(const char* value) {
+    if (!is_numeric_value(value)) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    int gap_seconds = parse_int_value(value);
+    if (gap_seconds < 0 || gap_seconds > LOG_EVENT_MAX_GAP) {
+        Serial.println("Invalid range. Use 0 (a record per detection) to " + String(LOG_EVENT_MAX_GAP) + " seconds.");
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    system_config.log_event_gap_s = gap_seconds;
+    Serial.println("Log event gap set to " + String(gap_seconds) + " seconds" +
+                  (gap_seconds ? String("") : String(" (a record per detection)")));
+    return CMD_SUCCESS;
+}
+
+command_result_t get_log_event_gap() {
+    const flash_log_stats_t* log = flash_log_get_stats();
+    Serial.println(String(PARAM_LOG_EVENT_GAP) + " = " + String(system_config.log_event_gap_s) + " seconds, " +
+                  String(log->staged_hits) + " detections in " + String(log->staged_records) + " records" +
+                  (log->staged_records ? " (" + String((float)log->staged_hits / log->staged_records, 1) + ":1)"
+                                       : String("")));
     return CMD_SUCCESS;
 }
 
@@ -445,7 +841,7 @@ command_result_t set_detection_threshold(const char* value) {
         return CMD_ERROR_INVALID_VALUE;
     }
     
-    system_config.detection_threshold = threshold;
+    detection_set_thresholds(threshold, system_config.motherboard_threshold);
     Serial.println("Detection threshold set to " + String(threshold));
     return CMD_SUCCESS;
 }
@@ -461,7 +857,7 @@ command_result_t set_motherboard_threshold(const char* value) {
         return CMD_ERROR_INVALID_VALUE;
     }
     
-    system_config.motherboard_threshold = threshold;
+    detection_set_thresholds(system_config.detection_threshold, threshold);
     Serial.println("Motherboard threshold set to " + String(threshold));
     return CMD_SUCCESS;
 }
@@ -617,6 +1013,11 @@ command_result_t cmd_reset_config() {
 
 command_result_t cmd_reboot() {
     Serial.println("Rebooting system in 3 seconds...");
+    if (config_is_dirty()) {
+        config_save_to_flash();     // Pending autosave, flushes the log too
+    }
+    flash_log_flush();
+    checkpoint_save();
     delay(3000);
     NVIC_SystemReset();
     return CMD_SUCCESS;
@@ -626,6 +1027,7 @@ command_result_t cmd_reset_system() {
     Serial.println("Triggering system reset...");
     delay(1000);
     config_save_to_flash();
+    checkpoint_save();
     gpio_trigger_system_reset();
     delay(2000);
     NVIC_SystemReset();
@@ -646,6 +1048,24 @@ command_result_t cmd_logs(const char* count_str) {
     }
 }
 
+// Events overlapping [from_s, to_s] of uptime, found through the sector summaries
+command_result_t cmd_logs_range(const char* from_str, const char* to_str) {
+    long from_s = atol(from_str);
+    long to_s = atol(to_str);
+    if (from_s < 0 || to_s < from_s || to_s > (long)(UINT32_MAX / 1000)) {
+        Serial.println("Usage: logs <from_s> <to_s>, seconds of uptime");
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    if (flash_is_initialized()) {
+        flash_print_log_range((uint32_t)from_s * 1000, (uint32_t)to_s * 1000 + 999, 50);
+        return CMD_SUCCESS;
+    } else {
+        Serial.println("Flash not initialized");
+        return CMD_ERROR_SYSTEM_ERROR;
+    }
+}
+
 command_result_t cmd_clear_logs() {
     Serial.println("Clearing detection logs...");
     if (flash_is_initialized()) {
@@ -737,12 +1157,212 @@ command_result_t cmd_flash_status() {
     }
 }
 
-command_result_t cmd_detection_stats() {
-    Serial.println("\n=== DETECTION STATISTICS ===");
-    Serial.println("Total Detections: " + String(system_config.total_detections));
-    Serial.println("Detection Threshold: " + String(system_config.detection_threshold));
-    Serial.println("Motherboard Threshold: " + String(system_config.motherboard_threshold));
-    Serial.println("============================\n");
+command_result_t cmd_detection_stats(const char* option) {
+    if (option && strcmp(option, "reset") == 0) {
+        detection_reset_statistics();
+        Serial.println("✓ Detection statistics reset");
+        return CMD_SUCCESS;
+    } else if (option && strcmp(option, "current") == 0) {
+        detection_print_current_results();
+        return CMD_SUCCESS;
+    } else if (option && strcmp(option, "filter") == 0) {
+        detection_filter_print();
+        return CMD_SUCCESS;
+    }
+    
+    detection_print_statistics();
+    Serial.println("Logged Detections: " + String(system_config.total_detections));
+    return CMD_SUCCESS;
+}
+
+command_result_t cmd_tracker(const char* option) {
+    if (option && strcmp(option, "reset") == 0) {
+        tracker_reset();
+        Serial.println("✓ Object tracker reset");
+        return CMD_SUCCESS;
+    } else if (option && (strcmp(option, "on") == 0 || strcmp(option, "off") == 0)) {
+        tracker_set_enabled(strcmp(option, "on") == 0);
+        Serial.println("✓ Object tracker " + String(tracker_is_enabled() ? "enabled" : "disabled"));
+        return CMD_SUCCESS;
+    } else if (option) {
+        Serial.println("Usage: tracker [on|off|reset]");
+        return CMD_ERROR_INVALID_PARAMETER;
+    }
+    
+    tracker_print_status();
+    return CMD_SUCCESS;
+}
+
+command_result_t cmd_roi(const char* zone_str, const char* rect_str) {
+    if (!zone_str) {
+        roi_print_status();
+        return CMD_SUCCESS;
+    }
+    
+    if (strcmp(zone_str, "reset") == 0) {
+        roi_reset_stats();
+        Serial.println("✓ ROI statistics reset");
+        return CMD_SUCCESS;
+    }
+    
+    if (!is_numeric_value(zone_str) || !rect_str) {
+        Serial.println("Usage: roi <zone> <x1,y1,x2,y2[,mb_threshold]> | roi <zone> off");
+        return CMD_ERROR_INVALID_PARAMETER;
+    }
+    
+    int zone = parse_int_value(zone_str);
+    if (zone >= ROI_MAX_ZONES) {
+        Serial.println("Invalid zone. Use 0-" + String(ROI_MAX_ZONES - 1));
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    roi_result_t result;
+    
+    if (strcmp(rect_str, "off") == 0) {
+        result = roi_disable_zone(zone);
+    } else {
+        unsigned int x1, y1, x2, y2, threshold = 0;
+        int fields = sscanf(rect_str, "%u,%u,%u,%u,%u", &x1, &y1, &x2, &y2, &threshold);
+        if (fields < 4) {
+            Serial.println("Invalid rectangle. Use x1,y1,x2,y2 in " + String(NNWIDTH) + "x" + String(NNHEIGHT) + " pixels");
+            return CMD_ERROR_INVALID_VALUE;
+        }
+        result = roi_set_zone(zone, x1, y1, x2, y2, threshold);
+    }
+    
+    if (result != ROI_SUCCESS) {
+        Serial.println("ROI error: " + String(roi_result_to_string(result)));
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    
+    Serial.println("✓ ROI zone " + String(zone) + " updated (autosaved in " + String(CONFIG_AUTOSAVE_DELAY_MS / 1000) + "s, 'save' to persist now)");
+    return CMD_SUCCESS;
+}
+
+// Spec: <class>,<count|rate|absence>,<window_s>,<threshold>,<cooldown_s>[,<actions>]
+// where actions joins lora[:type], led[:pattern] and laser with '+'
+static bool parse_rule_actions(char* actions, trigger_rule_config_t* config) {
+    config->actions = 0;
+    config->lora_type = TRIGGER_DEFAULT_LORA_TYPE;
+    config->led_pattern = TRIGGER_DEFAULT_LED_PATTERN;
+
+    for (char* token = strtok(actions, "+"); token; token = strtok(NULL, "+")) {
+        char* arg = strchr(token, ':');
+        if (arg) {
+            *arg++ = '\0';
+            if (!is_numeric_value(arg)) {
+                return false;
+            }
+        }
+        if (strcmp(token, "lora") == 0) {
+            config->actions |= TRIGGER_ACTION_LORA;
+            if (arg) {
+                config->lora_type = parse_int_value(arg);
+            }
+        } else if (strcmp(token, "led") == 0) {
+            config->actions |= TRIGGER_ACTION_LED;
+            if (arg) {
+                config->led_pattern = parse_int_value(arg);
+            }
+        } else if (strcmp(token, "laser") == 0 && !arg) {
+            config->actions |= TRIGGER_ACTION_LASER;
+        } else if (strcmp(token, "none") != 0) {
+            return false;
+        }
+    }
+    return config->lora_type <= LORA_MSG_MOTHERBOARD_TRIGGER && config->led_pattern <= LED_PATTERN_SOLID_ON;
+}
+
+command_result_t cmd_rule(const char* rule_str, const char* spec_str) {
+    if (!rule_str) {
+        trigger_rules_print_status();
+        return CMD_SUCCESS;
+    }
+
+    if (strcmp(rule_str, "reset") == 0) {
+        trigger_rules_reset();
+        Serial.println("✓ Trigger rule windows and statistics reset");
+        return CMD_SUCCESS;
+    }
+
+    if (!is_numeric_value(rule_str) || !spec_str) {
+        Serial.println("Usage: rule <n> <class>,<count|rate|absence>,<window_s>,<threshold>,<cooldown_s>[,<actions>] | rule <n> off");
+        return CMD_ERROR_INVALID_PARAMETER;
+    }
+
+    int rule = parse_int_value(rule_str);
+    if (rule >= TRIGGER_MAX_RULES) {
+        Serial.println("Invalid rule. Use 0-" + String(TRIGGER_MAX_RULES - 1));
+        return CMD_ERROR_INVALID_VALUE;
+    }
+    trigger_result_t result;
+
+    if (strcmp(spec_str, "off") == 0) {
+        result = trigger_rules_disable(rule);
+    } else {
+        char class_name[16], aggregation[16], actions[32] = "lora";
+        unsigned long window_s, threshold, cooldown_s;
+        int fields = sscanf(spec_str, "%15[^,],%15[^,],%lu,%lu,%lu,%31s", class_name, aggregation,
+                            &window_s, &threshold, &cooldown_s, actions);
+        if (fields < 5 || window_s > TRIGGER_MAX_WINDOW || threshold > UINT16_MAX || cooldown_s > UINT16_MAX) {
+            Serial.println("Invalid rule. Window and cooldown 0-" + String(TRIGGER_MAX_WINDOW) +
+                           "s, threshold up to " + String(UINT16_MAX) + " (per minute for rate)");
+            return CMD_ERROR_INVALID_VALUE;
+        }
+
+        trigger_rule_config_t config = {0};
+        config.object_class = is_numeric_value(class_name) ? parse_int_value(class_name)
+                                                            : detection_string_to_class(class_name);
+        config.aggregation = trigger_string_to_aggregation(aggregation);
+        config.window_s = window_s;
+        config.threshold = threshold;
+        config.cooldown_s = cooldown_s;
+        if (!parse_rule_actions(actions, &config)) {
+            Serial.println("Invalid actions. Join lora[:0-5], led[:0-5], laser or none with '+'");
+            return CMD_ERROR_INVALID_VALUE;
+        }
+        result = trigger_rules_set(rule, &config);
+    }
+
+    if (result != TRIGGER_SUCCESS) {
+        Serial.println("Rule error: " + String(trigger_result_to_string(result)));
+        return CMD_ERROR_INVALID_VALUE;
+    }
+
+    Serial.println("✓ Rule " + String(rule) + " updated (autosaved in " + String(CONFIG_AUTOSAVE_DELAY_MS / 1000) + "s, 'save' to persist now)");
+    return CMD_SUCCESS;
+}
+
+command_result_t cmd_motion(const char* option) {
+    if (option && strcmp(option, "reset") == 0) {
+        motion_gate_reset_stats();
+        Serial.println("✓ Motion gate statistics reset");
+        return CMD_SUCCESS;
+    }
+    
+    motion_gate_print_status();
+    return CMD_SUCCESS;
+}
+
+command_result_t cmd_checkpoint(const char* option) {
+    if (option && strcmp(option, "save") == 0) {
+        if (checkpoint_save() != FLASH_SUCCESS) {
+            Serial.println("Checkpoint not written (checkpoint_interval 0 or flash error)");
+            return CMD_ERROR_SYSTEM_ERROR;
+        }
+        Serial.println("✓ Checkpoint #" + String(checkpoint_get_stats()->sequence) + " written in " +
+                      String(checkpoint_get_stats()->last_duration_us) + "us");
+        return CMD_SUCCESS;
+    } else if (option && strcmp(option, "clear") == 0) {
+        if (checkpoint_clear() != FLASH_SUCCESS) {
+            return CMD_ERROR_SYSTEM_ERROR;
+        }
+        Serial.println("✓ Checkpoints cleared, next boot starts with empty counters");
+        return CMD_SUCCESS;
+    } else if (option) {
+        return CMD_ERROR_INVALID_PARAMETER;
+    }
+    
+    checkpoint_print_status();
     return CMD_SUCCESS;
 }
 
@@ -761,11 +1381,17 @@ void print_help_message() {
     Serial.println("status                   - Show system status");
     Serial.println("set <param> <value>      - Set parameter value");
     Serial.println("get <param>              - Get parameter value");
-    Serial.println("save                     - Save configuration to flash");
+    Serial.println("save                     - Save configuration to flash now (set, roi, rule, counter autosave)");
     Serial.println("reset                    - Reset configuration to defaults");
     Serial.println("reset_system             - Trigger hardware/software reset");
     Serial.println("reboot                   - Restart system");
     Serial.println("lora [stats|test|diag]   - LoRa operations");
+    Serial.println("detection [current|filter|reset] - Detection pipeline statistics");
+    Serial.println("tracker [on|off|reset]   - Object tracker (count boards, not frames)");
+    Serial.println("roi [<zone> <x1,y1,x2,y2[,n]>|<zone> off|reset] - ROI zones, n = zone MB trigger");
+    Serial.println("motion [reset]           - Motion gate state, skip ratio and cost");
+    Serial.println("checkpoint [save|clear]  - Counter state checkpoint, cost per save");
+    Serial.println("rule [<n> <spec>|<n> off|reset] - Trigger rules, spec = class,count|rate|absence,window_s,threshold,cooldown_s[,actions]");
     
     Serial.println("\n=== WIFI/RTSP COMMANDS ===");
     Serial.println("rtsp_stream              - Start WiFi + RTSP streaming");
@@ -775,17 +1401,36 @@ void print_help_message() {
     Serial.println("\n=== MOTHERBOARD COUNTER COMMANDS ===");
     Serial.println("mb_counter               - Show motherboard counter statistics");
     Serial.println("mb_reset                 - Reset motherboard counter");
+    Serial.println("counter [<class> [<spec>|on|off|window|ewma]] - Per-class counters, spec = threshold,window_s[,resolution_ms[,clear[,cooldown_s]]]");
     
     Serial.println("\n=== MOTHERBOARD COUNTER PARAMETERS ===");
     Serial.println("mb_count_enabled         - Enable/disable counter (0/1)");
-    Serial.println("mb_count_threshold       - Detection count to trigger LoRa (1-1000)");
-    Serial.println("mb_count_window          - Time window in seconds (1-300)");
+    Serial.println("mb_count_threshold       - Detection count to trigger LoRa (1-" + String(CLASS_COUNTER_MAX_THRESHOLD) + ")");
+    Serial.println("mb_count_window          - Time window in seconds (1-" + String(CLASS_COUNTER_MAX_WINDOW) + ")");
+    Serial.println("mb_count_resolution      - Window time resolution in ms (0 = auto)");
+    Serial.println("mb_count_clear           - Count at which a trigger ends (0 = half the threshold)");
+    Serial.println("mb_count_cooldown        - Seconds after a trigger ends before re-arming (0-" + String(CLASS_COUNTER_MAX_COOLDOWN) + ")");
+    Serial.println("mb_count_mode            - Trigger on window count or ewma rate x window");
+    
+    Serial.println("\n=== NN GOVERNOR PARAMETERS ===");
+    Serial.println("nn_governor              - Drop NN rate when idle (0/1)");
+    Serial.println("nn_idle_timeout          - Seconds without detections before idling (10-86400)");
+    Serial.println("nn_idle_fps              - Idle inference rate (1-5 fps)");
+    Serial.println("motion_gate              - Skip inference on static scenes (0/1)");
+    Serial.println("motion_threshold         - Mean luminance change that counts as motion (1-64)");
+    Serial.println("checkpoint_interval      - Seconds between counter checkpoints (0 = off, min " + String(CHECKPOINT_MIN_INTERVAL) + ")");
+    Serial.println("log_event_gap            - Seconds a logged event waits for more hits (0 = a record per detection)");
     
     Serial.println("\n=== EXAMPLES ===");
     Serial.println("set mb_count_threshold 25   - Trigger LoRa after 25 MB detections");
     Serial.println("set mb_count_window 5       - Use 5-second detection window");
+    Serial.println("set mb_count_window 300     - 5-minute window, e.g. with threshold 500");
     Serial.println("get mb_count_threshold      - Show current MB trigger threshold");
     Serial.println("mb_counter                  - Show detailed MB counter stats");
+    Serial.println("counter led_on 20,60        - Trigger after 20 LED detections in a minute");
+    Serial.println("rule 0 motherboard,count,10,50,30,lora+led      - Burst: 50 boards in 10s");
+    Serial.println("rule 1 motherboard,count,300,300,300,lora:2     - Sustained: 300 boards in 5 min");
+    Serial.println("rule 2 motherboard,absence,600,0,1800,lora+laser - No board for 10 min");
     Serial.println("save                        - Save all settings to flash");
     Serial.println("========================================\n");
 
@@ -794,6 +1439,7 @@ void print_help_message() {
     Serial.println("nn_reset                 - Reset neural network system");
     Serial.println("nn_restart               - Restart neural network");
     Serial.println("camera_reset             - Complete camera system reset");
+    Serial.println("nn_sim <fps|0>           - Simulated NN source (0 = stop)");
 }
 
 void print_system_status() {
@@ -804,13 +1450,14 @@ void print_system_status() {
     Serial.println("Detection Threshold: " + String(system_config.detection_threshold));
     Serial.println("Motherboard Threshold: " + String(system_config.motherboard_threshold));
     
-    Serial.println("\n=== MOTHERBOARD COUNTER STATUS ===");
-    Serial.println("Enabled: " + String(system_config.motherboard_count_enabled ? "YES" : "NO"));
-    Serial.println("Threshold: " + String(system_config.motherboard_count_threshold) + " detections");
-    Serial.println("Window: " + String(system_config.motherboard_count_window_ms/1000) + " seconds");
-    Serial.println("Total Triggers: " + String(system_config.total_motherboard_count_triggers));
+    Serial.println("\n=== DETECTION COUNTER STATUS ===");
+    class_counter_print_stats(CLASS_UNKNOWN);
+    Serial.println("Total MB Triggers: " + String(system_config.total_motherboard_count_triggers));
     
-    Serial.println("===========================\n");
+    nn_governor_print_status();
+    if (system_config.motion_gate_enabled) {
+        motion_gate_print_status();
+    }
 }
 
 // ===== INPUT HANDLING =====
@@ -918,6 +1565,30 @@ command_result_t cmd_nn_restart() {
     }
 }
 
+command_result_t cmd_nn_sim(const char* fps_str) {
+    if (!is_numeric_value(fps_str)) {
+        return CMD_ERROR_INVALID_VALUE;
+    }
+
+    int fps = parse_int_value(fps_str);
+    if (fps == 0) {
+        detection_sim_stop();
+        detection_queue_print_stats();
+        Serial.println("✓ Simulated NN source stopped");
+        return CMD_SUCCESS;
+    }
+
+    detection_queue_reset_stats();
+    if (!detection_sim_start(fps)) {
+        Serial.println("Invalid range. Use 1-" + String(DETECTION_SIM_MAX_FPS) + " fps.");
+        return CMD_ERROR_INVALID_VALUE;
+    }
+
+    Serial.println("✓ Simulated NN source running at " + String(fps) + " fps");
+    Serial.println("Use 'nn_status' to watch queue drops, 'nn_sim 0' to stop");
+    return CMD_SUCCESS;
+}
+
 command_result_t cmd_camera_reset() {
     Serial.println("Performing complete camera reset...");
     if (reset_camera_system()) {
@@ -41,6 +41,7 @@ command_result_t cmd_save_config();
 command_result_t cmd_reset_config();
 command_result_t cmd_reboot();
 command_result_t cmd_logs(const char* count_str);
+command_result_t cmd_logs_range(const char* from_str, const char* to_str);
 command_result_t cmd_clear_logs();
 command_result_t cmd_test();
 command_result_t cmd_gpio_status();
@@ -48,7 +49,12 @@ command_result_t cmd_lora_status();
 command_result_t cmd_lora_stats();
 command_result_t cmd_lora_test();
 command_result_t cmd_flash_status();
-command_result_t cmd_detection_stats();
+command_result_t cmd_detection_stats(const char* option);
+command_result_t cmd_tracker(const char* option);
+command_result_t cmd_roi(const char* zone_str, const char* rect_str);
+command_result_t cmd_rule(const char* rule_str, const char* spec_str);
+command_result_t cmd_motion(const char* option);
+command_result_t cmd_checkpoint(const char* option);
 command_result_t cmd_reset_system();
 
 // ===== WIFI/RTSP COMMAND HANDLERS - FIXED RETURN TYPES =====
@@ -60,6 +66,7 @@ command_result_t cmd_lora_diagnostics();
 // ===== MOTHERBOARD COUNTER COMMAND HANDLERS =====
 command_result_t cmd_motherboard_counter();
 command_result_t cmd_motherboard_reset();
+command_result_t cmd_class_counter(const char* class_str, const char* spec_str);
 
 // ===== PARAMETER HANDLERS =====
 command_result_t set_lora_interval(const char* value);
@@ -75,6 +82,32 @@ command_result_t set_crosshair_enabled(const char* value);
 command_result_t set_motherboard_count_enabled(const char* value);
 command_result_t set_motherboard_count_threshold(const char* value);
 command_result_t set_motherboard_count_window(const char* value);
+command_result_t set_motherboard_count_resolution(const char* value);
+command_result_t set_motherboard_count_clear(const char* value);
+command_result_t set_motherboard_count_cooldown(const char* value);
+command_result_t set_motherboard_count_mode(const char* value);
+
+// ===== NN GOVERNOR PARAMETER HANDLERS =====
+command_result_t set_nn_governor_enabled(const char* value);
+command_result_t set_nn_idle_timeout(const char* value);
+command_result_t set_nn_idle_fps(const char* value);
+command_result_t get_nn_governor_enabled();
+command_result_t get_nn_idle_timeout();
+command_result_t get_nn_idle_fps();
+
+// ===== MOTION GATE PARAMETER HANDLERS =====
+command_result_t set_motion_gate_enabled(const char* value);
+command_result_t set_motion_threshold(const char* value);
+command_result_t get_motion_gate_enabled();
+command_result_t get_motion_threshold();
+
+// ===== STATE CHECKPOINT PARAMETER HANDLERS =====
+command_result_t set_checkpoint_interval(const char* value);
+command_result_t get_checkpoint_interval();
+
+// ===== DETECTION LOG PARAMETER HANDLERS =====
+command_result_t set_log_event_gap(const char* value);
+command_result_t get_log_event_gap();
 
 // ===== GET PARAMETER HANDLERS =====
 command_result_t get_lora_interval();
@@ -90,6 +123,10 @@ command_result_t get_total_detections();
 command_result_t get_motherboard_count_enabled();
 command_result_t get_motherboard_count_threshold();
 command_result_t get_motherboard_count_window();
+command_result_t get_motherboard_count_resolution();
+command_result_t get_motherboard_count_clear();
+command_result_t get_motherboard_count_cooldown();
+command_result_t get_motherboard_count_mode();
 
 // ===== UTILITY FUNCTIONS =====
 void print_welcome_message();
@@ -113,6 +150,7 @@ command_result_t cmd_nn_status();
 command_result_t cmd_nn_reset(); 
 command_result_t cmd_nn_restart();
 command_result_t cmd_camera_reset();
+command_result_t cmd_nn_sim(const char* fps_str);
 
 
 // ===== COMMAND CONSTANTS =====
@@ -152,6 +190,25 @@ command_result_t cmd_camera_reset();
 #define PARAM_MOTHERBOARD_COUNT_ENABLED       "mb_count_enabled"
 #define PARAM_MOTHERBOARD_COUNT_THRESHOLD     "mb_count_threshold"
 #define PARAM_MOTHERBOARD_COUNT_WINDOW        "mb_count_window"
+#define PARAM_MOTHERBOARD_COUNT_RESOLUTION    "mb_count_resolution"
+#define PARAM_MOTHERBOARD_COUNT_CLEAR         "mb_count_clear"
+#define PARAM_MOTHERBOARD_COUNT_COOLDOWN      "mb_count_cooldown"
+#define PARAM_MOTHERBOARD_COUNT_MODE          "mb_count_mode"
+
+// ===== NN GOVERNOR PARAMETERS =====
+#define PARAM_NN_GOVERNOR_ENABLED             "nn_governor"
+#define PARAM_NN_IDLE_TIMEOUT                 "nn_idle_timeout"
+#define PARAM_NN_IDLE_FPS                     "nn_idle_fps"
+
+// ===== MOTION GATE PARAMETERS =====
+#define PARAM_MOTION_GATE_ENABLED             "motion_gate"
+#define PARAM_MOTION_THRESHOLD                "motion_threshold"
+
+// ===== STATE CHECKPOINT PARAMETERS =====
+#define PARAM_CHECKPOINT_INTERVAL             "checkpoint_interval"
+
+// ===== DETECTION LOG PARAMETERS =====
+#define PARAM_LOG_EVENT_GAP                   "log_event_gap"
 
 
 
@@ -0,0 +1,412 @@
+// state_checkpoint.cpp - Counter and Trigger State Checkpoints Implementation
+#include "state_checkpoint.h"
+#include "class_counter.h"
+#include "motherboard_counter.h"
+#include "trigger_rules.h"
+
+#define CHECKPOINT_MAGIC        0x54504B43      // "CKPT"
+#define CHECKPOINT_VERSION      3               // Of the header, the payload is checked by layout
+#define CHECKPOINT_TAG          (0x43000000 | CHECKPOINT_VERSION)     // 'C' + layout
+
+// ===== CHECKPOINT LAYOUT =====
+// Header after the slot's sector header, payload right after it: class
+// counters, zone counters, trigger rules, in that order
+typedef struct {
+    uint32_t magic;                 // Written last, CHECKPOINT_MAGIC once the slot is complete
+    uint32_t version;
+    uint32_t layout;                // checkpoint_layout() of the build that wrote it
+    uint32_t sequence;
+    uint32_t payload_size;          // Bytes
+    uint32_t checksum;              // CRC-32 of the payload
+    uint32_t uptime_s;              // Of the run that wrote it
+    uint32_t total_detections;
+    uint32_t total_motherboard_count_triggers;
+} checkpoint_header_t;
+
+// ===== GLOBAL VARIABLES =====
+static checkpoint_stats_t checkpoint_stats = {0};
+static flash_wear_area_t checkpoint_area = {0};
+static uint8_t checkpoint_slot = 0;             // Slot the next save goes to
+static uint32_t checkpoint_payload_size = 0;
+static uint32_t checkpoint_layout_signature = 0;
+static uint32_t checkpoint_last_signature = 0;
+static uint32_t checkpoint_last_check = 0;
+
+// Stream over one slot while a checkpoint is written or read
+static uint32_t stream_offset;
+static uint32_t stream_end;
+static uint32_t stream_size;
+static uint32_t stream_checksum;
+static uint32_t stream_word;
+static uint8_t stream_bytes;                    // Bytes of stream_word in use
+static bool stream_ok;
+
+// ===== STREAM HELPERS =====
+static uint32_t checkpoint_slot_offset(uint8_t slot) {
+    return flash_wear_data_offset(&checkpoint_area, slot);
+}
+
+static void checkpoint_stream_open(uint8_t slot) {
+    stream_offset = checkpoint_slot_offset(slot) + sizeof(checkpoint_header_t);
+    stream_end = checkpoint_slot_offset(slot) + FLASH_SECTOR_DATA_SIZE;
+    stream_size = 0;
+    stream_checksum = 0;
+    stream_word = 0;
+    stream_bytes = 0;
+    stream_ok = true;
+}
+
+// Same CRC-32 as the configuration, over the whole block at once
+static void checkpoint_stream_sum(const void* data, uint32_t size) {
+    stream_checksum = crc32_update(stream_checksum, data, size);
+    stream_size += size;
+}
+
+static void checkpoint_write_block(const void* data, uint32_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    checkpoint_stream_sum(data, size);
+    for (uint32_t i = 0; i < size; i++) {
+        stream_word |= (uint32_t)bytes[i] << (8 * stream_bytes);
+        if (++stream_bytes < 4) {
+            continue;
+        }
+        if (stream_offset + 4 > stream_end) {
+            stream_ok = false;
+        } else {
+            FlashMemory.writeWord(stream_offset, stream_word);
+        }
+        stream_offset += 4;
+        stream_word = 0;
+        stream_bytes = 0;
+    }
+}
+
+static void checkpoint_write_flush() {
+    if (stream_bytes == 0) {
+        return;
+    }
+    if (stream_offset + 4 > stream_end) {
+        stream_ok = false;
+    } else {
+        FlashMemory.writeWord(stream_offset, stream_word);
+    }
+    stream_offset += 4;
+    stream_word = 0;
+    stream_bytes = 0;
+}
+
+static bool checkpoint_read_block(void* data, uint32_t size) {
+    uint8_t* bytes = (uint8_t*)data;
+
+    for (uint32_t i = 0; i < size; i++) {
+        if (stream_bytes == 0) {
+            if (stream_offset + 4 > stream_end) {
+                stream_ok = false;
+                return false;
+            }
+            stream_word = FlashMemory.readWord(stream_offset);
+            stream_offset += 4;
+        }
+        bytes[i] = (uint8_t)(stream_word >> (8 * stream_bytes));
+        stream_bytes = (stream_bytes + 1) & 3;
+    }
+    checkpoint_stream_sum(data, size);
+    return true;
+}
+
+// Size pass: runs the module writers without touching flash
+static void checkpoint_count_block(const void* data, uint32_t size) {
+    (void)data;
+    stream_size += size;
+}
+
+static void checkpoint_write_payload(checkpoint_write_t write, uint32_t now) {
+    class_counter_checkpoint_save(write, now);
+    motherboard_counter_checkpoint_save(write, now);
+    trigger_rules_checkpoint_save(write, now);
+}
+
+static bool checkpoint_read_payload(checkpoint_read_t read) {
+    return class_counter_checkpoint_restore(read) &&
+           motherboard_counter_checkpoint_restore(read) &&
+           trigger_rules_checkpoint_restore(read);
+}
+
+// The payload holds the module structs raw, so a build that moves or resizes
+// a field must not restore another build's bytes even at the same total size
+#define CHECKPOINT_FIELD(type, field)   offsetof(type, field), sizeof(type::field)
+
+static uint32_t checkpoint_layout() {
+    typedef class_counter_t<CLASS_MOTHERBOARD> counter_t;
+    typedef time_wheel_t<CLASS_COUNTER_SLOTS> counter_wheel_t;
+    typedef time_wheel_t<TRIGGER_WINDOW_SLOTS> rule_wheel_t;
+    const uint32_t fields[] = {
+        sizeof(counter_t), DETECTION_CLASS_COUNT, ROI_MAX_ZONES,
+        CHECKPOINT_FIELD(counter_t, wheel), CHECKPOINT_FIELD(counter_t, ewma),
+        CHECKPOINT_FIELD(counter_t, enabled), CHECKPOINT_FIELD(counter_t, mode),
+        CHECKPOINT_FIELD(counter_t, state), CHECKPOINT_FIELD(counter_t, count_threshold),
+        CHECKPOINT_FIELD(counter_t, clear_threshold), CHECKPOINT_FIELD(counter_t, cooldown_ms),
+        CHECKPOINT_FIELD(counter_t, total_detections), CHECKPOINT_FIELD(counter_t, triggers_sent),
+        CHECKPOINT_FIELD(counter_t, last_trigger_time), CHECKPOINT_FIELD(counter_t, state_time),
+        CHECKPOINT_FIELD(counter_t, peak_count), CHECKPOINT_FIELD(counter_t, last_duration_ms),
+        CHECKPOINT_FIELD(counter_wheel_t, counts), CHECKPOINT_FIELD(counter_wheel_t, slots),
+        CHECKPOINT_FIELD(counter_wheel_t, head), CHECKPOINT_FIELD(counter_wheel_t, start),
+        CHECKPOINT_FIELD(counter_wheel_t, width_ms), CHECKPOINT_FIELD(counter_wheel_t, window_ms),
+        CHECKPOINT_FIELD(counter_wheel_t, sum),
+        CHECKPOINT_FIELD(ewma_rate_t, rate), CHECKPOINT_FIELD(ewma_rate_t, last_ms),
+        CHECKPOINT_FIELD(ewma_rate_t, tau_ms),
+        sizeof(trigger_rule_state_t), TRIGGER_MAX_RULES,
+        CHECKPOINT_FIELD(trigger_rule_state_t, window), CHECKPOINT_FIELD(trigger_rule_state_t, last_seen_time),
+        CHECKPOINT_FIELD(trigger_rule_state_t, absent), CHECKPOINT_FIELD(trigger_rule_state_t, last_value),
+        CHECKPOINT_FIELD(trigger_rule_state_t, fire_count), CHECKPOINT_FIELD(trigger_rule_state_t, last_fire_time),
+        CHECKPOINT_FIELD(rule_wheel_t, counts), CHECKPOINT_FIELD(rule_wheel_t, start),
+        CHECKPOINT_FIELD(rule_wheel_t, sum)
+    };
+    return crc32(fields, sizeof(fields));
+}
+
+static uint32_t checkpoint_signature() {
+    return class_counter_checkpoint_signature() * 31 + trigger_rules_checkpoint_signature();
+}
+
+// ===== SLOT HELPERS =====
+static void checkpoint_read_header(uint8_t slot, checkpoint_header_t* header) {
+    uint32_t* words = (uint32_t*)header;
+    for (uint32_t i = 0; i < sizeof(checkpoint_header_t) / 4; i++) {
+        words[i] = FlashMemory.readWord(checkpoint_slot_offset(slot) + i * 4);
+    }
+}
+
+// Complete, from this build's layout, and with a matching payload checksum
+static bool checkpoint_slot_valid(uint8_t slot, checkpoint_header_t* header) {
+    checkpoint_read_header(slot, header);
+    if (header->magic != CHECKPOINT_MAGIC || header->version != CHECKPOINT_VERSION ||
+        header->layout != checkpoint_layout_signature || header->payload_size != checkpoint_payload_size) {
+        return false;
+    }
+
+    checkpoint_stream_open(slot);
+    uint8_t scratch[64];
+    for (uint32_t remaining = header->payload_size; remaining > 0;) {
+        uint32_t chunk = remaining < sizeof(scratch) ? remaining : sizeof(scratch);
+        if (!checkpoint_read_block(scratch, chunk)) {
+            return false;
+        }
+        remaining -= chunk;
+    }
+    return stream_checksum == header->checksum;
+}
+
+// Each save erases one slot, the slots take turns
+static void checkpoint_update_design_rate() {
+    uint32_t interval_s = system_config.checkpoint_interval_s;
+    checkpoint_area.design_erases_per_day = interval_s ? 86400.0f / interval_s / FLASH_CHECKPOINT_SLOTS : 0.0f;
+}
+
+// ===== CHECKPOINT INITIALIZATION =====
+void checkpoint_init() {
+    if (flash_is_initialized()) {
+        flash_wear_init(&checkpoint_area, "Checkpoint", FLASH_CHECKPOINT_OFFSET, FLASH_CHECKPOINT_SLOTS);
+        checkpoint_area.design_load = "a save every checkpoint_interval";
+        checkpoint_update_design_rate();
+    }
+    
+    stream_size = 0;
+    checkpoint_write_payload(checkpoint_count_block, millis());
+    checkpoint_payload_size = stream_size;
+    checkpoint_layout_signature = checkpoint_layout();
+    checkpoint_stats.words_per_save = (sizeof(checkpoint_header_t) + checkpoint_payload_size + 3) / 4;
+
+    if (checkpoint_stats.words_per_save * 4 > FLASH_SECTOR_DATA_SIZE) {
+        ERROR_PRINT("Checkpoint of " + String(checkpoint_stats.words_per_save * 4) + " bytes exceeds the " +
+                    String(FLASH_SECTOR_DATA_SIZE) + " byte slot, checkpoints disabled");
+        system_config.checkpoint_interval_s = 0;
+        return;
+    }
+    if (!flash_is_initialized() || system_config.checkpoint_interval_s == 0) {
+        INFO_PRINT("State checkpoints off");
+        return;
+    }
+
+    // Newest valid slot wins, sequence numbers compare wrap-safe
+    checkpoint_header_t headers[FLASH_CHECKPOINT_SLOTS];
+    int8_t newest = -1;
+    for (uint8_t slot = 0; slot < FLASH_CHECKPOINT_SLOTS; slot++) {
+        if (checkpoint_slot_valid(slot, &headers[slot]) &&
+            (newest < 0 || (int32_t)(headers[slot].sequence - headers[newest].sequence) > 0)) {
+            newest = slot;
+        }
+    }
+
+    if (newest < 0) {
+        INFO_PRINT("No state checkpoint in flash, counters start empty");
+        return;
+    }
+
+    const checkpoint_header_t* header = &headers[newest];
+    checkpoint_stream_open(newest);
+    if (!checkpoint_read_payload(checkpoint_read_block)) {
+        ERROR_PRINT("State checkpoint restore failed, counters start empty");
+        motherboard_counter_init();
+        trigger_rules_init();
+        return;
+    }
+
+    // Totals only persist with 'save' otherwise, keep whichever is ahead
+    if (header->total_detections > system_config.total_detections) {
+        system_config.total_detections = header->total_detections;
+    }
+    if (header->total_motherboard_count_triggers > system_config.total_motherboard_count_triggers) {
+        system_config.total_motherboard_count_triggers = header->total_motherboard_count_triggers;
+    }
+
+    checkpoint_slot = (newest + 1) % FLASH_CHECKPOINT_SLOTS;
+    checkpoint_stats.sequence = header->sequence;
+    checkpoint_stats.restored = true;
+    checkpoint_stats.restored_sequence = header->sequence;
+    checkpoint_stats.restored_uptime_s = header->uptime_s;
+    checkpoint_last_signature = checkpoint_signature();
+
+    INFO_PRINT("Counters restored from checkpoint #" + String(header->sequence) + " (at " +
+               String(header->uptime_s) + "s of the previous run), MB window " +
+               String(motherboard_counter_get_count_in_window()));
+}
+
+// ===== CHECKPOINT OPERATIONS =====
+void checkpoint_process() {
+    uint32_t interval_ms = (uint32_t)system_config.checkpoint_interval_s * 1000;
+    if (interval_ms == 0 || !flash_is_initialized()) {
+        return;
+    }
+
+    uint32_t now = millis();
+    if (now - checkpoint_last_check < interval_ms) {
+        return;
+    }
+    checkpoint_last_check = now;
+
+    // Time alone moves no state that a restore cannot rebuild
+    if (checkpoint_signature() == checkpoint_last_signature) {
+        checkpoint_stats.skipped++;
+        return;
+    }
+    checkpoint_save();
+}
+
+flash_result_t checkpoint_save() {
+    if (!flash_is_initialized() || checkpoint_area.sectors == 0 || system_config.checkpoint_interval_s == 0) {
+        return FLASH_ERROR_INIT;
+    }
+
+    uint32_t start_us = micros();
+    uint32_t now = millis();
+    uint32_t base = checkpoint_slot_offset(checkpoint_slot);
+
+    // Erasing invalidates the slot, the previous one stays the newest until we finish
+    flash_wear_erase(&checkpoint_area, checkpoint_slot, CHECKPOINT_TAG, checkpoint_stats.sequence + 1);
+
+    checkpoint_stream_open(checkpoint_slot);
+    checkpoint_write_payload(checkpoint_write_block, now);
+    checkpoint_write_flush();
+    if (!stream_ok || stream_size != checkpoint_payload_size) {
+        ERROR_PRINT("State checkpoint write failed");
+        return FLASH_ERROR_WRITE;
+    }
+
+    checkpoint_header_t header = {
+        .magic = CHECKPOINT_MAGIC,
+        .version = CHECKPOINT_VERSION,
+        .layout = checkpoint_layout_signature,
+        .sequence = checkpoint_stats.sequence + 1,
+        .payload_size = stream_size,
+        .checksum = stream_checksum,
+        .uptime_s = now / 1000,
+        .total_detections = system_config.total_detections,
+        .total_motherboard_count_triggers = system_config.total_motherboard_count_triggers
+    };
+    uint32_t* words = (uint32_t*)&header;
+    for (uint32_t i = 1; i < sizeof(checkpoint_header_t) / 4; i++) {
+        FlashMemory.writeWord(base + i * 4, words[i]);
+    }
+    FlashMemory.writeWord(base, header.magic);
+
+    if (FlashMemory.readWord(base) != CHECKPOINT_MAGIC) {
+        ERROR_PRINT("State checkpoint verification failed");
+        return FLASH_ERROR_VERIFY;
+    }
+
+    checkpoint_slot = (checkpoint_slot + 1) % FLASH_CHECKPOINT_SLOTS;
+    checkpoint_last_signature = checkpoint_signature();
+    checkpoint_stats.saves++;
+    checkpoint_stats.sequence = header.sequence;
+    checkpoint_stats.last_save_time = now;
+    checkpoint_stats.last_duration_us = micros() - start_us;
+    if (checkpoint_stats.last_duration_us > checkpoint_stats.max_duration_us) {
+        checkpoint_stats.max_duration_us = checkpoint_stats.last_duration_us;
+    }
+
+    DEBUG_PRINT(3, "State checkpoint #" + String(header.sequence) + " written in " +
+                   String(checkpoint_stats.last_duration_us) + "us");
+    return FLASH_SUCCESS;
+}
+
+flash_result_t checkpoint_clear() {
+    if (!flash_is_initialized() || checkpoint_area.sectors == 0) {
+        return FLASH_ERROR_INIT;
+    }
+
+    // Zero bits program without an erase
+    for (uint8_t slot = 0; slot < FLASH_CHECKPOINT_SLOTS; slot++) {
+        FlashMemory.writeWord(checkpoint_slot_offset(slot), 0);
+    }
+
+    INFO_PRINT("State checkpoints cleared");
+    return FLASH_SUCCESS;
+}
+
+bool checkpoint_set_interval(uint32_t interval_s) {
+    if (interval_s != 0 && (interval_s < CHECKPOINT_MIN_INTERVAL || interval_s > UINT16_MAX)) {
+        return false;
+    }
+
+    system_config.checkpoint_interval_s = interval_s;
+    checkpoint_update_design_rate();
+    return true;
+}
+
+const checkpoint_stats_t* checkpoint_get_stats() {
+    return &checkpoint_stats;
+}
+
+void checkpoint_print_status() {
+    const checkpoint_stats_t* stats = &checkpoint_stats;
+    uint32_t interval_s = system_config.checkpoint_interval_s;
+
+    Serial.println("\n=== STATE CHECKPOINT ===");
+    Serial.println("Interval: " + (interval_s ? String(interval_s) + "s, only when counters changed" : String("OFF")));
+    Serial.println("Size: " + String(stats->words_per_save) + " words (" + String(stats->words_per_save * 4) +
+                   " of " + String(FLASH_SECTOR_DATA_SIZE) + " bytes per slot)");
+    Serial.println("Saves: " + String(stats->saves) + ", skipped unchanged: " + String(stats->skipped) +
+                   (stats->saves ? ", last " + String((millis() - stats->last_save_time) / 1000) + "s ago"
+                                 : String("")));
+    Serial.println("Write Time: last " + String(stats->last_duration_us) + "us, max " +
+                   String(stats->max_duration_us) + "us");
+    if (interval_s) {
+        uint32_t per_day = 86400 / interval_s;
+        Serial.println("Flash Load: at most " + String(per_day) + " saves/day, " +
+                       String((per_day + FLASH_CHECKPOINT_SLOTS - 1) / FLASH_CHECKPOINT_SLOTS) + " erases per slot, " +
+                       String(per_day * stats->words_per_save) + " words/day");
+    }
+    if (checkpoint_area.sectors) {
+        flash_wear_print(&checkpoint_area);
+    }
+    Serial.println("Sequence: #" + String(stats->sequence) + ", next slot " + String(checkpoint_slot));
+    if (stats->restored) {
+        Serial.println("Restored: #" + String(stats->restored_sequence) + " from " +
+                       String(stats->restored_uptime_s) + "s of the previous run");
+    } else {
+        Serial.println("Restored: No");
+    }
+    Serial.println("========================\n");
+}
@@ -0,0 +1,42 @@
+// state_checkpoint.h - Counter and Trigger State Checkpoints
+#ifndef STATE_CHECKPOINT_H
+#define STATE_CHECKPOINT_H
+
+#include "config.h"
+#include "amb82_flash.h"
+
+// Class counters, zone counters and trigger rules are written to flash every
+// checkpoint_interval_s seconds (only if anything changed) and before planned
+// resets, and restored at boot, so a reboot mid-burst keeps the window.
+//
+// FLASH_CHECKPOINT_SLOTS sectors at FLASH_CHECKPOINT_OFFSET take turns
+// (flash_wear.h). A slot is erased first and its header written last, so a
+// reset during a write leaves the previous slot as the newest valid
+// checkpoint. Times are stored relative to the checkpoint; a restore treats
+// the downtime as the boot time of the new run (there is no RTC), so windows
+// drift by that much at most.
+
+// ===== CHECKPOINT STATISTICS =====
+typedef struct {
+    uint32_t saves;
+    uint32_t skipped;               // Interval elapsed but nothing changed
+    uint32_t sequence;              // Of the newest checkpoint in flash
+    uint32_t words_per_save;        // Header + payload, fixed by the build
+    uint32_t last_save_time;        // millis()
+    uint32_t last_duration_us;
+    uint32_t max_duration_us;
+    bool restored;                  // Counters came from a checkpoint at boot
+    uint32_t restored_sequence;
+    uint32_t restored_uptime_s;     // Uptime of the previous run at that checkpoint
+} checkpoint_stats_t;
+
+// ===== CHECKPOINT OPERATIONS =====
+void checkpoint_init();             // Restore; after the counters and rules are initialized
+void checkpoint_process();          // Main loop
+flash_result_t checkpoint_save();   // Now, regardless of interval and changes
+flash_result_t checkpoint_clear();  // Invalidate every slot
+bool checkpoint_set_interval(uint32_t interval_s);   // 0 = off, else >= CHECKPOINT_MIN_INTERVAL
+const checkpoint_stats_t* checkpoint_get_stats();
+void checkpoint_print_status();
+
+#endif // STATE_CHECKPOINT_H
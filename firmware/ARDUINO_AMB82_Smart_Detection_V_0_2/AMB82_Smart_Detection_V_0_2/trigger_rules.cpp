@@ -0,0 +1,397 @@
+// trigger_rules.cpp - Configurable Detection Trigger Rules Implementation
+#include "trigger_rules.h"
+#include "detection_manager.h"
+#include "lora_rak3172.h"
+
+// ===== GLOBAL VARIABLES =====
+static trigger_rule_state_t rule_states[TRIGGER_MAX_RULES];
+static uint8_t rule_enabled_mask = 0;
+static uint8_t rule_absence_mask = 0;
+
+// ===== RULE HELPERS =====
+static bool rule_cooldown_elapsed(const trigger_rule_config_t* cfg, const trigger_rule_state_t* state,
+                                  uint32_t now) {
+    return state->fire_count == 0 || now - state->last_fire_time >= (uint32_t)cfg->cooldown_s * 1000;
+}
+
+static void rule_fired(uint8_t rule, uint32_t now) {
+    trigger_rule_state_t* state = &rule_states[rule];
+    state->fire_count++;
+    state->last_fire_time = now;
+}
+
+// COUNT compares the window count, RATE the count per minute of window.
+// Both only grow on a detection, so this is the only place they can fire.
+static bool rule_evaluate_window(uint8_t rule, uint32_t now) {
+    const trigger_rule_config_t* cfg = &system_config.trigger_rules[rule];
+    trigger_rule_state_t* state = &rule_states[rule];
+
+    uint32_t count = state->window.count(now);
+    bool reached;
+    if (cfg->aggregation == TRIGGER_AGG_RATE) {
+        state->last_value = (uint32_t)((uint64_t)count * 60 / cfg->window_s);
+        reached = (uint64_t)count * 60 >= (uint64_t)cfg->threshold * cfg->window_s;
+    } else {
+        state->last_value = count;
+        reached = count >= cfg->threshold;
+    }
+
+    if (!reached) {
+        return false;
+    }
+    if (!rule_cooldown_elapsed(cfg, state, now)) {
+        DEBUG_PRINT(3, "Rule " + String(rule) + " suppressed (cooldown)");
+        return false;
+    }
+    rule_fired(rule, now);
+    return true;
+}
+
+// ===== RULE INITIALIZATION =====
+void trigger_rules_init() {
+    memset(rule_states, 0, sizeof(rule_states));
+    rule_enabled_mask = 0;
+    trigger_rules_configure();
+    INFO_PRINT("Trigger rules initialized (" + String(trigger_rules_active() ? "active" : "none enabled") + ")");
+}
+
+void trigger_rules_configure() {
+    uint32_t now = millis();
+    uint8_t was_enabled = rule_enabled_mask;
+    rule_enabled_mask = 0;
+    rule_absence_mask = 0;
+
+    for (uint8_t rule = 0; rule < TRIGGER_MAX_RULES; rule++) {
+        const trigger_rule_config_t* cfg = &system_config.trigger_rules[rule];
+        trigger_rule_state_t* state = &rule_states[rule];
+
+        if (!cfg->enabled || cfg->window_s == 0) {
+            continue;
+        }
+        rule_enabled_mask |= (1 << rule);
+
+        // A rule coming up starts from an empty window and a fresh silence
+        bool fresh = !(was_enabled & (1 << rule));
+        if (fresh) {
+            state->window.clear(now);
+            state->last_seen_time = now;
+            state->absent = false;
+            state->last_value = 0;
+            state->fire_count = 0;
+            state->last_fire_time = 0;
+        }
+
+        if (cfg->aggregation == TRIGGER_AGG_ABSENCE) {
+            rule_absence_mask |= (1 << rule);
+        } else {
+            state->window.configure((uint32_t)cfg->window_s * 1000, 0, now);
+        }
+    }
+}
+
+bool trigger_rules_active() {
+    return rule_enabled_mask != 0;
+}
+
+// ===== RULE EVALUATION =====
+uint8_t trigger_rules_on_detection(uint8_t object_class, uint32_t timestamp) {
+    if (!rule_enabled_mask) {
+        return 0;
+    }
+
+    uint32_t now = millis();
+    uint8_t fired = 0;
+
+    for (uint8_t rule = 0; rule < TRIGGER_MAX_RULES; rule++) {
+        if (!(rule_enabled_mask & (1 << rule)) || system_config.trigger_rules[rule].object_class != object_class) {
+            continue;
+        }
+
+        trigger_rule_state_t* state = &rule_states[rule];
+        if (rule_absence_mask & (1 << rule)) {
+            // Seen again, the next silence may fire
+            state->last_seen_time = timestamp;
+            state->absent = false;
+            state->last_value = 0;
+            continue;
+        }
+
+        state->window.add(timestamp);
+        if (rule_evaluate_window(rule, now)) {
+            fired |= (1 << rule);
+        }
+    }
+
+    return fired;
+}
+
+void trigger_rules_process() {
+    if (!rule_absence_mask) {
+        return;
+    }
+
+    uint32_t now = millis();
+    for (uint8_t rule = 0; rule < TRIGGER_MAX_RULES; rule++) {
+        if (!(rule_absence_mask & (1 << rule))) {
+            continue;
+        }
+
+        const trigger_rule_config_t* cfg = &system_config.trigger_rules[rule];
+        trigger_rule_state_t* state = &rule_states[rule];
+
+        // Frame timestamps can run slightly ahead of the loop's millis()
+        uint32_t silence = (int32_t)(now - state->last_seen_time) > 0 ? now - state->last_seen_time : 0;
+        state->last_value = silence / 1000;
+
+        if (state->absent || silence < (uint32_t)cfg->window_s * 1000 || !rule_cooldown_elapsed(cfg, state, now)) {
+            continue;
+        }
+
+        state->absent = true;
+        rule_fired(rule, now);
+        if (system_config.debug_level >= 2) {
+            Serial.print("[INFO] 🚨 RULE ");
+            Serial.print(rule);
+            Serial.print(" TRIGGER: no ");
+            Serial.print(detection_class_to_string(cfg->object_class));
+            Serial.print(" for ");
+            Serial.print(state->last_value);
+            Serial.println("s");
+        }
+        trigger_rules_run_actions(rule);
+    }
+}
+
+void trigger_rules_run_actions(uint8_t rule) {
+    if (rule >= TRIGGER_MAX_RULES) {
+        return;
+    }
+
+    const trigger_rule_config_t* cfg = &system_config.trigger_rules[rule];
+    const trigger_rule_state_t* state = &rule_states[rule];
+
+    if (cfg->aggregation != TRIGGER_AGG_ABSENCE) {
+        if (system_config.debug_level >= 2) {
+            Serial.print("[INFO] 🚨 RULE ");
+            Serial.print(rule);
+            Serial.print(" TRIGGER: ");
+            Serial.print(detection_class_to_string(cfg->object_class));
+            Serial.print(" ");
+            Serial.print(trigger_aggregation_to_string((trigger_aggregation_t)cfg->aggregation));
+            Serial.print(" ");
+            Serial.print(state->last_value);
+            Serial.print(" >= ");
+            Serial.println(cfg->threshold);
+        }
+    }
+
+    if ((cfg->actions & TRIGGER_ACTION_LORA) && lora_is_initialized()) {
+        // Format: RT,<rule>,<class>,<value>,<threshold or absence seconds>
+        static_assert(TRIGGER_MAX_RULES <= 10 && DETECTION_CLASS_COUNT <= 10, "RT rule and class must be one digit");
+        static_assert(LORA_MESSAGE_FITS("RT,9,9,65535,65535"), "RT uplink exceeds the LoRa payload limit");
+        char message_buffer[LORA_MAX_PAYLOAD_SIZE];
+        snprintf(message_buffer, sizeof(message_buffer),
+                 "RT,%u,%u,%u,%u",
+                 (unsigned)rule,
+                 (unsigned)cfg->object_class,
+                 (unsigned)lora_saturate_u16(state->last_value),
+                 (unsigned)(cfg->aggregation == TRIGGER_AGG_ABSENCE ? cfg->window_s : cfg->threshold));
+
+        lora_result_t result = lora_send_message((lora_message_type_t)cfg->lora_type, message_buffer);
+
+        if (result == LORA_SUCCESS) {
+            if (system_config.debug_level >= 2) {
+                Serial.print("[INFO] [LoRa] Rule trigger sent: ");
+                Serial.println(message_buffer);
+            }
+        } else {
+            ERROR_PRINT("[LoRa] Rule trigger failed: " + String(lora_result_to_string(result)));
+        }
+    }
+    if (cfg->actions & TRIGGER_ACTION_LED) {
+        gpio_status_led_set_pattern(cfg->led_pattern);
+    }
+    if (cfg->actions & TRIGGER_ACTION_LASER) {
+        gpio_laser_force_on();
+    }
+}
+
+// ===== RULE CONFIGURATION =====
+trigger_result_t trigger_rules_set(uint8_t rule, const trigger_rule_config_t* config) {
+    if (rule >= TRIGGER_MAX_RULES || !config) {
+        return TRIGGER_ERROR_INVALID_RULE;
+    }
+    if (config->object_class >= DETECTION_CLASS_COUNT) {
+        return TRIGGER_ERROR_INVALID_CLASS;
+    }
+    if (config->aggregation >= TRIGGER_AGG_COUNT_TYPES) {
+        return TRIGGER_ERROR_INVALID_AGGREGATION;
+    }
+    if (config->window_s == 0) {
+        return TRIGGER_ERROR_INVALID_WINDOW;
+    }
+    if (config->aggregation != TRIGGER_AGG_ABSENCE && config->threshold == 0) {
+        return TRIGGER_ERROR_INVALID_THRESHOLD;
+    }
+
+    // Any change of what the rule measures starts it over
+    trigger_rule_config_t* cfg = &system_config.trigger_rules[rule];
+    if (cfg->object_class != config->object_class || cfg->aggregation != config->aggregation ||
+        cfg->window_s != config->window_s) {
+        cfg->enabled = 0;
+        trigger_rules_configure();
+    }
+
+    *cfg = *config;
+    cfg->enabled = 1;
+    trigger_rules_configure();
+
+    INFO_PRINT("Rule " + String(rule) + " set: " + String(detection_class_to_string(cfg->object_class)) + " " +
+               String(trigger_aggregation_to_string((trigger_aggregation_t)cfg->aggregation)) + ", window " +
+               String(cfg->window_s) + "s");
+    return TRIGGER_SUCCESS;
+}
+
+trigger_result_t trigger_rules_disable(uint8_t rule) {
+    if (rule >= TRIGGER_MAX_RULES) {
+        return TRIGGER_ERROR_INVALID_RULE;
+    }
+
+    system_config.trigger_rules[rule].enabled = 0;
+    trigger_rules_configure();
+    INFO_PRINT("Rule " + String(rule) + " disabled");
+    return TRIGGER_SUCCESS;
+}
+
+// ===== RULE STATISTICS =====
+void trigger_rules_get_state(uint8_t rule, trigger_rule_state_t* state) {
+    if (rule < TRIGGER_MAX_RULES && state) {
+        *state = rule_states[rule];
+    }
+}
+
+void trigger_rules_reset() {
+    // Dropping the enabled mask makes every rule come up fresh
+    rule_enabled_mask = 0;
+    trigger_rules_configure();
+}
+
+void trigger_rules_print_status() {
+    Serial.println("\n=== TRIGGER RULES ===");
+    uint32_t now = millis();
+
+    for (uint8_t rule = 0; rule < TRIGGER_MAX_RULES; rule++) {
+        const trigger_rule_config_t* cfg = &system_config.trigger_rules[rule];
+        trigger_rule_state_t* state = &rule_states[rule];
+        if (!(rule_enabled_mask & (1 << rule))) {
+            Serial.println("Rule " + String(rule) + ": OFF");
+            continue;
+        }
+
+        String line = "Rule " + String(rule) + ": " + String(detection_class_to_string(cfg->object_class)) + " " +
+                      String(trigger_aggregation_to_string((trigger_aggregation_t)cfg->aggregation));
+        if (cfg->aggregation == TRIGGER_AGG_ABSENCE) {
+            line += " for " + String(cfg->window_s) + "s, silent " + String(state->last_value) + "s";
+        } else {
+            if (cfg->aggregation == TRIGGER_AGG_RATE) {
+                state->last_value = (uint32_t)((uint64_t)state->window.count(now) * 60 / cfg->window_s);
+            } else {
+                state->last_value = state->window.count(now);
+            }
+            line += " " + String(state->last_value) + "/" + String(cfg->threshold) +
+                    (cfg->aggregation == TRIGGER_AGG_RATE ? String(" per min") : String("")) +
+                    " in " + String(cfg->window_s) + "s";
+        }
+        line += ", cooldown " + String(cfg->cooldown_s) + "s, actions";
+        if (cfg->actions & TRIGGER_ACTION_LORA) {
+            line += " lora:" + String(cfg->lora_type);
+        }
+        if (cfg->actions & TRIGGER_ACTION_LED) {
+            line += " led:" + String(cfg->led_pattern);
+        }
+        if (cfg->actions & TRIGGER_ACTION_LASER) {
+            line += " laser";
+        }
+        if (!cfg->actions) {
+            line += " none";
+        }
+        line += ", fired " + String(state->fire_count) + "x";
+        if (state->fire_count) {
+            line += " (last " + String((now - state->last_fire_time) / 1000) + "s ago)";
+        }
+        Serial.println(line);
+    }
+    Serial.println("=====================\n");
+}
+
+const char* trigger_aggregation_to_string(trigger_aggregation_t aggregation) {
+    switch (aggregation) {
+        case TRIGGER_AGG_COUNT: return "COUNT";
+        case TRIGGER_AGG_RATE: return "RATE";
+        case TRIGGER_AGG_ABSENCE: return "ABSENCE";
+        default: return "UNKNOWN";
+    }
+}
+
+trigger_aggregation_t trigger_string_to_aggregation(const char* name) {
+    for (uint8_t i = 0; name && i < TRIGGER_AGG_COUNT_TYPES; i++) {
+        if (strcasecmp(name, trigger_aggregation_to_string((trigger_aggregation_t)i)) == 0) {
+            return (trigger_aggregation_t)i;
+        }
+    }
+    return TRIGGER_AGG_COUNT_TYPES;
+}
+
+const char* trigger_result_to_string(trigger_result_t result) {
+    switch (result) {
+        case TRIGGER_SUCCESS: return "SUCCESS";
+        case TRIGGER_ERROR_INVALID_RULE: return "INVALID_RULE";
+        case TRIGGER_ERROR_INVALID_CLASS: return "INVALID_CLASS";
+        case TRIGGER_ERROR_INVALID_AGGREGATION: return "INVALID_AGGREGATION";
+        case TRIGGER_ERROR_INVALID_WINDOW: return "INVALID_WINDOW";
+        case TRIGGER_ERROR_INVALID_THRESHOLD: return "INVALID_THRESHOLD";
+        default: return "UNKNOWN_ERROR";
+    }
+}
+
+// ===== CHECKPOINT =====
+void trigger_rules_checkpoint_save(checkpoint_write_t write, uint32_t now) {
+    for (uint8_t rule = 0; rule < TRIGGER_MAX_RULES; rule++) {
+        trigger_rule_state_t snapshot = rule_states[rule];
+        snapshot.window.rebase(now, 0);
+        snapshot.last_seen_time -= now;
+        snapshot.last_fire_time -= now;
+        write(&snapshot, sizeof(snapshot));
+    }
+}
+
+bool trigger_rules_checkpoint_restore(checkpoint_read_t read) {
+    uint32_t now = millis();
+
+    for (uint8_t rule = 0; rule < TRIGGER_MAX_RULES; rule++) {
+        trigger_rule_state_t snapshot;
+        if (!read(&snapshot, sizeof(snapshot))) {
+            return false;
+        }
+        if (!(rule_enabled_mask & (1 << rule))) {
+            continue;
+        }
+
+        const trigger_rule_config_t* cfg = &system_config.trigger_rules[rule];
+        rule_states[rule] = snapshot;
+        if (!(rule_absence_mask & (1 << rule))) {
+            // A rule whose window changed since the checkpoint starts it over
+            rule_states[rule].window.configure((uint32_t)cfg->window_s * 1000, 0, now);
+        }
+    }
+    return true;
+}
+
+uint32_t trigger_rules_checkpoint_signature() {
+    uint32_t signature = 0;
+    for (uint8_t rule = 0; rule < TRIGGER_MAX_RULES; rule++) {
+        signature = signature * 31 + rule_states[rule].fire_count;
+        signature = signature * 31 + rule_states[rule].absent;
+    }
+    return signature;
+}
@@ -0,0 +1,88 @@
+// trigger_rules.h - Configurable Detection Trigger Rules
+#ifndef TRIGGER_RULES_H
+#define TRIGGER_RULES_H
+
+#include "config.h"
+#include "amb82_gpio.h"
+#include "class_counter.h"
+
+// Up to TRIGGER_MAX_RULES rules, persisted in system_config next to the
+// motherboard counter settings. Each rule watches one class:
+//   COUNT    fires at threshold detections within window_s
+//   RATE     fires at threshold detections per minute, averaged over window_s
+//   ABSENCE  fires once no detection has been seen for window_s
+// COUNT and RATE rules keep their own time wheel (time_wheel_t in
+// class_counter.h), so every detection event costs one slot update and one
+// comparison per rule and history is never rescanned. ABSENCE rules only
+// keep the time of the last detection and are checked from the main loop.
+
+// ===== RULE AGGREGATIONS =====
+typedef enum {
+    TRIGGER_AGG_COUNT = 0,
+    TRIGGER_AGG_RATE,
+    TRIGGER_AGG_ABSENCE,
+    TRIGGER_AGG_COUNT_TYPES
+} trigger_aggregation_t;
+
+// ===== RULE ACTIONS =====
+#define TRIGGER_ACTION_LORA     0x01    // RT uplink with the rule's lora_type
+#define TRIGGER_ACTION_LED      0x02    // Status LED to the rule's led_pattern
+#define TRIGGER_ACTION_LASER    0x04    // Crosshair laser on until the next detection
+
+#define TRIGGER_DEFAULT_LORA_TYPE       LORA_MSG_ALERT
+#define TRIGGER_DEFAULT_LED_PATTERN     LED_PATTERN_TRIPLE_BLINK
+
+#define TRIGGER_WINDOW_SLOTS    64      // Resolution is window_s / 64
+
+// ===== RULE OPERATION RESULTS =====
+typedef enum {
+    TRIGGER_SUCCESS = 0,
+    TRIGGER_ERROR_INVALID_RULE,
+    TRIGGER_ERROR_INVALID_CLASS,
+    TRIGGER_ERROR_INVALID_AGGREGATION,
+    TRIGGER_ERROR_INVALID_WINDOW,
+    TRIGGER_ERROR_INVALID_THRESHOLD
+} trigger_result_t;
+
+// ===== RULE STATE =====
+typedef struct {
+    time_wheel_t<TRIGGER_WINDOW_SLOTS> window;     // COUNT and RATE
+    uint32_t last_seen_time;        // ABSENCE: millis() of the last detection
+    bool absent;                    // ABSENCE: fired for the current silence
+    uint32_t last_value;            // Count, rate or silence seconds at last evaluation
+    uint32_t fire_count;
+    uint32_t last_fire_time;
+} trigger_rule_state_t;
+
+// ===== RULE OPERATIONS =====
+void trigger_rules_init();
+void trigger_rules_configure();     // Re-read system_config after changes
+bool trigger_rules_active();        // At least one rule enabled
+
+// One pass over the rules for a detection event. Returns bit n set when
+// rule n fired; the caller runs trigger_rules_run_actions() for each.
+uint8_t trigger_rules_on_detection(uint8_t object_class, uint32_t timestamp);
+void trigger_rules_run_actions(uint8_t rule);
+
+// Main loop: ABSENCE rules fire here, and run their own actions
+void trigger_rules_process();
+
+// ===== RULE CONFIGURATION =====
+trigger_result_t trigger_rules_set(uint8_t rule, const trigger_rule_config_t* config);
+trigger_result_t trigger_rules_disable(uint8_t rule);
+
+// ===== RULE STATISTICS =====
+void trigger_rules_get_state(uint8_t rule, trigger_rule_state_t* state);
+void trigger_rules_reset();
+void trigger_rules_print_status();
+
+// ===== CHECKPOINT =====
+// Rule windows and fire state, times rebased as in class_counter_checkpoint_save
+void trigger_rules_checkpoint_save(checkpoint_write_t write, uint32_t now);
+bool trigger_rules_checkpoint_restore(checkpoint_read_t read);
+uint32_t trigger_rules_checkpoint_signature();
+const char* trigger_aggregation_to_string(trigger_aggregation_t aggregation);
+trigger_aggregation_t trigger_string_to_aggregation(const char* name);
+const char* trigger_result_to_string(trigger_result_t result);
+
+#endif // TRIGGER_RULES_H
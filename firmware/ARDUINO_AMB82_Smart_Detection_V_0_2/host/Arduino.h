@@ -0,0 +1,151 @@
+// Arduino.h - Host Build Stand-in for the AMB82 Arduino Core
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Just enough of the Arduino API for the sketch modules on the detection path
+// to compile and run on Linux. Time is virtual: millis() returns the replay
+// clock and delay() advances it, so blocking code (LoRa AT waits) costs no
+// wall time. micros() is the real monotonic clock so per-stage cost is
+// measured in host CPU time.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+// ===== ARDUINO CONSTANTS =====
+#define HIGH            1
+#define LOW             0
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+#define DEC             10
+#define HEX             16
+#define LED_BUILTIN     23
+
+using std::min;
+using std::max;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ===== STRING =====
+class String {
+public:
+    String() {}
+    String(const char* s) : str(s ? s : "") {}
+    String(const std::string& s) : str(s) {}
+    String(char c) : str(1, c) {}
+    String(unsigned char v, int base = DEC) { format_unsigned(v, base); }
+    String(int v, int base = DEC) { format_signed(v, base); }
+    String(unsigned int v, int base = DEC) { format_unsigned(v, base); }
+    String(long v, int base = DEC) { format_signed(v, base); }
+    String(unsigned long v, int base = DEC) { format_unsigned(v, base); }
+    String(long long v, int base = DEC) { format_signed(v, base); }
+    String(unsigned long long v, int base = DEC) { format_unsigned(v, base); }
+    String(float v, int decimals = 2) { format_float(v, decimals); }
+    String(double v, int decimals = 2) { format_float(v, decimals); }
+
+    const char* c_str() const { return str.c_str(); }
+    unsigned int length() const { return (unsigned int)str.size(); }
+    void reserve(unsigned int size) { str.reserve(size); }
+    bool equals(const String& s) const { return str == s.str; }
+    int indexOf(char c, unsigned int from = 0) const { return find_result(str.find(c, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return find_result(str.find(s.str, from)); }
+    String substring(unsigned int from) const { return from < str.size() ? String(str.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < to && from < str.size() ? String(str.substr(from, to - from)) : String();
+    }
+    long toInt() const { return strtol(str.c_str(), NULL, 10); }
+    float toFloat() const { return strtof(str.c_str(), NULL); }
+    void trim() {
+        size_t b = str.find_first_not_of(" \t\r\n");
+        size_t e = str.find_last_not_of(" \t\r\n");
+        str = (b == std::string::npos) ? std::string() : str.substr(b, e - b + 1);
+    }
+    char operator[](unsigned int i) const { return i < str.size() ? str[i] : 0; }
+    bool operator==(const String& s) const { return str == s.str; }
+    bool operator!=(const String& s) const { return str != s.str; }
+    String& operator+=(const String& s) { str += s.str; return *this; }
+    String& operator+=(const char* s) { str += s ? s : ""; return *this; }
+    String& operator+=(char c) { str += c; return *this; }
+
+    friend String operator+(const String& a, const String& b) { return String(a.str + b.str); }
+    friend String operator+(const String& a, const char* b) { return String(a.str + (b ? b : "")); }
+    friend String operator+(const char* a, const String& b) { return String((a ? a : "") + b.str); }
+
+private:
+    std::string str;
+
+    static int find_result(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+    void format_signed(long long v, int base) {
+        if (base == DEC || v >= 0) {
+            char buf[24];
+            snprintf(buf, sizeof(buf), "%lld", v);
+            str = buf;
+        } else {
+            format_unsigned((unsigned long long)v, base);
+        }
+    }
+    void format_unsigned(unsigned long long v, int base) {
+        char buf[24];
+        snprintf(buf, sizeof(buf), base == HEX ? "%llX" : "%llu", v);
+        str = buf;
+    }
+    void format_float(double v, int decimals) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        str = buf;
+    }
+};
+
+// ===== SERIAL =====
+// Serial prints to stdout (see host_serial_set_echo), Serial1 is wired to an
+// emulated RAK3172 that answers every AT command with OK
+class HardwareSerial {
+public:
+    virtual ~HardwareSerial() {}
+    virtual void begin(unsigned long baud) { (void)baud; }
+    virtual int available() { return 0; }
+    virtual int read() { return -1; }
+    virtual void flush() {}
+    virtual size_t write(const char* data, size_t length) = 0;
+    operator bool() const { return true; }
+
+    size_t print(const String& s) { return write(s.c_str(), s.length()); }
+    size_t print(const char* s) { return write(s, strlen(s)); }
+    size_t print(char c) { return write(&c, 1); }
+    template <typename T> size_t print(T v) { return print(String(v)); }
+    template <typename T> size_t print(T v, int format) { return print(String(v, format)); }
+
+    size_t println() { return write("\r\n", 2); }
+    template <typename T> size_t println(const T& v) { return print(v) + println(); }
+    template <typename T> size_t println(T v, int format) { return print(v, format) + println(); }
+};
+
+extern HardwareSerial& Serial;
+extern HardwareSerial& Serial1;
+
+// ===== TIME AND GPIO =====
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+int digitalRead(int pin);
+void NVIC_SystemReset();
+
+// ===== HOST CONTROL =====
+typedef void (*host_lora_uplink_t)(const char* payload, uint32_t time_ms);
+
+void host_clock_set(uint32_t ms);           // Never moves the clock backwards
+void host_clock_reset(uint32_t ms);         // Jump anywhere, for benchmarks
+void host_serial_set_echo(bool echo);       // Serial output to stdout
+void host_lora_set_uplink(host_lora_uplink_t callback);    // Decoded AT+SEND payloads
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,173 @@
+// FlashMemory.h - Host Build Stand-in for the AMB82 FlashMemory Library
+#ifndef HOST_FLASH_MEMORY_H
+#define HOST_FLASH_MEMORY_H
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Word access to an image of the application flash area, erased (0xFF) at
+// start. Offsets are relative to the base passed to begin(). Writes follow
+// NOR flash: programming only clears bits, so a word holds the AND of
+// everything written to it since its sector was erased, and only
+// eraseSector() sets bits again. A write that would need an erase (a 0 bit
+// back to 1) is counted in words_reprogrammed. program_us and erase_us, 0 by
+// default, spin per word written and sector erased so write costs show up in
+// micros() like on the target.
+//
+// attach() backs the image with a file mapped shared: it is loaded (or
+// created erased) and every write lands in the file, so killing the process
+// leaves the file as a reset would leave the flash.
+//
+// Power loss: with power_loss_at set, flash operation number power_loss_at
+// (writes and erases since reset_counters(), from 1) is cut short - a write
+// programs only its low half-word, as SPI NOR programs a word's bytes lowest
+// address first, an erase only erases the first half of the sector - and
+// power_loss() is called, by default ending the process with
+// HOST_FLASH_POWER_LOSS_EXIT.
+
+#define FLASH_MEMORY_APP_BASE       0xFD0000
+#define HOST_FLASH_IMAGE_SIZE       0x30000     // To the end of the 16MB flash
+#define HOST_FLASH_SECTOR_SIZE      0x1000
+#define HOST_FLASH_SECTORS          (HOST_FLASH_IMAGE_SIZE / HOST_FLASH_SECTOR_SIZE)
+#define HOST_FLASH_POWER_LOSS_EXIT  86
+
+class FlashMemoryClass {
+public:
+    FlashMemoryClass() { memset(ram_image, 0xFF, sizeof(ram_image)); }
+    ~FlashMemoryClass() { detach(); }
+
+    void begin(unsigned int flash_base_address, unsigned int flash_size) {
+        base_address = flash_base_address;
+        (void)flash_size;
+    }
+
+    bool attach(const char* path) {
+        detach();
+        int fd = open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            return false;
+        }
+
+        // A new or short file is extended erased
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size < HOST_FLASH_IMAGE_SIZE) {
+            static unsigned char erased[HOST_FLASH_SECTOR_SIZE];
+            memset(erased, 0xFF, sizeof(erased));
+            off_t size = info.st_size;
+            while (size < HOST_FLASH_IMAGE_SIZE) {
+                size_t length = min((size_t)(HOST_FLASH_IMAGE_SIZE - size), sizeof(erased));
+                if (pwrite(fd, erased, length, size) != (ssize_t)length) {
+                    close(fd);
+                    return false;
+                }
+                size += length;
+            }
+        }
+
+        void* mapped = mmap(NULL, HOST_FLASH_IMAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+        image = (unsigned char*)mapped;
+        return true;
+    }
+
+    void detach() {
+        if (image != ram_image) {
+            munmap(image, HOST_FLASH_IMAGE_SIZE);
+            image = ram_image;
+        }
+    }
+
+    unsigned int readWord(unsigned int offset) {
+        words_read++;
+        unsigned int value = 0xFFFFFFFF;
+        if (offset + 4 <= HOST_FLASH_IMAGE_SIZE) {
+            memcpy(&value, &image[offset], 4);
+        }
+        return value;
+    }
+
+    void eraseSector(unsigned int sector_offset) {
+        sector_offset -= sector_offset % HOST_FLASH_SECTOR_SIZE;
+        bool lost = operation();
+        if (sector_offset + HOST_FLASH_SECTOR_SIZE <= HOST_FLASH_IMAGE_SIZE) {
+            memset(&image[sector_offset], 0xFF, lost ? HOST_FLASH_SECTOR_SIZE / 2 : HOST_FLASH_SECTOR_SIZE);
+            erase_counts[sector_offset / HOST_FLASH_SECTOR_SIZE]++;
+        }
+        if (lost) {
+            power_loss();
+        }
+        sectors_erased++;
+        spin(erase_us);
+    }
+
+    void writeWord(unsigned int offset, unsigned int data) {
+        bool lost = operation();
+        if (offset + 4 <= HOST_FLASH_IMAGE_SIZE) {
+            unsigned int current;
+            memcpy(&current, &image[offset], 4);
+            if ((current & data) != data) {
+                words_reprogrammed++;
+            }
+            current &= lost ? data | 0xFFFF0000 : data;
+            memcpy(&image[offset], &current, 4);
+        }
+        if (lost) {
+            power_loss();
+        }
+        words_written++;
+        spin(program_us);
+    }
+
+    void reset_counters() {
+        words_read = 0;
+        words_written = 0;
+        words_reprogrammed = 0;
+        sectors_erased = 0;
+        operations = 0;
+        memset(erase_counts, 0, sizeof(erase_counts));
+    }
+
+    unsigned int base_address = 0;
+    unsigned int program_us = 0;
+    unsigned int erase_us = 0;
+    unsigned long words_read = 0;
+    unsigned long words_written = 0;
+    unsigned long words_reprogrammed = 0;
+    unsigned long sectors_erased = 0;
+    unsigned long operations = 0;           // Writes and erases
+    unsigned long power_loss_at = 0;        // Operation cut short, 0 = never
+    void (*power_loss)() = power_loss_exit;
+    unsigned long erase_counts[HOST_FLASH_SECTORS] = {};
+    unsigned char* image = ram_image;
+
+private:
+    bool operation() {
+        operations++;
+        return power_loss_at != 0 && operations == power_loss_at;
+    }
+
+    static void power_loss_exit() {
+        _exit(HOST_FLASH_POWER_LOSS_EXIT);
+    }
+
+    static void spin(unsigned int us) {
+        if (us) {
+            uint32_t start = micros();
+            while (micros() - start < us) {
+            }
+        }
+    }
+
+    unsigned char ram_image[HOST_FLASH_IMAGE_SIZE];
+};
+
+extern FlashMemoryClass FlashMemory;
+
+#endif // HOST_FLASH_MEMORY_H
@@ -0,0 +1,21 @@
+// arm_acle.h - Host Build Stand-in for the ACLE DSP Intrinsics
+#ifndef HOST_ARM_ACLE_H
+#define HOST_ARM_ACLE_H
+
+#include <stdint.h>
+
+// Byte-wise emulation of the Cortex-M33 DSP instructions the sketch uses, so
+// a host build with -DMOTION_GATE_USE_DSP=1 runs the same word loop as the
+// target.
+
+// USADA8: acc plus the sum of absolute differences of the four byte pairs
+static inline uint32_t __usada8(uint32_t a, uint32_t b, uint32_t acc) {
+    for (uint8_t shift = 0; shift < 32; shift += 8) {
+        uint8_t x = (uint8_t)(a >> shift);
+        uint8_t y = (uint8_t)(b >> shift);
+        acc += x > y ? x - y : y - x;
+    }
+    return acc;
+}
+
+#endif // HOST_ARM_ACLE_H
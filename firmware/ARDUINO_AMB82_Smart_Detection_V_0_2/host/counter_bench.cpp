@@ -0,0 +1,168 @@
+// counter_bench.cpp - Motherboard Counter Sliding Window Microbenchmark
+//
+// Compares the time wheel in class_counter.h, driven through the
+// motherboard counter API, with the linear timestamp scan it replaced, at
+// 10, 100 and 1000 detections per window.
+// Each detection costs one add and four window queries, as on the
+// detection path (add debug line, trigger check, trigger message, serial
+// line). Build: see README.txt in this directory.
+
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include "config.h"
+#include "motherboard_counter.h"
+
+// ===== SKETCH GLOBALS =====
+system_config_t system_config = DEFAULT_CONFIG;
+system_state_t system_state = SYS_STATE_INIT;
+
+// Counter log lines name the class; detection_manager.cpp is not linked
+const char* detection_class_to_string(uint8_t object_class) {
+    return object_class < DETECTION_CLASS_COUNT ? itemList[object_class].objectName : "UNKNOWN";
+}
+
+// ===== LINEAR SCAN BASELINE =====
+// The previous implementation: circular buffer of timestamps, every query
+// scans all stored entries. Sized max(100, rate) so it still counts right
+// at 1000/window (the shipped buffer held 100).
+typedef struct {
+    std::vector<uint32_t> detection_timestamps;
+    uint32_t buffer_index;
+    uint32_t buffer_count;
+    uint32_t time_window_ms;
+} linear_counter_t;
+
+static void linear_add(linear_counter_t* counter, uint32_t timestamp) {
+    uint32_t size = counter->detection_timestamps.size();
+    counter->detection_timestamps[counter->buffer_index] = timestamp;
+    counter->buffer_index = (counter->buffer_index + 1) % size;
+    if (counter->buffer_count < size) {
+        counter->buffer_count++;
+    }
+}
+
+static uint32_t linear_count_in_window(const linear_counter_t* counter) {
+    uint32_t current_time = millis();
+    uint32_t window_start = current_time - counter->time_window_ms;
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < counter->buffer_count; i++) {
+        uint32_t detection_time = counter->detection_timestamps[i];
+        if (detection_time > current_time) {
+            continue;
+        }
+        if (detection_time >= window_start) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// ===== BENCHMARK =====
+#define BENCH_WINDOW_MS     10000
+#define BENCH_WINDOWS       200     // Virtual time simulated per run
+#define BENCH_QUERIES       4       // Window queries per detection
+
+typedef struct {
+    double ns_per_detection;
+    uint32_t checksum;              // Sum of query results, keeps the work alive
+    uint32_t max_error;             // Worst difference from the exact count
+} bench_result_t;
+
+static uint32_t bench_start_time = 0;
+
+// Detections every window/rate ms, so the exact count in (t - window, t]
+// after detection n is min(n + 1, rate + 1)
+static uint32_t bench_exact_count(uint32_t rate, uint32_t n) {
+    return n + 1 < rate + 1 ? n + 1 : rate + 1;
+}
+
+static void bench_note(bench_result_t* result, uint32_t rate, uint32_t n, uint32_t count) {
+    uint32_t exact = bench_exact_count(rate, n);
+    uint32_t error = count > exact ? count - exact : exact - count;
+    if (error > result->max_error) {
+        result->max_error = error;
+    }
+}
+
+static bench_result_t bench_linear(uint32_t rate) {
+    linear_counter_t counter;
+    counter.detection_timestamps.assign(rate > 100 ? rate + 1 : 100, 0);
+    counter.buffer_index = 0;
+    counter.buffer_count = 0;
+    counter.time_window_ms = BENCH_WINDOW_MS;
+
+    uint32_t interval = BENCH_WINDOW_MS / rate;
+    uint32_t detections = rate * BENCH_WINDOWS;
+    bench_result_t result = {0, 0, 0};
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < detections; n++) {
+        uint32_t now = bench_start_time + n * interval;
+        host_clock_set(now);
+        linear_add(&counter, now);
+        uint32_t count = 0;
+        for (uint8_t q = 0; q < BENCH_QUERIES; q++) {
+            count = linear_count_in_window(&counter);
+            result.checksum += count;
+        }
+        bench_note(&result, rate, n, count);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    result.ns_per_detection = std::chrono::duration<double, std::nano>(elapsed).count() / detections;
+    return result;
+}
+
+static bench_result_t bench_wheel(uint32_t rate) {
+    system_config.class_counters[CLASS_MOTHERBOARD].window_s = BENCH_WINDOW_MS / 1000;
+    motherboard_counter_init();
+
+    uint32_t interval = BENCH_WINDOW_MS / rate;
+    uint32_t detections = rate * BENCH_WINDOWS;
+    bench_result_t result = {0, 0, 0};
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t n = 0; n < detections; n++) {
+        uint32_t now = bench_start_time + n * interval;
+        host_clock_set(now);
+        motherboard_counter_add_detection(now);
+        uint32_t count = 0;
+        for (uint8_t q = 0; q < BENCH_QUERIES; q++) {
+            count = motherboard_counter_get_count_in_window();
+            result.checksum += count;
+        }
+        bench_note(&result, rate, n, count);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    result.ns_per_detection = std::chrono::duration<double, std::nano>(elapsed).count() / detections;
+    return result;
+}
+
+int main() {
+    static const uint32_t rates[] = {10, 100, 1000};
+
+    system_config.debug_level = 0;
+    host_serial_set_echo(false);
+
+    printf("window %ums, %u windows per run, %u queries per detection, %u-slot wheel\n",
+           BENCH_WINDOW_MS, BENCH_WINDOWS, BENCH_QUERIES, CLASS_COUNTER_SLOTS);
+    printf("each run starts 3 windows before the millis() wrap\n\n");
+    printf("%10s %14s %14s %9s %13s %13s\n", "det/window", "linear ns/det", "wheel ns/det", "speedup",
+           "linear error", "wheel error");
+
+    for (uint32_t rate : rates) {
+        bench_start_time = UINT32_MAX - 3 * BENCH_WINDOW_MS;
+        host_clock_reset(bench_start_time);
+        bench_result_t linear = bench_linear(rate);
+
+        host_clock_reset(bench_start_time);
+        bench_result_t wheel = bench_wheel(rate);
+
+        printf("%10u %14.1f %14.1f %8.1fx %13u %13u\n", rate, linear.ns_per_detection, wheel.ns_per_detection,
+               linear.ns_per_detection / wheel.ns_per_detection, linear.max_error, wheel.max_error);
+    }
+    return 0;
+}
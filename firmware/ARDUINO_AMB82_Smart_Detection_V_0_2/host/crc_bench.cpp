@@ -0,0 +1,190 @@
+// crc_bench.cpp - Checksum Throughput Microbenchmark
+//
+// Bytes per second of the byte-serial add/xor-shift checksum the config used,
+// a bitwise CRC-32, a one-table (Sarwate) CRC-32, the slice-by-4 CRC-32 in
+// crc32.h and a slice-by-8 variant, over a log record, the configuration and
+// a flash sector. Also checks that every CRC gives the standard check value,
+// and counts the corruptions of the configuration each one misses: every
+// two-bit error, and a random word overwritten with a random value. Build:
+// see README.txt in this directory.
+
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+#include "config.h"
+#include "crc32.h"
+
+// ===== SKETCH GLOBALS =====
+system_config_t system_config = DEFAULT_CONFIG;
+system_state_t system_state = SYS_STATE_INIT;
+
+#define BENCH_BYTES_PER_RUN     (64UL * 1024 * 1024)
+#define BENCH_OVERWRITES        1000000
+
+// ===== REFERENCE IMPLEMENTATIONS =====
+// The previous checksum, as in config_calculate_checksum before CRC-32
+static uint32_t legacy_checksum(const void* data, uint32_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t checksum = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        checksum += bytes[i];
+        checksum ^= (checksum << 1);
+    }
+    return checksum;
+}
+
+static uint32_t crc32_bitwise(const void* data, uint32_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFF;
+    for (uint32_t i = 0; i < size; i++) {
+        crc ^= bytes[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32_POLYNOMIAL : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t slice_table[8][256];
+
+static void slice_table_init() {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32_POLYNOMIAL : crc >> 1;
+        }
+        slice_table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (uint8_t k = 1; k < 8; k++) {
+            slice_table[k][i] = (slice_table[k - 1][i] >> 8) ^ slice_table[0][slice_table[k - 1][i] & 0xFF];
+        }
+    }
+}
+
+static uint32_t crc32_sarwate(const void* data, uint32_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFF;
+    for (uint32_t i = 0; i < size; i++) {
+        crc = slice_table[0][(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static uint32_t crc32_slice8(const void* data, uint32_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFF;
+    while (size >= 8) {
+        uint32_t low, high;
+        memcpy(&low, bytes, 4);
+        memcpy(&high, bytes + 4, 4);
+        low ^= crc;
+        crc = slice_table[7][low & 0xFF] ^ slice_table[6][(low >> 8) & 0xFF] ^
+              slice_table[5][(low >> 16) & 0xFF] ^ slice_table[4][low >> 24] ^
+              slice_table[3][high & 0xFF] ^ slice_table[2][(high >> 8) & 0xFF] ^
+              slice_table[1][(high >> 16) & 0xFF] ^ slice_table[0][high >> 24];
+        bytes += 8;
+        size -= 8;
+    }
+    while (size-- > 0) {
+        crc = slice_table[0][(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// ===== BENCHMARK =====
+typedef struct {
+    const char* name;
+    uint32_t (*function)(const void* data, uint32_t size);
+} bench_impl_t;
+
+static const bench_impl_t bench_impls[] = {
+    {"byte sum (old)", legacy_checksum},
+    {"crc32 bitwise", crc32_bitwise},
+    {"crc32 sarwate", crc32_sarwate},
+    {"crc32 slice-4", crc32},
+    {"crc32 slice-8", crc32_slice8},
+};
+#define BENCH_IMPLS (sizeof(bench_impls) / sizeof(bench_impls[0]))
+
+static volatile uint32_t bench_sink;
+
+static double bench_mb_per_s(const bench_impl_t* impl, uint8_t* data, uint32_t size) {
+    uint32_t runs = BENCH_BYTES_PER_RUN / size;
+    uint32_t result = 0;
+    uint8_t first = data[0];
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t run = 0; run < runs; run++) {
+        data[0] = (uint8_t)run;     // Nothing to hoist out of the loop
+        result ^= impl->function(data, size);
+    }
+    data[0] = first;
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    bench_sink = result;
+    return (double)runs * size / std::chrono::duration<double>(elapsed).count() / 1e6;
+}
+
+// Pairs of flipped bits the checksum does not see, out of every pair in the block
+static uint32_t bench_missed_pairs(const bench_impl_t* impl, uint8_t* data, uint32_t size) {
+    uint32_t reference = impl->function(data, size);
+    uint32_t missed = 0;
+    for (uint32_t first = 0; first < size * 8; first++) {
+        data[first / 8] ^= 1 << (first % 8);
+        for (uint32_t second = first + 1; second < size * 8; second++) {
+            data[second / 8] ^= 1 << (second % 8);
+            missed += impl->function(data, size) == reference ? 1 : 0;
+            data[second / 8] ^= 1 << (second % 8);
+        }
+        data[first / 8] ^= 1 << (first % 8);
+    }
+    return missed;
+}
+
+// Aligned words overwritten with a different random value, same seed for each
+static uint32_t bench_missed_overwrites(const bench_impl_t* impl, uint8_t* data, uint32_t size) {
+    uint32_t reference = impl->function(data, size);
+    uint32_t missed = 0;
+    srand(12345);
+    for (uint32_t i = 0; i < BENCH_OVERWRITES; i++) {
+        uint32_t offset = (rand() % (size / 4)) * 4;
+        uint32_t original, value = (uint32_t)rand() ^ ((uint32_t)rand() << 16);
+        memcpy(&original, data + offset, 4);
+        if (value == original) {
+            continue;
+        }
+        memcpy(data + offset, &value, 4);
+        missed += impl->function(data, size) == reference ? 1 : 0;
+        memcpy(data + offset, &original, 4);
+    }
+    return missed;
+}
+
+int main() {
+    slice_table_init();
+    crc32_init();
+
+    std::vector<uint8_t> sector(FLASH_SECTOR_SIZE);
+    for (uint32_t i = 0; i < sector.size(); i++) {
+        sector[i] = (uint8_t)(i * 2654435761u >> 24);
+    }
+    uint8_t config[sizeof(system_config_t)];
+    memcpy(config, &system_config, sizeof(config));
+
+    uint32_t config_bits = sizeof(config) * 8;
+    printf("%u MB per run, word-aligned buffers; missed corruptions of the %u-byte config: of all %u\n"
+           "two-bit errors, of %u random word overwrites\n\n", (unsigned)(BENCH_BYTES_PER_RUN >> 20),
+           (unsigned)sizeof(config), config_bits * (config_bits - 1) / 2, BENCH_OVERWRITES);
+    printf("%-16s %10s %10s %12s %10s %12s %12s\n", "", "123456789", "20B MB/s", "config MB/s", "4KB MB/s",
+           "2-bit missed", "word missed");
+    for (uint32_t i = 0; i < BENCH_IMPLS; i++) {
+        const bench_impl_t* impl = &bench_impls[i];
+        uint32_t check_value = impl->function("123456789", 9);
+        bool is_crc = i > 0;
+        printf("%-16s %10s %10.1f %12.1f %10.1f %12u %12u\n", impl->name,
+               is_crc ? (check_value == CRC32_CHECK_VALUE ? "ok" : "FAIL") : "-",
+               bench_mb_per_s(impl, sector.data(), 20), bench_mb_per_s(impl, config, sizeof(config)),
+               bench_mb_per_s(impl, sector.data(), sector.size()), bench_missed_pairs(impl, config, sizeof(config)),
+               bench_missed_overwrites(impl, config, sizeof(config)));
+    }
+    return 0;
+}
@@ -0,0 +1,307 @@
+// flash_bench.cpp - Flash Log and Config Throughput and Power-Loss Benchmark
+//
+// Runs amb82_flash.cpp unmodified against the file-backed NOR flash emulator
+// in FlashMemory.h. First the throughput of the detection log (a record per
+// hit, flushed every BENCH_FLUSH_EVERY records) and of config saves that
+// change one setting, with the words programmed and sectors erased per
+// operation. Then crash consistency: a mixed workload of log records and
+// config saves is cut by a power loss at evenly spread flash operations, each
+// in a child process, and after the reboot the log must read back oldest
+// first with consecutive timestamps, hold every record of a completed flush
+// and take new records; the config must load as the last completed save or
+// the one under way.
+// Build: see README.txt in this directory.
+
+#include <Arduino.h>
+#include <limits.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "config.h"
+#include "amb82_flash.h"
+
+// ===== SKETCH GLOBALS =====
+system_config_t system_config = DEFAULT_CONFIG;
+system_state_t system_state = SYS_STATE_INIT;
+
+#define BENCH_FLUSH_EVERY       8       // Records per flush, below FLASH_LOG_STAGE_RECORDS
+#define BENCH_CONFIG_EVERY      250     // Records per config save in the mixed workload
+
+typedef struct {
+    unsigned long started;          // Flash operations when it started
+    unsigned long operations;       // And when it completed
+    uint32_t value;                 // Newest record flushed, total_detections saved
+} bench_commit_t;
+
+static const char* bench_image = "flash_bench.img";
+static std::vector<unsigned char> bench_baseline;
+static std::vector<bench_commit_t> bench_log_commits;
+static std::vector<bench_commit_t> bench_config_commits;
+
+// ===== HELPERS =====
+static void bench_boot() {
+    FlashMemory.attach(bench_image);
+    flash_init();
+    config_load_from_flash();
+}
+
+static void bench_log(uint32_t timestamp) {
+    detection_result_t result;
+    memset(&result, 0, sizeof(result));
+    result.timestamp = timestamp;
+    result.object_class = CLASS_MOTHERBOARD;
+    result.confidence = 0.9f;
+    result.valid = 1;
+    flash_write_detection_log(&result);
+}
+
+static void bench_config_save(uint32_t value) {
+    system_config.total_detections = value;
+    config_save_to_flash();
+}
+
+// Erased image with a saved config, what every run starts from
+static void bench_make_baseline() {
+    remove(bench_image);
+    bench_boot();
+    system_config = DEFAULT_CONFIG;
+    system_config.debug_level = 0;
+    system_config.log_event_gap_s = 0;
+    bench_config_save(0);
+    bench_baseline.assign(FlashMemory.image, FlashMemory.image + HOST_FLASH_IMAGE_SIZE);
+}
+
+static void bench_restore_baseline() {
+    FlashMemory.attach(bench_image);
+    memcpy(FlashMemory.image, bench_baseline.data(), HOST_FLASH_IMAGE_SIZE);
+    bench_boot();
+    FlashMemory.reset_counters();
+}
+
+static void bench_erase_spread(uint32_t offset, uint16_t sectors, unsigned long* lowest, unsigned long* highest) {
+    *lowest = ULONG_MAX;
+    *highest = 0;
+    for (uint16_t i = 0; i < sectors; i++) {
+        unsigned long count = FlashMemory.erase_counts[offset / HOST_FLASH_SECTOR_SIZE + i];
+        *lowest = min(*lowest, count);
+        *highest = max(*highest, count);
+    }
+}
+
+// ===== THROUGHPUT =====
+static void bench_log_throughput(uint32_t records) {
+    bench_restore_baseline();
+    uint32_t start_us = micros();
+    for (uint32_t i = 1; i <= records; i++) {
+        bench_log(i);
+        if (i % BENCH_FLUSH_EVERY == 0) {
+            flash_log_flush();
+        }
+    }
+    flash_log_flush();
+    uint32_t elapsed_us = max(micros() - start_us, 1u);
+
+    unsigned long lowest, highest;
+    bench_erase_spread(FLASH_LOG_OFFSET, FLASH_LOG_SECTORS, &lowest, &highest);
+    printf("log     %7u records  %9.0f records/s  %5.2f words/record  %4lu erases, %lu-%lu per sector\n", records,
+           records * 1e6 / elapsed_us, (double)FlashMemory.words_written / records, FlashMemory.sectors_erased, lowest,
+           highest);
+}
+
+static void bench_config_throughput(uint32_t saves) {
+    bench_restore_baseline();
+    uint32_t start_us = micros();
+    for (uint32_t i = 1; i <= saves; i++) {
+        bench_config_save(i);
+    }
+    uint32_t elapsed_us = max(micros() - start_us, 1u);
+    unsigned long words = FlashMemory.words_written;
+
+    uint32_t unchanged_us = micros();
+    for (uint32_t i = 0; i < saves; i++) {
+        config_save_to_flash();
+    }
+    unchanged_us = max(micros() - unchanged_us, 1u);
+
+    unsigned long lowest, highest;
+    bench_erase_spread(FLASH_CONFIG_OFFSET, FLASH_CONFIG_SLOTS, &lowest, &highest);
+    printf("config  %7u saves    %9.0f saves/s    %5.2f words/save    %4lu erases, %lu-%lu per slot, %u compactions\n",
+           saves, saves * 1e6 / elapsed_us, (double)words / saves, FlashMemory.sectors_erased, lowest, highest,
+           config_get_store_stats()->compactions);
+    printf("config  %7u unchanged %8.0f saves/s    %5.2f words/save\n", saves, saves * 1e6 / unchanged_us,
+           (double)(FlashMemory.words_written - words) / saves);
+}
+
+// ===== POWER LOSS =====
+// Log records and config saves interleaved, completions noted when recording
+static void bench_workload(uint32_t records, bool record) {
+    for (uint32_t i = 1; i <= records; i++) {
+        bench_log(i);
+        if (i % BENCH_FLUSH_EVERY == 0) {
+            unsigned long started = FlashMemory.operations;
+            flash_log_flush();
+            if (record) {
+                bench_log_commits.push_back({started, FlashMemory.operations, i});
+            }
+        }
+        if (i % BENCH_CONFIG_EVERY == 0) {
+            unsigned long started = FlashMemory.operations;
+            bench_config_save(i);
+            if (record) {
+                bench_config_commits.push_back({started, FlashMemory.operations, i});
+            }
+        }
+    }
+}
+
+// Value of the last commit that completed before operation at, next is the
+// one it cut short
+static uint32_t bench_committed(const std::vector<bench_commit_t>& commits, unsigned long at, uint32_t* next) {
+    uint32_t value = 0;
+    *next = 0;
+    for (const bench_commit_t& commit : commits) {
+        if (commit.operations >= at) {
+            *next = commit.started < at ? commit.value : 0;
+            break;
+        }
+        value = commit.value;
+    }
+    return value;
+}
+
+// Oldest first, each readable timestamp one above the previous readable one
+static bool bench_chronological(uint32_t* newest, uint32_t* torn) {
+    uint32_t previous = 0;
+    *torn = 0;
+    for (uint32_t i = 0; i < flash_get_log_count(); i++) {
+        detection_result_t result;
+        flash_result_t read = flash_read_detection_log(i, &result);
+        if (read == FLASH_ERROR_CHECKSUM) {
+            (*torn)++;
+            continue;
+        }
+        if (read != FLASH_SUCCESS || (previous && result.timestamp != previous + 1)) {
+            return false;
+        }
+        previous = result.timestamp;
+    }
+    *newest = previous;
+    return true;
+}
+
+static void bench_power_loss(uint32_t records, uint32_t runs) {
+    bench_restore_baseline();
+    bench_workload(records, true);
+    unsigned long total = FlashMemory.operations;
+
+    uint32_t consistent = 0, lost = 0, config_cut = 0, config_new = 0, torn_runs = 0;
+    uint32_t staged_lost = 0;
+    unsigned long max_reads = 0;
+    for (uint32_t run = 0; run < runs; run++) {
+        unsigned long at = 1 + (unsigned long)((uint64_t)run * total / runs);
+        bench_restore_baseline();
+        pid_t pid = fork();
+        if (pid == 0) {
+            FlashMemory.power_loss_at = at;
+            bench_workload(records, false);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        lost += WIFEXITED(status) && WEXITSTATUS(status) == HOST_FLASH_POWER_LOSS_EXIT ? 1 : 0;
+
+        unsigned long reads = FlashMemory.words_read;
+        bench_boot();
+        max_reads = max(max_reads, FlashMemory.words_read - reads);
+
+        uint32_t next_log, next_config;
+        uint32_t flushed = bench_committed(bench_log_commits, at, &next_log);
+        uint32_t saved = bench_committed(bench_config_commits, at, &next_config);
+        uint32_t newest = 0, torn = 0;
+        bool ok = bench_chronological(&newest, &torn) && torn <= 1 && newest >= flushed && newest <= records &&
+                  (system_config.total_detections == saved ||
+                   (next_config && system_config.total_detections == next_config));
+        config_cut += next_config ? 1 : 0;
+        config_new += next_config && system_config.total_detections == next_config ? 1 : 0;
+        torn_runs += torn ? 1 : 0;
+        staged_lost += next_log > newest ? next_log - newest : 0;
+
+        // The journal takes records again after the reboot
+        bench_log(newest + 1);
+        flash_log_flush();
+        bench_boot();
+        uint32_t after = 0;
+        ok = ok && bench_chronological(&after, &torn) && after == newest + 1;
+        if (ok) {
+            consistent++;
+        } else {
+            printf("power loss at operation %lu of %lu: log newest %u (flushed %u), then %u, config %u (saved %u)  FAIL\n",
+                   at, total, newest, flushed, after, system_config.total_detections, saved);
+        }
+    }
+
+    printf("power   %7u runs     %lu flash operations, cut at every %lu\n", runs, total, max(total / runs, 1ul));
+    printf("power   %7u consistent, %u power losses, %u with a torn record, %u during a config save (%u loaded the new config)\n",
+           consistent, lost, torn_runs, config_cut, config_new);
+    printf("power   %9.1f staged records dropped per run, %lu flash reads to recover at most\n",
+           runs ? (double)staged_lost / runs : 0.0, max_reads);
+    if (consistent != runs) {
+        printf("FAILED\n");
+        exit(1);
+    }
+}
+
+// ===== MAIN =====
+static void bench_usage() {
+    printf("usage: flash_bench [-r <records>] [-s <saves>] [-n <runs>] [-P <us>[,<us>]] [image]\n"
+           "  -r <records>    log records per run (default 4000, more than the log holds)\n"
+           "  -s <saves>      config saves (default 1000)\n"
+           "  -n <runs>       power-loss runs (default 200)\n"
+           "  -P <us>[,<us>]  flash word program [and sector erase] time, default 0\n");
+}
+
+int main(int argc, char** argv) {
+    uint32_t records = 4000;
+    uint32_t saves = 1000;
+    uint32_t runs = 200;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "-r") == 0 && has_value) {
+            records = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(arg, "-s") == 0 && has_value) {
+            saves = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(arg, "-n") == 0 && has_value) {
+            runs = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(arg, "-P") == 0 && has_value) {
+            if (sscanf(argv[++i], "%u,%u", &FlashMemory.program_us, &FlashMemory.erase_us) < 1) {
+                bench_usage();
+                return 2;
+            }
+        } else if (arg[0] != '-') {
+            bench_image = arg;
+        } else {
+            bench_usage();
+            return 2;
+        }
+    }
+    if (records == 0 || saves == 0) {
+        bench_usage();
+        return 2;
+    }
+    host_serial_set_echo(false);
+
+    printf("image %s, log %u sectors x %u records, config %u slots, program %uus, erase %uus\n\n", bench_image,
+           FLASH_LOG_SECTORS, (unsigned)LOG_RECORDS_PER_SECTOR, FLASH_CONFIG_SLOTS, FlashMemory.program_us,
+           FlashMemory.erase_us);
+    bench_make_baseline();
+    bench_log_throughput(records);
+    bench_config_throughput(saves);
+
+    // Power-loss runs replay the workload many times, flash time would only slow them down
+    FlashMemory.program_us = 0;
+    FlashMemory.erase_us = 0;
+    bench_power_loss(records, runs);
+    printf("\nPASSED\n");
+    return 0;
+}
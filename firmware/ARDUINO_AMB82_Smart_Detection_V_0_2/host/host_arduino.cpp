@@ -0,0 +1,166 @@
+// host_arduino.cpp - Host Build Stand-in Implementation
+#include <Arduino.h>
+#include <FlashMemory.h>
+#include <time.h>
+
+// ===== GLOBAL VARIABLES =====
+static uint32_t host_clock_ms = 0;
+static bool host_serial_echo = true;
+static host_lora_uplink_t host_lora_uplink = NULL;
+
+FlashMemoryClass FlashMemory;
+
+// ===== CONSOLE SERIAL =====
+class HostConsoleSerial : public HardwareSerial {
+public:
+    size_t write(const char* data, size_t length) override {
+        if (host_serial_echo) {
+            fwrite(data, 1, length, stdout);
+        }
+        return length;
+    }
+};
+
+// ===== EMULATED RAK3172 =====
+// Collects AT commands line by line and queues the module's reply. AT+SEND
+// payloads are hex decoded and handed to the uplink callback. Fixed buffers,
+// so a send costs the replay's heap probe nothing.
+#define HOST_RAK3172_LINE_SIZE  128     // Longer commands are cut, the firmware's are under 100
+#define HOST_RAK3172_RX_SIZE    64
+
+class HostRak3172Serial : public HardwareSerial {
+public:
+    int available() override { return (int)(rx_length - rx_pos); }
+
+    int read() override {
+        if (rx_pos >= rx_length) {
+            return -1;
+        }
+        int c = (unsigned char)rx[rx_pos++];
+        if (rx_pos == rx_length) {
+            rx_length = 0;
+            rx_pos = 0;
+        }
+        return c;
+    }
+
+    size_t write(const char* data, size_t length) override {
+        for (size_t i = 0; i < length; i++) {
+            if (data[i] == '\n') {
+                line[line_length] = '\0';
+                handle_command();
+                line_length = 0;
+            } else if (data[i] != '\r' && line_length < sizeof(line) - 1) {
+                line[line_length++] = data[i];
+            }
+        }
+        return length;
+    }
+
+private:
+    char line[HOST_RAK3172_LINE_SIZE];
+    size_t line_length = 0;
+    char rx[HOST_RAK3172_RX_SIZE];
+    size_t rx_length = 0;
+    size_t rx_pos = 0;
+
+    static int hex_value(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    void reply(const char* text) {
+        size_t length = min(strlen(text), sizeof(rx) - rx_length);
+        memcpy(&rx[rx_length], text, length);
+        rx_length += length;
+    }
+
+    void handle_command() {
+        if (strncmp(line, "AT+SEND=", 8) == 0) {
+            const char* colon = strchr(line, ':');
+            char payload[HOST_RAK3172_LINE_SIZE / 2];
+            size_t payload_length = 0;
+            for (const char* hex = colon ? colon + 1 : ""; hex[0] && hex[1]; hex += 2) {
+                int hi = hex_value(hex[0]);
+                int lo = hex_value(hex[1]);
+                if (hi < 0 || lo < 0) {
+                    break;
+                }
+                payload[payload_length++] = (char)((hi << 4) | lo);
+            }
+            payload[payload_length] = '\0';
+            if (host_lora_uplink) {
+                host_lora_uplink(payload, host_clock_ms);
+            }
+        } else if (strcmp(line, "AT+VER=?") == 0) {
+            reply("RUI_4.0.6_RAK3172-E (host)\r\n");
+        }
+        reply("OK\r\n");
+    }
+};
+
+static HostConsoleSerial host_console;
+static HostRak3172Serial host_rak3172;
+
+HardwareSerial& Serial = host_console;
+HardwareSerial& Serial1 = host_rak3172;
+
+// ===== TIME AND GPIO =====
+uint32_t millis() {
+    return host_clock_ms;
+}
+
+uint32_t micros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+}
+
+void delay(uint32_t ms) {
+    host_clock_ms += ms;
+}
+
+void delayMicroseconds(uint32_t us) {
+    (void)us;
+}
+
+void pinMode(int pin, int mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(int pin, int value) {
+    (void)pin;
+    (void)value;
+}
+
+int digitalRead(int pin) {
+    (void)pin;
+    return LOW;
+}
+
+void NVIC_SystemReset() {
+    fprintf(stderr, "NVIC_SystemReset() called\n");
+    exit(2);
+}
+
+// ===== HOST CONTROL =====
+void host_clock_set(uint32_t ms) {
+    if ((int32_t)(ms - host_clock_ms) > 0) {
+        host_clock_ms = ms;
+    }
+}
+
+void host_clock_reset(uint32_t ms) {
+    host_clock_ms = ms;
+}
+
+void host_serial_set_echo(bool echo) {
+    host_serial_echo = echo;
+}
+
+void host_lora_set_uplink(host_lora_uplink_t callback) {
+    host_lora_uplink = callback;
+}
@@ -0,0 +1,591 @@
+// journal_check.cpp - Detection Log Journal Reboot and Power-Loss Check
+//
+// Drives the detection log journal in amb82_flash.cpp against a file-backed
+// FlashMemory image. Every "reboot" reloads the image from the file and runs
+// flash_init() again; afterwards the log must read back oldest first as
+// consecutive timestamps, skipping only records torn mid-write. Covers the
+// packed record codec, a log area holding foreign data, several laps of the
+// sector ring, a record torn mid-write, a reset between a sector erase and
+// its header (also on the wrap to sector 0), the RAM stage in front of the
+// journal, millis() starting over across a reboot, hits merged into events, a
+// writer process killed with SIGKILL at random points and, last, the A/B
+// config slots. All but the event checks log every hit as a record
+// (log_event_gap_s 0). Throughout, the journal must only program erased words
+// and wear its sectors evenly, a sector whose header was lost erring on the
+// high side. Build: see README.txt in this directory.
+
+#include <Arduino.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "config.h"
+#include "amb82_flash.h"
+
+// ===== SKETCH GLOBALS =====
+system_config_t system_config = DEFAULT_CONFIG;
+system_state_t system_state = SYS_STATE_INIT;
+
+#define CHECK_KILL_RUNS         20
+#define CHECK_KILL_MAX_US       20000   // Writer runtime before SIGKILL, random up to this
+
+static const char* check_image = "journal_check.img";
+static uint32_t check_failures = 0;
+static uint32_t check_next_timestamp = 1;
+
+static void check(bool ok, const String& what) {
+    printf("%-64s %s\n", what.c_str(), ok ? "ok" : "FAIL");
+    if (!ok) {
+        check_failures++;
+    }
+}
+
+// Reset: reload the image and recover the log, returns the flash reads it took
+static uint32_t check_reboot() {
+    FlashMemory.attach(check_image);
+    unsigned long reads = FlashMemory.words_read;
+    flash_init();
+    return FlashMemory.words_read - reads;
+}
+
+static void check_stage(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        detection_result_t result;
+        memset(&result, 0, sizeof(result));
+        result.timestamp = check_next_timestamp++;
+        result.object_class = CLASS_MOTHERBOARD;
+        result.confidence = 0.9f;
+        result.valid = 1;
+        flash_write_detection_log(&result);
+    }
+}
+
+static void check_write(uint32_t count) {
+    check_stage(count);
+    flash_log_flush();
+}
+
+// Oldest first, each readable timestamp one above the previous readable one
+static bool check_chronological(uint32_t* newest, uint32_t* torn) {
+    uint32_t previous = 0;
+    *torn = 0;
+    for (uint32_t i = 0; i < flash_get_log_count(); i++) {
+        detection_result_t result;
+        flash_result_t read = flash_read_detection_log(i, &result);
+        if (read == FLASH_ERROR_CHECKSUM) {
+            (*torn)++;
+            continue;
+        }
+        if (read != FLASH_SUCCESS || (previous && result.timestamp != previous + 1)) {
+            return false;
+        }
+        previous = result.timestamp;
+    }
+    *newest = previous;
+    return true;
+}
+
+static bool check_log(uint32_t min_count, uint32_t newest_timestamp, uint32_t max_torn) {
+    uint32_t newest = 0;
+    uint32_t torn = 0;
+    return flash_get_log_count() >= min_count && flash_get_log_count() <= MAX_LOG_ENTRIES &&
+           check_chronological(&newest, &torn) && newest == newest_timestamp && torn <= max_torn;
+}
+
+// A count less the oldest sector, which starting a new sector may drop
+static uint32_t check_less_a_sector(uint32_t count) {
+    return count > LOG_RECORDS_PER_SECTOR ? count - LOG_RECORDS_PER_SECTOR : 0;
+}
+
+static uint32_t check_sector_offset(uint16_t sector) {
+    return FLASH_LOG_OFFSET + sector * FLASH_SECTOR_SIZE;
+}
+
+// A reset after word 0 and part of the rest of a record were written
+static void check_tear_record() {
+    uint16_t sector, slot;
+    flash_get_log_head(&sector, &slot);
+    uint32_t offset = check_sector_offset(sector) + sizeof(flash_sector_header_t) + sizeof(log_sector_preamble_t) +
+                      slot * sizeof(log_packed_t);
+    FlashMemory.writeWord(offset, 0x80000001);
+    FlashMemory.writeWord(offset + 4, 0x12345678);
+}
+
+// A reset between erasing the next sector and writing its header
+static void check_tear_sector_start() {
+    uint16_t sector, slot;
+    flash_get_log_head(&sector, &slot);
+    FlashMemory.eraseSector(check_sector_offset(sector));
+}
+
+// Write up to the start of a sector, landing on sector_index if given
+static void check_write_to_sector_start(int32_t sector_index) {
+    uint16_t sector, slot;
+    do {
+        flash_get_log_head(&sector, &slot);
+        check_write(LOG_RECORDS_PER_SECTOR - slot);
+        flash_get_log_head(&sector, &slot);
+    } while (sector_index >= 0 && sector != (uint16_t)sector_index);
+}
+
+static uint32_t check_erase_count(uint16_t sector) {
+    uint32_t offset = check_sector_offset(sector);
+    return FlashMemory.readWord(offset) == FLASH_WEAR_MAGIC ? FlashMemory.readWord(offset + 4) : 0;
+}
+
+// Lowest set bit cleared, a bit that programming alone can flip
+static uint32_t check_clear_bit(uint32_t word) {
+    return word & (word - 1);
+}
+
+static uint32_t check_config_slot_offset(uint8_t slot) {
+    return FLASH_CONFIG_OFFSET + slot * FLASH_SECTOR_SIZE;
+}
+
+// Configurations before CRC-32
+static uint32_t check_v1_checksum(const void* block, uint32_t size) {
+    uint32_t checksum = 0;
+    const uint8_t* data = (const uint8_t*)block;
+    for (uint32_t i = 0; i < size; i++) {
+        checksum += data[i];
+        checksum ^= (checksum << 1);
+    }
+    return checksum;
+}
+
+// Encode and decode one event, true if it comes back within quantization
+static bool check_codec(const log_event_t& event, uint32_t previous_timestamp, uint32_t timestamp_error,
+                        uint32_t duration_error) {
+    log_packed_t packed;
+    log_event_t decoded_event;
+    if (!flash_log_encode(&event, previous_timestamp, &packed) ||
+        !flash_log_decode(&packed, previous_timestamp, &decoded_event)) {
+        return false;
+    }
+    const detection_result_t& entry = event.detection;
+    const detection_result_t& decoded = decoded_event.detection;
+    uint32_t timestamp_diff = entry.timestamp > decoded.timestamp ? entry.timestamp - decoded.timestamp
+                                                                 : decoded.timestamp - entry.timestamp;
+    uint32_t duration = event.last_timestamp - entry.timestamp;
+    uint32_t decoded_duration = decoded_event.last_timestamp - decoded.timestamp;
+    return timestamp_diff <= timestamp_error && decoded_event.hits == event.hits &&
+           decoded_duration <= duration && duration - decoded_duration <= duration_error &&
+           decoded.object_class == entry.object_class &&
+           decoded.valid == entry.valid && fabsf(decoded.confidence - entry.confidence) <= 0.5f / 255 &&
+           fabsf(decoded.x_min - entry.x_min) <= 1e-4f && fabsf(decoded.y_min - entry.y_min) <= 1e-4f &&
+           fabsf(decoded.x_max - entry.x_max) <= 1e-4f && fabsf(decoded.y_max - entry.y_max) <= 1e-4f;
+}
+
+// Valid hits in the log the way flash_get_log_stats() used to count them
+static uint32_t check_scan_hits() {
+    uint32_t hits = 0;
+    for (uint32_t i = 0; i < flash_get_log_count(); i++) {
+        log_event_t event;
+        if (flash_read_log_event(i, &event) == FLASH_SUCCESS && event.detection.valid == 1) {
+            hits += event.hits;
+        }
+    }
+    return hits;
+}
+
+static bool check_index_stats() {
+    uint32_t hits, led_hits, mb_hits;
+    return flash_get_log_stats(&hits, &led_hits, &mb_hits) == FLASH_SUCCESS && hits == check_scan_hits() &&
+           mb_hits == hits;
+}
+
+static void check_erase_counts(uint32_t* lowest, uint32_t* highest) {
+    *lowest = UINT32_MAX;
+    *highest = 0;
+    for (uint32_t sector = 0; sector < FLASH_LOG_SECTORS; sector++) {
+        uint32_t count = check_erase_count(sector);
+        *lowest = min(*lowest, count);
+        *highest = max(*highest, count);
+    }
+}
+
+// Child keeps logging until the parent kills it
+static void check_kill_run(uint32_t run_us) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        check_reboot();
+        uint32_t newest = 0;
+        uint32_t torn = 0;
+        check_chronological(&newest, &torn);
+        check_next_timestamp = newest + 1;
+        for (;;) {
+            check_write(1);
+        }
+    }
+    usleep(run_us);
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        check_image = argv[1];
+    }
+    system_config.debug_level = 0;
+    system_config.log_event_gap_s = 0;
+    host_serial_set_echo(false);
+    remove(check_image);
+
+    const uint32_t slots = MAX_LOG_ENTRIES;
+    const uint32_t per_sector = LOG_RECORDS_PER_SECTOR;
+    printf("image %s, %u sectors x %u slots of %u bytes\n\n",
+           check_image, FLASH_LOG_SECTORS, per_sector, (unsigned)sizeof(log_packed_t));
+    check(crc32("123456789", 9) == CRC32_CHECK_VALUE && crc32_update(crc32("1234", 4), "56789", 5) == CRC32_CHECK_VALUE,
+          "crc32: check value, continued");
+
+    log_event_t event = {{123456, CLASS_LED_ON, 0.734f, 0.1f, 0.25f, 0.5f, 1.0f, 1}, 123456, 1};
+    detection_result_t& entry = event.detection;
+    check(check_codec(event, entry.timestamp - 65535, 0, 0), "codec: 65s delta exact, fields within quantization");
+    check(check_codec(event, entry.timestamp + 65536, 0, 0), "codec: -65s delta exact");
+    entry.object_class = CLASS_UNKNOWN;
+    entry.valid = 0;
+    event.hits = 500;
+    event.last_timestamp = entry.timestamp + 1234567;
+    check(check_codec(event, entry.timestamp - 18 * 3600 * 1000, 999, 99), "codec: 18h delta within a second, 500 hits over 20min");
+    event.hits = LOG_EVENT_MAX_HITS;
+    event.last_timestamp = entry.timestamp + 90 * 3600 * 1000;
+    check(check_codec(event, entry.timestamp + 18 * 3600 * 1000, 999, 9999), "codec: -18h delta, max hits over 90h");
+    log_packed_t packed;
+    check(!flash_log_encode(&event, entry.timestamp - 19 * 3600 * 1000, &packed) &&
+          !flash_log_encode(&event, entry.timestamp + 19 * 3600 * 1000, &packed), "codec: 19h gap either way refused");
+    log_event_t decoded;
+    flash_log_encode(&event, entry.timestamp, &packed);
+    packed.words[1] ^= 0x100;
+    check(!flash_log_decode(&packed, entry.timestamp, &decoded), "codec: a flipped bit fails the CRC");
+
+    check_reboot();
+    check(flash_get_log_count() == 0, "erased flash: empty log");
+
+    // Entries in the 0x1F00 layout and a sector from another layout
+    for (uint32_t i = 0; i < 20 * sizeof(detection_result_t) / 4; i++) {
+        FlashMemory.writeWord(FLASH_LOG_OFFSET + i * 4, i % 8 == 7 ? 1 : i);
+    }
+    check_reboot();
+    check(flash_get_log_count() == 0, "foreign data in the log area: empty log");
+
+    check_write(10);
+    check_reboot();
+    check(check_log(10, 10, 0), "10 records: survive a reboot in order");
+
+    check_write(slots * 2 + slots / 2 - 10);
+    uint32_t total = check_next_timestamp - 1;
+    uint32_t reads = check_reboot();
+    check(check_log(slots - per_sector, total, 0), "2.5 laps: newest " + String(flash_get_log_count()) +
+                                                   " in order after reboot");
+    check(reads < 128 + 16, "recovery: " + String(reads) + " flash reads for " + String(slots) +
+                            " slots and the config slot headers");
+
+    // Stats come from the sector summaries; only the head the reboot left
+    // without one is read through, and its summary written
+    unsigned long index_reads = FlashMemory.words_read;
+    uint32_t hits, led_hits, mb_hits;
+    flash_get_log_stats(&hits, &led_hits, &mb_hits);
+    index_reads = FlashMemory.words_read - index_reads;
+    unsigned long scan_reads = FlashMemory.words_read;
+    uint32_t scan_hits = check_scan_hits();
+    scan_reads = FlashMemory.words_read - scan_reads;
+    check(hits == scan_hits && mb_hits == hits && led_hits == 0 && flash_log_get_scanned_sectors() <= 1 &&
+          index_reads <= (FLASH_LOG_SECTORS + 2) * sizeof(log_summary_t) / 4 + per_sector * (sizeof(log_packed_t) / 4 + 2),
+          "index: stats in " + String(index_reads) + " reads, a full scan takes " + String(scan_reads));
+    index_reads = FlashMemory.words_read;
+    flash_get_log_stats(&hits, &led_hits, &mb_hits);
+    check(FlashMemory.words_read == index_reads && hits == scan_hits, "index: stats again from RAM, no reads");
+
+    // A time range reads only the sectors whose summary overlaps it
+    uint32_t from_ms = total - 1000;
+    log_event_t range[128];
+    uint32_t range_index = 0;
+    index_reads = FlashMemory.words_read;
+    uint16_t found = flash_read_log_range(from_ms, from_ms + 100, &range_index, range, 128);
+    index_reads = FlashMemory.words_read - index_reads;
+    bool range_ok = found == 101 && range_index == flash_get_log_count();
+    for (uint16_t i = 0; range_ok && i < found; i++) {
+        range_ok = range[i].detection.timestamp == from_ms + i;
+    }
+    check(range_ok && index_reads < 3 * per_sector * (sizeof(log_packed_t) / 4 + 1),
+          "index: 101 events of a 100ms range in " + String(index_reads) + " reads");
+    range_index = 0;
+    found = flash_read_log_range(from_ms, from_ms + 100, &range_index, range, 60);
+    found += flash_read_log_range(from_ms, from_ms + 100, &range_index, range + 60, 60);
+    check(found == 101 && range[60].detection.timestamp == from_ms + 60, "index: range read in two batches");
+
+    // Each boot starts a new sector, so from here on a reboot followed by a
+    // write may drop the oldest sector
+    check_write(3);
+    total += 3;
+    uint32_t kept = flash_get_log_count();
+    check_tear_record();
+    check_reboot();
+    check(check_log(kept, total, 1), "torn record: skipped, rest in order");
+    kept = flash_get_log_count();
+    check_write(1);
+    check_reboot();
+    check(check_log(check_less_a_sector(kept) + 1, total + 1, 1), "write after torn record: new sector, in order");
+
+    check_write_to_sector_start(-1);
+    total = check_next_timestamp - 1;
+    kept = flash_get_log_count();
+    check_tear_sector_start();
+    check_reboot();
+    check(check_log(check_less_a_sector(kept), total, 1), "reset between erase and header: oldest sector dropped");
+    kept = flash_get_log_count();
+    check_write(1);
+    check_reboot();
+    check(check_log(kept + 1, total + 1, 1), "write after it: sector restarted, in order");
+
+    check_write_to_sector_start(0);
+    total = check_next_timestamp - 1;
+    kept = flash_get_log_count();
+    check_tear_sector_start();
+    check_reboot();
+    check(check_log(check_less_a_sector(kept), total, 1), "same on the wrap to sector 0");
+    kept = flash_get_log_count();
+    check_write(1);
+    check_reboot();
+    check(check_log(kept + 1, total + 1, 1), "write after it: sector 0 restarted, in order");
+    check_write(per_sector + 5);
+    check(check_index_stats(), "index: summaries kept up through writes, torn records and a lap");
+
+    uint32_t lowest, highest;
+    check_erase_counts(&lowest, &highest);
+    // One lap apart at most, plus one for each of the two sectors that lost their
+    // header
+    check(highest - lowest <= 3, "wear: sector erase counts " + String(lowest) + "-" + String(highest));
+    check(FlashMemory.words_reprogrammed == 0, "only erased words programmed (" + String(FlashMemory.sectors_erased) +
+                                               " sector erases so far)");
+
+    // Staging: read back before the flush, lost on power loss, kept by a flush
+    uint32_t flushed = flash_get_log_sequence();
+    kept = flash_get_log_count();
+    check_stage(FLASH_LOG_STAGE_RECORDS - 1);
+    total = check_next_timestamp - 1;
+    check(flash_log_get_staged() == FLASH_LOG_STAGE_RECORDS - 1 && check_log(kept + FLASH_LOG_STAGE_RECORDS - 1, total, 1),
+          "staged records: counted and read back in order");
+    check_reboot();
+    check(flash_get_log_sequence() == flushed, "power loss: staged records dropped, log intact");
+    check_next_timestamp = total - FLASH_LOG_STAGE_RECORDS + 2;
+    check_stage(FLASH_LOG_STAGE_RECORDS + 2);
+    total = check_next_timestamp - 1;
+    check(flash_log_get_staged() == 2, "stage overflow: full stage flushed first");
+    flash_log_process();
+    check(flash_log_get_staged() == 2, "main loop: young stage kept");
+    host_clock_set(millis() + FLASH_LOG_STAGE_MAX_MS);
+    flash_log_process();
+    check(flash_log_get_staged() == 0, "main loop: stage flushed after FLASH_LOG_STAGE_MAX_MS");
+    check_stage(1);
+    config_save_to_flash();
+    check_reboot();
+    check(check_log(check_less_a_sector(kept) + FLASH_LOG_STAGE_RECORDS + 3, total + 1, 1),
+          "config save: stage flushed, survives a reboot");
+    check(check_index_stats(), "index: staged records counted, open sector read through after reboot");
+    
+    // A gap the delta cannot hold starts a new sector
+    check_write(1);
+    uint16_t head_sector, head_slot;
+    flash_get_log_head(&head_sector, &head_slot);
+    check_next_timestamp += 3 * 86400000;
+    check_write(1);
+    uint16_t gap_sector, gap_slot;
+    flash_get_log_head(&gap_sector, &gap_slot);
+    check_reboot();
+    detection_result_t newest;
+    check(gap_sector == (head_sector + 1) % FLASH_LOG_SECTORS && gap_slot == 1 &&
+          flash_read_detection_log(flash_get_log_count() - 1, &newest) == FLASH_SUCCESS &&
+          newest.timestamp == check_next_timestamp - 1, "3-day gap: new sector, timestamp exact");
+
+    // millis() starting over at a reboot starts a new sector as well, so no
+    // sector or its summary mixes the timestamps of two boots
+    check_next_timestamp = 3600000;
+    check_write(5);
+    uint16_t boot_sector, boot_slot;
+    flash_get_log_head(&boot_sector, &boot_slot);
+    check_reboot();
+    check_next_timestamp = 5000;
+    check_write(1);
+    uint16_t restart_sector, restart_slot;
+    flash_get_log_head(&restart_sector, &restart_slot);
+    check_reboot();
+    detection_result_t last_boot;
+    uint32_t range_before = 0;
+    uint32_t range_restart = 0;
+    check(boot_slot == 5 && restart_sector == (boot_sector + 1) % FLASH_LOG_SECTORS && restart_slot == 1 &&
+          flash_read_detection_log(flash_get_log_count() - 2, &last_boot) == FLASH_SUCCESS &&
+          last_boot.timestamp == 3600004 &&
+          flash_read_detection_log(flash_get_log_count() - 1, &newest) == FLASH_SUCCESS && newest.timestamp == 5000 &&
+          flash_read_log_range(3600000, 3600004, &range_before, range, 128) == 5 &&
+          flash_read_log_range(0, 5000, &range_restart, range, 128) == 1 && check_index_stats(),
+          "millis() restart: new sector after reboot, both boots exact");
+
+    // Events: a board drifting across the frame merges, another region or the gap splits
+    flash_clear_logs();
+    system_config.log_event_gap_s = 10;
+    flash_log_stats_t before = *flash_log_get_stats();
+    detection_result_t hit = {millis(), CLASS_MOTHERBOARD, 0.6f, 0.1f, 0.1f, 0.3f, 0.3f, 1};
+    detection_result_t elsewhere = {millis(), CLASS_MOTHERBOARD, 0.7f, 0.7f, 0.7f, 0.9f, 0.9f, 1};
+    for (uint32_t i = 0; i < 50; i++) {
+        flash_write_detection_log(&hit);
+        hit.timestamp += 100;
+        hit.confidence += 0.005f;
+        hit.x_min += 0.002f;
+        hit.x_max += 0.002f;
+    }
+    flash_write_detection_log(&elsewhere);
+    check(flash_get_log_count() == 0 && flash_log_get_open_events() == 2, "events: 51 hits, 2 open, none staged");
+    hit.timestamp += 10 * 1000;
+    flash_write_detection_log(&hit);
+    host_clock_set(hit.timestamp + 10 * 1000 + 1);
+    flash_log_process();
+    check(flash_log_get_open_events() == 0 && flash_get_log_count() == 3, "events: gap splits, main loop closes them");
+    flash_log_flush();
+    check_reboot();
+    log_event_t events[3];
+    bool events_read = flash_get_log_count() == 3;
+    for (uint32_t i = 0; i < 3 && events_read; i++) {
+        events_read = flash_read_log_event(i, &events[i]) == FLASH_SUCCESS;
+    }
+    check(events_read && events[0].hits == 50 && events[0].last_timestamp - events[0].detection.timestamp == 4900 &&
+          fabsf(events[0].detection.confidence - 0.845f) < 0.005f && fabsf(events[0].detection.x_max - 0.398f) < 1e-3f &&
+          events[1].hits == 1 && events[1].detection.x_min > 0.69f && events[2].hits == 1,
+          "events: first/last hit, hits, max confidence and union box after reboot");
+    const flash_log_stats_t* after = flash_log_get_stats();
+    uint32_t event_hits = after->staged_hits - before.staged_hits;
+    uint32_t event_records = after->staged_records - before.staged_records;
+    check(event_hits == 52 && event_records == 3, "events: " + String(event_hits) + " hits in " + String(event_records) +
+                                                  " records (" + String((float)event_hits / event_records, 1) + ":1)");
+    system_config.log_event_gap_s = 0;
+
+    flash_clear_logs();
+    check_reboot();
+    check(flash_get_log_count() == 0, "clear_logs: empty after reboot");
+    check_next_timestamp = 1;
+    check_write(3);
+    check_reboot();
+    check(check_log(3, 3, 0), "3 records after clear: in order");
+
+    srand(12345);
+    uint32_t killed_ok = 0;
+    for (uint32_t run = 0; run < CHECK_KILL_RUNS; run++) {
+        uint32_t before = flash_get_log_sequence();
+        check_kill_run(1000 + rand() % CHECK_KILL_MAX_US);
+        check_reboot();
+        uint32_t newest = 0;
+        uint32_t torn = 0;
+        if (check_chronological(&newest, &torn) && flash_get_log_sequence() >= before &&
+            flash_get_log_count() >= min(flash_get_log_sequence(), slots - per_sector) - torn) {
+            killed_ok++;
+        }
+    }
+    check(killed_ok == CHECK_KILL_RUNS, "SIGKILL mid-write: " + String(killed_ok) + "/" +
+                                        String(CHECK_KILL_RUNS) + " logs recovered in order (" +
+                                        String(flash_get_log_sequence()) + " records written)");
+
+    // A version 2 single copy configuration with the byte checksum, as the
+    // builds before the slots left it, is migrated once and saved to slot B
+    // with CRC-32; slot A keeps it
+    system_config_v2_t legacy;
+    memset(&legacy, 0, sizeof(legacy));
+    legacy.config_version = CONFIG_VERSION_SINGLE_COPY;
+    legacy.system_id = 0x12345678;
+    legacy.lora_send_interval = 12345;
+    legacy.detection_threshold = 0.55f;
+    legacy.motherboard_threshold = 0.65f;
+    legacy.motherboard_count_enabled = 1;
+    legacy.motherboard_count_threshold = 30;
+    legacy.motherboard_count_window_ms = 20000;
+    legacy.debug_level = 0;
+    legacy.total_detections = 777;
+    legacy.checksum = check_v1_checksum(&legacy, offsetof(system_config_v2_t, checksum));
+    FlashMemory.eraseSector(check_config_slot_offset(0));
+    FlashMemory.writeWord(check_config_slot_offset(1), 0);
+    for (uint32_t i = 0; i < sizeof(system_config_v2_t) / 4; i++) {
+        FlashMemory.writeWord(FLASH_CONFIG_LEGACY_OFFSET + i * 4, ((const uint32_t*)&legacy)[i]);
+    }
+    check_reboot();
+    config_load_from_flash();
+    const config_store_stats_t* store = config_get_store_stats();
+    const class_counter_config_t& migrated = system_config.class_counters[CLASS_MOTHERBOARD];
+    system_config_t defaults = DEFAULT_CONFIG;
+    uint32_t image = check_config_slot_offset(1) + sizeof(flash_sector_header_t);
+    check(system_config.lora_send_interval == 12345 && system_config.detection_threshold == 0.55f &&
+          system_config.motherboard_threshold == 0.65f && system_config.total_detections == 777 &&
+          migrated.enabled == 1 && migrated.count_threshold == 30 && migrated.window_s == 20 &&
+          system_config.class_counters[CLASS_LED_ON].window_s == defaults.class_counters[CLASS_LED_ON].window_s &&
+          system_config.checkpoint_interval_s == defaults.checkpoint_interval_s,
+          "config: version 2 settings mapped, counter into its class, new ones default");
+    check(store->slot == 1 && (FlashMemory.readWord(image) & 0xFFFF) == CONFIG_VERSION &&
+          FlashMemory.readWord(image + offsetof(system_config_t, checksum)) ==
+          crc32(&system_config, offsetof(system_config_t, checksum)) &&
+          (FlashMemory.readWord(FLASH_CONFIG_LEGACY_OFFSET) & 0xFFFF) == CONFIG_VERSION_SINGLE_COPY,
+          "config: version 2 byte checksum migrated to CRC-32 in slot B");
+
+    // Later saves append the changed words and the checksum, nothing else
+    unsigned long written = FlashMemory.words_written;
+    uint32_t compactions = store->compactions;
+    system_config.lora_send_interval = 23456;
+    config_save_to_flash();
+    uint32_t diff_words = FlashMemory.words_written - written;
+    written = FlashMemory.words_written;
+    config_save_to_flash();
+    check(diff_words == 4 && FlashMemory.words_written == written && store->compactions == compactions,
+          "config: one setting saved in " + String(diff_words) + " words, an unchanged save in 0");
+    check_reboot();
+    config_load_from_flash();
+    check(system_config.lora_send_interval == 23456 && store->deltas == 2, "config: deltas survive a reboot");
+
+    // Autosave waits for the settings to stop changing
+    system_config.lora_send_interval = 34567;
+    config_mark_dirty();
+    host_clock_set(millis() + CONFIG_AUTOSAVE_DELAY_MS / 2);
+    system_config.debug_level = 1;
+    config_mark_dirty();
+    host_clock_set(millis() + CONFIG_AUTOSAVE_DELAY_MS / 2);
+    config_process();
+    bool waited = config_is_dirty();
+    host_clock_set(millis() + CONFIG_AUTOSAVE_DELAY_MS);
+    config_process();
+    check_reboot();
+    config_load_from_flash();
+    check(waited && !config_is_dirty() && system_config.lora_send_interval == 34567 && system_config.debug_level == 1,
+          "config: autosave after the last change, both in one save");
+    system_config.debug_level = 0;
+    config_save_to_flash();
+
+    // A save torn before its checksum record keeps the previous configuration
+    uint32_t delta = image + FLASH_CONFIG_SIZE + store->deltas * 8;
+    uint32_t record[2] = {offsetof(system_config_t, lora_send_interval) / 4, 45678};
+    FlashMemory.writeWord(delta, record[1]);
+    FlashMemory.writeWord(delta + 4, (record[0] << 24) | (crc32(record, sizeof(record)) & 0x00FFFFFF));
+    check_reboot();
+    config_load_from_flash();
+    check(system_config.lora_send_interval == 34567 && store->compact_pending, "config: torn save dropped at boot");
+
+    // The next save switches to slot A; torn before its checksum, slot B stays
+    system_config.lora_send_interval = 56789;
+    config_save_to_flash();
+    check(store->slot == 0 && store->compactions == compactions + 1, "config: torn slot compacted into slot A");
+    uint32_t checksum_offset = check_config_slot_offset(0) + sizeof(flash_sector_header_t) + offsetof(system_config_t, checksum);
+    FlashMemory.writeWord(checksum_offset, check_clear_bit(FlashMemory.readWord(checksum_offset)));
+    check_reboot();
+    config_load_from_flash();
+    check(system_config.lora_send_interval == 34567 && store->slot == 1, "config: a torn full image leaves slot B in use");
+
+    // Neither slot valid and nothing usable in the legacy place: defaults
+    checksum_offset = image + offsetof(system_config_t, checksum);
+    FlashMemory.writeWord(checksum_offset, check_clear_bit(FlashMemory.readWord(checksum_offset)));
+    check_reboot();
+    config_load_from_flash();
+    check(system_config.lora_send_interval == LORA_DEFAULT_INTERVAL, "config: a cleared bit in both slots, defaults");
+
+    check_erase_counts(&lowest, &highest);
+    check(highest - lowest <= 3 + CHECK_KILL_RUNS, "wear after the kills: sector erase counts " + String(lowest) + "-" + String(highest));
+
+    host_serial_set_echo(true);
+    printf("\n");
+    flash_wear_print_all();
+    printf("\n%s\n", check_failures ? "FAILED" : "PASSED");
+    return check_failures ? 1 : 0;
+}
@@ -0,0 +1,238 @@
+// motion_check.cpp - Motion Gate Kernel and Gating Check
+//
+// Runs motion_gate.cpp on the host. motion_sad_u8() is compared with a
+// per-byte reference over random and worst-case buffers of every length up
+// to 64 and the thumbnail size, and motion_downsample_luma() with a
+// per-block reference and on frames of uniform blocks. Built with
+// -DMOTION_GATE_USE_DSP=1 the USADA8 word loop runs on the emulation in
+// host/arm_acle.h. Then motion_gate_process() is fed synthetic motion
+// channel frames: a static scene with sensor noise must hold the NN link
+// closed once MOTION_GATE_HOLD_MS pass, a moving block must reopen it at
+// once, and with no frames the gate must stay open and report it. The
+// motion channel must only run while the gate is enabled. Exits non-zero on
+// a failure. Build: see README.txt in this directory.
+
+#include <Arduino.h>
+#include "config.h"
+#include "detection_manager.h"
+#include "motion_gate.h"
+#include "nn_governor.h"
+
+// ===== SKETCH GLOBALS =====
+system_config_t system_config = DEFAULT_CONFIG;
+system_state_t system_state = SYS_STATE_INIT;
+
+#define CHECK_FRAME_SIZE        (MOTION_CAPTURE_W * MOTION_CAPTURE_H * 3 / 2)     // NV12
+#define CHECK_PERIOD_MS         (1000 / DETECTION_NN_TARGET_FPS)
+
+#if defined(MOTION_GATE_USE_DSP) && MOTION_GATE_USE_DSP
+#define CHECK_KERNEL            "USADA8 (emulated)"
+#else
+#define CHECK_KERNEL            "scalar"
+#endif
+
+static uint8_t check_frame[CHECK_FRAME_SIZE];
+static bool check_capture_ok = true;
+static bool check_link_held = false;
+static bool check_channel_running = false;
+static uint32_t check_failures = 0;
+
+// ===== SKETCH STAND-INS =====
+// The motion channel: check_frame while it runs, or nothing
+bool motion_channel_set_running(bool running) {
+    check_channel_running = running;
+    return true;
+}
+
+bool motion_capture_frame(const uint8_t** data, uint32_t* length) {
+    if (!check_capture_ok || !check_channel_running) {
+        return false;
+    }
+    *data = check_frame;
+    *length = sizeof(check_frame);
+    return true;
+}
+
+void nn_link_hold(uint8_t source, bool hold) {
+    if (source == NN_LINK_HOLD_MOTION) {
+        check_link_held = hold;
+    }
+}
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("  FAIL: %s\n", what);
+        check_failures++;
+    }
+}
+
+// ===== REFERENCE IMPLEMENTATIONS =====
+static uint32_t reference_sad(const uint8_t* a, const uint8_t* b, uint32_t len) {
+    uint32_t sad = 0;
+    for (uint32_t i = 0; i < len; i++) {
+        sad += (uint32_t)abs((int)a[i] - (int)b[i]);
+    }
+    return sad;
+}
+
+// Mean of the four samples at the quarter points of block (tx, ty)
+static uint8_t reference_block(const uint8_t* luma, uint16_t width, uint16_t height, uint16_t tx, uint16_t ty) {
+    uint16_t bw = width / MOTION_THUMB_W;
+    uint16_t bh = height / MOTION_THUMB_H;
+    uint32_t xs[2] = {(uint32_t)tx * bw + bw / 4, (uint32_t)tx * bw + bw / 4 + bw / 2};
+    uint32_t ys[2] = {(uint32_t)ty * bh + bh / 4, (uint32_t)ty * bh + bh / 4 + bh / 2};
+    uint32_t sum = 0;
+    for (uint32_t y : ys) {
+        for (uint32_t x : xs) {
+            sum += luma[y * width + x];
+        }
+    }
+    return (uint8_t)(sum / 4);
+}
+
+// ===== KERNELS =====
+static void check_sad() {
+    static uint8_t a[MOTION_THUMB_SIZE] __attribute__((aligned(4)));
+    static uint8_t b[MOTION_THUMB_SIZE] __attribute__((aligned(4)));
+    uint32_t compared = 0;
+
+    for (uint8_t pattern = 0; pattern < 3; pattern++) {
+        for (uint32_t i = 0; i < MOTION_THUMB_SIZE; i++) {
+            a[i] = pattern == 0 ? (uint8_t)rand() : pattern == 1 ? 255 : 0;
+            b[i] = pattern == 0 ? (uint8_t)rand() : pattern == 1 ? 0 : 255;
+        }
+        // Every tail length of the unrolled word loop, then a whole thumbnail
+        for (uint32_t len = 0; len <= 64 + 1; len++) {
+            uint32_t length = len <= 64 ? len : MOTION_THUMB_SIZE;
+            uint32_t sad = motion_sad_u8(a, b, length);
+            uint32_t reference = reference_sad(a, b, length);
+            compared++;
+            if (sad != reference) {
+                printf("  FAIL: motion_sad_u8 pattern %u length %u: %u, reference %u\n", pattern, length, sad,
+                       reference);
+                check_failures++;
+            }
+        }
+    }
+    printf("motion_sad_u8          %u lengths x 3 patterns against the per-byte reference\n", compared / 3);
+}
+
+static void check_downsample() {
+    static uint8_t thumb[MOTION_THUMB_SIZE];
+    uint32_t mismatches = 0;
+
+    // Random luminance: every thumbnail pixel as the reference computes it
+    for (uint8_t run = 0; run < 8; run++) {
+        for (uint32_t i = 0; i < sizeof(check_frame); i++) {
+            check_frame[i] = (uint8_t)rand();
+        }
+        motion_downsample_luma(check_frame, MOTION_CAPTURE_W, MOTION_CAPTURE_H, thumb);
+        for (uint16_t ty = 0; ty < MOTION_THUMB_H; ty++) {
+            for (uint16_t tx = 0; tx < MOTION_THUMB_W; tx++) {
+                mismatches += thumb[ty * MOTION_THUMB_W + tx] !=
+                              reference_block(check_frame, MOTION_CAPTURE_W, MOTION_CAPTURE_H, tx, ty);
+            }
+        }
+    }
+    check(mismatches == 0, "motion_downsample_luma differs from the reference");
+
+    // Uniform blocks: the thumbnail is the block values, whatever is sampled
+    uint8_t values[MOTION_THUMB_SIZE];
+    for (uint32_t i = 0; i < MOTION_THUMB_SIZE; i++) {
+        values[i] = (uint8_t)rand();
+    }
+    uint16_t bw = MOTION_CAPTURE_W / MOTION_THUMB_W;
+    uint16_t bh = MOTION_CAPTURE_H / MOTION_THUMB_H;
+    for (uint32_t y = 0; y < MOTION_CAPTURE_H; y++) {
+        for (uint32_t x = 0; x < MOTION_CAPTURE_W; x++) {
+            check_frame[y * MOTION_CAPTURE_W + x] = values[(y / bh) * MOTION_THUMB_W + x / bw];
+        }
+    }
+    motion_downsample_luma(check_frame, MOTION_CAPTURE_W, MOTION_CAPTURE_H, thumb);
+    check(memcmp(thumb, values, sizeof(values)) == 0, "motion_downsample_luma on uniform blocks");
+
+    printf("motion_downsample_luma %ux%u -> %ux%u, %u random frames, %u mismatches\n", MOTION_CAPTURE_W,
+           MOTION_CAPTURE_H, MOTION_THUMB_W, MOTION_THUMB_H, 8, mismatches);
+}
+
+// ===== GATING =====
+// Mid-grey scene with +-1 sensor noise, a bright square at x when x >= 0
+static void check_scene(int32_t x) {
+    for (uint32_t y = 0; y < MOTION_CAPTURE_H; y++) {
+        for (uint32_t i = 0; i < MOTION_CAPTURE_W; i++) {
+            bool square = x >= 0 && i >= (uint32_t)x && i < (uint32_t)x + 40 && y >= 60 && y < 100;
+            check_frame[y * MOTION_CAPTURE_W + i] = square ? 230 : (uint8_t)(127 + rand() % 3 - 1);
+        }
+    }
+}
+
+// Runs the gate for ms of virtual time, one check per NN frame period.
+// Returns the time the link was first held, or UINT32_MAX
+static uint32_t check_run(uint32_t ms, int32_t square_step) {
+    uint32_t start = millis();
+    uint32_t held_at = UINT32_MAX;
+    int32_t x = 0;
+    while (millis() - start < ms) {
+        check_scene(square_step ? x : -1);
+        x = (x + square_step) % (MOTION_CAPTURE_W - 40);
+        motion_gate_process();
+        if (check_link_held && held_at == UINT32_MAX) {
+            held_at = millis() - start;
+        }
+        delay(CHECK_PERIOD_MS);
+    }
+    return held_at;
+}
+
+static void check_gating() {
+    host_clock_reset(1000);
+    system_config.motion_gate_enabled = 0;
+    system_config.motion_threshold = DEFAULT_MOTION_THRESHOLD;
+    motion_gate_init();
+    check(!check_channel_running, "motion channel must stay off while the gate is disabled");
+    motion_gate_set_enabled(true);
+    printf("gate enabled           motion channel %s\n", check_channel_running ? "running" : "off");
+    check(check_channel_running, "enabling the gate must start the motion channel");
+
+    uint32_t held_at = check_run(4000, 0);
+    printf("static scene           link held after %ums (hold %ums)\n", held_at, MOTION_GATE_HOLD_MS);
+    check(held_at != UINT32_MAX && held_at > MOTION_GATE_HOLD_MS, "static scene must close the link after the hold");
+
+    check_run(CHECK_PERIOD_MS, 8);
+    printf("moving square          link %s on the first check\n", check_link_held ? "still held" : "open");
+    check(!check_link_held, "motion must reopen the link at once");
+    check(check_run(1000, 8) == UINT32_MAX, "link must stay open while the square moves");
+
+    motion_gate_stats_t stats;
+    check_capture_ok = false;
+    check_run(2000, 0);
+    motion_gate_get_stats(&stats);
+    printf("no frames              link %s, %u capture failures, %u in a row\n", check_link_held ? "held" : "open",
+           stats.capture_failures, stats.failure_run);
+    check(!check_link_held && stats.failure_run >= MOTION_GATE_FAILURE_REPORT, "no frames must fail open and report");
+
+    check_capture_ok = true;
+    held_at = check_run(4000, 0);
+    motion_gate_get_stats(&stats);
+    printf("frames back            link held after %ums, %u in a row failed\n", held_at, stats.failure_run);
+    check(held_at != UINT32_MAX && stats.failure_run == 0, "gate must close again once frames return");
+
+    motion_gate_set_enabled(false);
+    printf("gate disabled          motion channel %s, link %s\n", check_channel_running ? "running" : "off",
+           check_link_held ? "held" : "open");
+    check(!check_channel_running && !check_link_held, "disabling the gate must stop the channel and open the link");
+}
+
+// ===== MAIN =====
+int main() {
+    host_serial_set_echo(false);
+    srand(1);
+    printf("motion gate kernels: %s\n\n", CHECK_KERNEL);
+
+    check_sad();
+    check_downsample();
+    check_gating();
+
+    printf("\n%s\n", check_failures ? "FAILED" : "PASSED");
+    return check_failures ? 1 : 0;
+}
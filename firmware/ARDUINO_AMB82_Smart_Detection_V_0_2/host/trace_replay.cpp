@@ -0,0 +1,642 @@
+// trace_replay.cpp - Host-side Trace Replay for the Detection Pipeline
+//
+// Feeds recorded NN results through the same queue the ObjDet callback fills
+// on target and drains them with detection_process(), so every frame takes
+// the real path: post-filter -> ROI -> tracker -> motherboard counter and
+// trigger rules -> flash log -> LoRa formatting. The camera, GPIO, flash and RAK3172 are
+// host stand-ins (see Arduino.h, FlashMemory.h) and time is virtual, so an
+// hour of trace replays in well under a second.
+//
+// Build and trace formats: see README.txt in this directory.
+
+#include <Arduino.h>
+#include <vector>
+#include "config.h"
+#include "detection_manager.h"
+#include "detection_queue.h"
+#include "motherboard_counter.h"
+#include "amb82_flash.h"
+#include "amb82_gpio.h"
+#include "lora_rak3172.h"
+#include "nn_governor.h"
+#include "motion_gate.h"
+#include "trigger_rules.h"
+#include "heap_probe.h"
+#include "object_tracker.h"
+#include "detection_filter.h"
+#include "state_checkpoint.h"
+
+// ===== SKETCH GLOBALS =====
+// Normally defined in AMB82_Smart_Detection_V_0_2.ino
+system_config_t system_config = DEFAULT_CONFIG;
+system_state_t system_state = SYS_STATE_INIT;
+char wifi_ssid[32] = "";
+char wifi_password[32] = "";
+bool neural_network_loaded = true;
+bool wifi_connected = false;
+bool rtsp_streaming = false;
+
+void safe_serial_print(const char* message) {
+    Serial.println(message);
+}
+
+bool init_neural_network_core() { return true; }
+
+// No motion channel on the host: with motion_gate enabled the gate fails open
+bool motion_capture_frame(const uint8_t** data, uint32_t* length) {
+    (void)data;
+    (void)length;
+    return false;
+}
+bool motion_channel_set_running(bool running) { return !running; }
+bool init_wifi_on_demand() { return false; }
+bool start_rtsp_streaming() { return false; }
+
+// ===== TRACE FORMAT =====
+#define TRACE_MAGIC         "AMBT"
+#define TRACE_VERSION       1
+#define TRACE_BOX_SCALE     65535.0f
+#define TRACE_SCORE_SCALE   255.0f
+#define REPLAY_DRAIN_STEP_MS 1000      // Main-loop hook interval after the last frame
+#define REPLAY_BOOT_MS      5000        // millis() when the loop resumes after a -k reboot
+#define REPLAY_MAX_UPLINKS  4096        // Recorded uplinks, reserved before the replay
+
+typedef struct {
+    int16_t object_type;
+    float confidence;
+    detection_box_t box;
+} trace_result_t;
+
+typedef struct {
+    uint32_t t_ms;                  // Relative to the start of the recording
+    uint8_t raw_result_count;
+    uint8_t result_count;
+    trace_result_t results[MAX_DETECTION_RESULTS];
+} trace_frame_t;
+
+// ===== REPLAY STATE =====
+typedef struct {
+    uint32_t time_ms;
+    char payload[32];
+} replay_uplink_t;
+
+static std::vector<trace_frame_t> trace;
+static std::vector<replay_uplink_t> uplinks;
+static bool replay_link_running = true;
+static bool replay_verbose = false;
+static uint32_t replay_clock_base = 0;
+static uint32_t replay_frames_gated = 0;
+static uint32_t replay_events[DETECTION_CLASS_COUNT] = {0};
+static uint32_t replay_first_motherboard_ms = UINT32_MAX;
+static uint32_t replay_reboot_ms = UINT32_MAX;          // Trace time of the -k reboot
+static bool replay_rebooted = false;
+static uint32_t replay_uplinks_unrecorded = 0;
+static uint32_t replay_reboot_allocations = 0;          // Setup code, not the steady state
+
+void nn_link_set_running(bool running) {
+    replay_link_running = running;
+}
+
+static void replay_on_uplink(const char* payload, uint32_t time_ms) {
+    replay_uplink_t uplink;
+    uplink.time_ms = time_ms - replay_clock_base;
+    snprintf(uplink.payload, sizeof(uplink.payload), "%s", payload);
+    if (uplinks.size() < uplinks.capacity()) {
+        uplinks.push_back(uplink);
+    } else {
+        replay_uplinks_unrecorded++;
+    }
+
+    if (replay_verbose) {
+        fprintf(stderr, "[%9.3fs] uplink %s\n", uplink.time_ms / 1000.0, uplink.payload);
+    }
+}
+
+static void replay_on_detection(detection_result_t* result) {
+    if (result->object_class < DETECTION_CLASS_COUNT) {
+        replay_events[result->object_class]++;
+    }
+    if (result->object_class == CLASS_MOTHERBOARD && replay_first_motherboard_ms == UINT32_MAX) {
+        replay_first_motherboard_ms = result->timestamp - replay_clock_base;
+    }
+}
+
+// ===== TRACE LOADING =====
+static trace_frame_t* trace_frame_at(uint32_t t_ms) {
+    if (trace.empty() || trace.back().t_ms != t_ms) {
+        trace_frame_t frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.t_ms = t_ms;
+        trace.push_back(frame);
+    }
+    return &trace.back();
+}
+
+static void trace_add_result(trace_frame_t* frame, const trace_result_t& result) {
+    if (frame->raw_result_count < 255) {
+        frame->raw_result_count++;
+    }
+    if (frame->result_count < MAX_DETECTION_RESULTS) {
+        frame->results[frame->result_count++] = result;
+    }
+}
+
+// t_ms,class,score,x_min,y_min,x_max,y_max per result, t_ms alone for an
+// empty frame. Consecutive rows with the same t_ms form one frame.
+static bool trace_load_csv(FILE* file) {
+    char line[256];
+    uint32_t line_number = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        if (!isdigit((unsigned char)line[0])) {
+            continue;   // Header, comment or blank
+        }
+
+        unsigned long t_ms;
+        int object_type;
+        trace_result_t result;
+        int fields = sscanf(line, "%lu,%d,%f,%f,%f,%f,%f", &t_ms, &object_type, &result.confidence,
+                            &result.box.x_min, &result.box.y_min, &result.box.x_max, &result.box.y_max);
+        if (fields != 1 && fields != 7) {
+            fprintf(stderr, "line %lu: expected t_ms or t_ms,class,score,x_min,y_min,x_max,y_max\n",
+                    (unsigned long)line_number);
+            return false;
+        }
+        if (!trace.empty() && t_ms < trace.back().t_ms) {
+            fprintf(stderr, "line %lu: timestamps must not go backwards\n", (unsigned long)line_number);
+            return false;
+        }
+
+        trace_frame_t* frame = trace_frame_at((uint32_t)t_ms);
+        if (fields == 7) {
+            result.object_type = (int16_t)object_type;
+            trace_add_result(frame, result);
+        }
+    }
+    return true;
+}
+
+// "AMBT", u16 version, u16 reserved, then per frame: u32 t_ms, u8 count and
+// count x { u8 class, u8 score*255, u16 x_min, y_min, x_max, y_max *65535 }
+static bool trace_load_binary(FILE* file) {
+    uint8_t header[8];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, TRACE_MAGIC, 4) != 0 || (header[4] | (header[5] << 8)) != TRACE_VERSION) {
+        fprintf(stderr, "not an AMBT v%d trace\n", TRACE_VERSION);
+        return false;
+    }
+
+    uint8_t head[5];
+    while (fread(head, 1, sizeof(head), file) == sizeof(head)) {
+        uint32_t t_ms = head[0] | (head[1] << 8) | (head[2] << 16) | ((uint32_t)head[3] << 24);
+        trace_frame_t* frame = trace_frame_at(t_ms);
+
+        for (uint8_t i = 0; i < head[4]; i++) {
+            uint8_t rec[10];
+            if (fread(rec, 1, sizeof(rec), file) != sizeof(rec)) {
+                fprintf(stderr, "truncated frame at %lu ms\n", (unsigned long)t_ms);
+                return false;
+            }
+            trace_result_t result;
+            result.object_type = rec[0];
+            result.confidence = rec[1] / TRACE_SCORE_SCALE;
+            result.box.x_min = (rec[2] | (rec[3] << 8)) / TRACE_BOX_SCALE;
+            result.box.y_min = (rec[4] | (rec[5] << 8)) / TRACE_BOX_SCALE;
+            result.box.x_max = (rec[6] | (rec[7] << 8)) / TRACE_BOX_SCALE;
+            result.box.y_max = (rec[8] | (rec[9] << 8)) / TRACE_BOX_SCALE;
+            trace_add_result(frame, result);
+        }
+    }
+    return true;
+}
+
+static bool trace_load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    char magic[4] = {0};
+    bool binary = fread(magic, 1, 4, file) == 4 && memcmp(magic, TRACE_MAGIC, 4) == 0;
+    rewind(file);
+
+    bool ok = binary ? trace_load_binary(file) : trace_load_csv(file);
+    fclose(file);
+    return ok && !trace.empty();
+}
+
+static uint16_t trace_quantize(float value, float scale) {
+    value = constrain(value, 0.0f, 1.0f);
+    return (uint16_t)lroundf(value * scale);
+}
+
+static bool trace_save_binary(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        perror(path);
+        return false;
+    }
+
+    uint8_t header[8] = {'A', 'M', 'B', 'T', TRACE_VERSION, 0, 0, 0};
+    fwrite(header, 1, sizeof(header), file);
+
+    for (const trace_frame_t& frame : trace) {
+        uint8_t head[5] = {(uint8_t)frame.t_ms, (uint8_t)(frame.t_ms >> 8), (uint8_t)(frame.t_ms >> 16),
+                           (uint8_t)(frame.t_ms >> 24), frame.result_count};
+        fwrite(head, 1, sizeof(head), file);
+
+        for (uint8_t i = 0; i < frame.result_count; i++) {
+            const trace_result_t& r = frame.results[i];
+            uint16_t box[4] = {trace_quantize(r.box.x_min, TRACE_BOX_SCALE), trace_quantize(r.box.y_min, TRACE_BOX_SCALE),
+                               trace_quantize(r.box.x_max, TRACE_BOX_SCALE), trace_quantize(r.box.y_max, TRACE_BOX_SCALE)};
+            uint8_t rec[10] = {(uint8_t)r.object_type, (uint8_t)trace_quantize(r.confidence, TRACE_SCORE_SCALE),
+                               (uint8_t)box[0], (uint8_t)(box[0] >> 8), (uint8_t)box[1], (uint8_t)(box[1] >> 8),
+                               (uint8_t)box[2], (uint8_t)(box[2] >> 8), (uint8_t)box[3], (uint8_t)(box[3] >> 8)};
+            fwrite(rec, 1, sizeof(rec), file);
+        }
+    }
+
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
+
+// ===== REPLAY =====
+// Planned reset at trace time t_ms: final checkpoint, then the counter side of
+// setup() on a fresh millis(). Flash and the detection statistics survive, so
+// the report still covers the whole trace.
+static void replay_reboot(uint32_t t_ms) {
+    uint32_t allocations = heap_probe_allocation_count();
+    flash_log_flush();
+    checkpoint_save();
+
+    host_clock_reset(REPLAY_BOOT_MS);
+    replay_clock_base = REPLAY_BOOT_MS - t_ms;
+    motherboard_counter_init();
+    detection_filter_init();
+    trigger_rules_init();
+    tracker_init();
+    nn_governor_init();
+    checkpoint_init();
+    replay_rebooted = true;
+    replay_reboot_allocations += heap_probe_allocation_count() - allocations;
+}
+
+static void replay_run() {
+    for (const trace_frame_t& t : trace) {
+        if (!replay_rebooted && t.t_ms >= replay_reboot_ms) {
+            replay_reboot(t.t_ms);
+        }
+        host_clock_set(replay_clock_base + t.t_ms);
+        nn_governor_process();
+        motion_gate_process();
+
+        // A paused StreamIO link means the NN never saw this frame
+        if (!replay_link_running) {
+            replay_frames_gated++;
+            continue;
+        }
+
+        detection_frame_t* frame = detection_queue_reserve();
+        if (frame) {
+            frame->raw_result_count = t.raw_result_count;
+            for (uint8_t i = 0; i < t.result_count; i++) {
+                uint8_t slot = frame->result_count++;
+                frame->object_type[slot] = t.results[i].object_type;
+                frame->confidence[slot] = t.results[i].confidence;
+                frame->box[slot] = t.results[i].box;
+            }
+            detection_queue_commit();
+        }
+
+        detection_process();
+        trigger_rules_process();
+        class_counter_process();
+        motherboard_counter_zones_process();
+        checkpoint_process();
+        flash_log_process();
+    }
+
+    // Keep the main-loop hooks running for one window past the last frame so
+    // triggers still active at the end of the trace report their end
+    uint32_t last_ms = replay_clock_base + trace.back().t_ms;
+    uint32_t drain_ms = (uint32_t)system_config.class_counters[CLASS_MOTHERBOARD].window_s * 1000;
+    for (uint32_t t = REPLAY_DRAIN_STEP_MS; t <= drain_ms; t += REPLAY_DRAIN_STEP_MS) {
+        host_clock_set(last_ms + t);
+        trigger_rules_process();
+        class_counter_process();
+        motherboard_counter_zones_process();
+        flash_log_process();
+    }
+}
+
+// One simulated NN run at fps against the main loop's hooks, a MAIN_LOOP_DELAY
+// apart on the virtual clock, as loop() runs them
+static bool replay_simulate_run(uint16_t fps, uint32_t seconds, detection_queue_stats_t* stats) {
+    detection_queue_reset_stats();
+    if (!detection_sim_start(fps)) {
+        return false;
+    }
+    uint32_t start_ms = millis();
+    while (millis() - start_ms < seconds * 1000) {
+        nn_governor_process();
+        motion_gate_process();
+        detection_sim_process();
+        detection_process();
+        trigger_rules_process();
+        class_counter_process();
+        motherboard_counter_zones_process();
+        checkpoint_process();
+        flash_log_process();
+        delay(MAIN_LOOP_DELAY);
+    }
+    detection_sim_stop();
+    detection_queue_get_stats(stats);
+    return true;
+}
+
+// The simulated NN source at each rate: every frame emitted must be drained,
+// none dropped. Then once more with detection off: every frame is discarded
+// unprocessed, none dropped, and none is left queued for when it is back on.
+static bool replay_simulate(uint32_t seconds) {
+    static const uint16_t rates[] = {10, 20, 30};
+    detection_queue_stats_t stats;
+    bool passed = true;
+
+    for (uint16_t fps : rates) {
+        if (!replay_simulate_run(fps, seconds, &stats)) {
+            return false;
+        }
+        bool ok = stats.frames_dropped == 0 && stats.frames_popped == stats.frames_pushed && stats.frames_pushed > 0;
+        printf("nn_sim %2u fps  %6u frames pushed, %6u drained, %u dropped, high water %u/%u  %s\n", fps,
+               stats.frames_pushed, stats.frames_popped, stats.frames_dropped, stats.high_water,
+               DETECTION_QUEUE_DEPTH, ok ? "OK" : "FAIL");
+        passed = passed && ok;
+    }
+
+    uint16_t fps = rates[sizeof(rates) / sizeof(rates[0]) - 1];
+    detection_stats_t before, after;
+    detection_get_statistics(&before);
+    detection_enable(false);
+    bool ran = replay_simulate_run(fps, seconds, &stats);
+    detection_enable(true);
+    detection_get_statistics(&after);
+    if (!ran) {
+        return false;
+    }
+    bool ok = stats.frames_dropped == 0 && stats.frames_discarded == stats.frames_pushed && stats.frames_pushed > 0 &&
+              stats.frames_popped == 0 && stats.depth == 0 &&
+              after.total_frames_processed == before.total_frames_processed;
+    printf("nn_sim %2u fps  %6u frames pushed, %6u discarded, %u dropped, detection off  %s\n", fps,
+           stats.frames_pushed, stats.frames_discarded, stats.frames_dropped, ok ? "OK" : "FAIL");
+    return passed && ok;
+}
+
+// Global, zone and rule trigger uplinks, start and end
+static bool replay_is_trigger(const char* payload) {
+    static const char* const prefixes[] = {"MT,", "ME,", "ZT,", "ZE,", "CT,", "CE,", "RT,"};
+    for (const char* prefix : prefixes) {
+        if (strncmp(payload, prefix, 3) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void replay_print_report(const char* path, uint32_t wall_us, uint32_t allocations) {
+    uint32_t span_ms = trace.back().t_ms - trace.front().t_ms;
+    float span_s = span_ms > 0 ? span_ms / 1000.0f : 1.0f;
+    detection_stats_t stats;
+    detection_get_statistics(&stats);
+
+    uint32_t triggers = 0;
+    for (const replay_uplink_t& u : uplinks) {
+        if (replay_is_trigger(u.payload)) {
+            triggers++;
+        }
+    }
+
+    Serial.println("\n=== TRACE REPLAY ===");
+    Serial.println("Trace: " + String(path) + " (" + String((uint32_t)trace.size()) + " frames, " +
+                   String(span_s, 1) + "s)");
+    Serial.println("Frames Replayed: " + String(stats.total_frames_processed) + ", gated by NN link " +
+                   String(replay_frames_gated));
+    Serial.println("Results: " + String(stats.total_results_seen) + " raw, " +
+                   String(stats.false_detections) + " filtered, " + String(stats.roi_rejected) + " outside ROI");
+    Serial.println("Events: " + String(stats.total_detections_found) + " (" + String(stats.total_detections_found / span_s, 3) +
+                   "/s) LED:" + String(replay_events[CLASS_LED_ON]) + " MB:" + String(replay_events[CLASS_MOTHERBOARD]));
+    Serial.println("LoRa Uplinks: " + String((uint32_t)uplinks.size() + replay_uplinks_unrecorded) + " (" +
+                   String(triggers) + " triggers" +
+                   (replay_uplinks_unrecorded ? ", " + String(replay_uplinks_unrecorded) + " not recorded" : String("")) +
+                   ")");
+    const flash_log_stats_t* log = flash_log_get_stats();
+    uint32_t flushes = log->flushes[FLASH_LOG_FLUSH_FULL] + log->flushes[FLASH_LOG_FLUSH_AGE] +
+                       log->flushes[FLASH_LOG_FLUSH_FORCED];
+    Serial.println("Flash Words Written: " + String(FlashMemory.words_written) + ", " + String(FlashMemory.sectors_erased) +
+                   " sectors erased");
+    Serial.println("Log Flushes: " + String(flushes) + " for " + String(log->flushed_records) + " records, " +
+                   String(flushes ? (float)log->flush_time_us / flushes : 0.0f, 1) + "us avg, " +
+                   String(log->flush_max_us) + "us max, " + String(flash_log_get_staged()) + " still staged");
+    Serial.println("Log Events: " + String(log->staged_hits) + " hits in " + String(log->staged_records) + " records (" +
+                   String(log->staged_records ? (float)log->staged_hits / log->staged_records : 0.0f, 1) + ":1), " +
+                   String(flash_log_get_open_events()) + " open, gap " + String(system_config.log_event_gap_s) + "s");
+    if (replay_rebooted) {
+        const checkpoint_stats_t* checkpoint = checkpoint_get_stats();
+        Serial.println("Reboot: at " + String(replay_reboot_ms / 1000.0f, 1) + "s, " +
+                       (checkpoint->restored ? "restored checkpoint #" + String(checkpoint->restored_sequence)
+                                             : String("no checkpoint restored")));
+    }
+
+    uint32_t previous_ms = UINT32_MAX;
+    uint8_t shown = 0;
+    for (const replay_uplink_t& u : uplinks) {
+        if (!replay_is_trigger(u.payload)) {
+            continue;
+        }
+        if (shown++ == 0) {
+            Serial.println("Triggers:");
+        }
+        if (shown > 20) {
+            Serial.println("  ...");
+            break;
+        }
+        uint32_t since_ms = previous_ms == UINT32_MAX ? u.time_ms - replay_first_motherboard_ms : u.time_ms - previous_ms;
+        Serial.println("  " + String(u.time_ms / 1000.0f, 3) + "s " + String(u.payload) + " (+" +
+                       String(since_ms / 1000.0f, 3) + "s since " +
+                       String(previous_ms == UINT32_MAX ? "first MB event" : "previous trigger") + ")");
+        previous_ms = u.time_ms;
+    }
+
+    Serial.println("Heap Allocations: " + String(allocations) + " in the replay loop" +
+                   (replay_reboot_allocations ? ", " + String(replay_reboot_allocations) + " in the -k reboot"
+                                              : String("")));
+    Serial.println("Replay Cost: " + String(wall_us / 1000.0f, 1) + "ms wall, " +
+                   String(stats.total_frames_processed ? (float)wall_us / stats.total_frames_processed : 0.0f, 2) + "us/frame, " +
+                   String(wall_us ? span_ms * 1000.0f / wall_us : 0.0f, 0) + "x real time");
+    Serial.println("====================\n");
+}
+
+// Rules from -r fill system_config in order, trigger_rules_init() picks them up
+static bool replay_add_rule(const char* spec) {
+    static uint8_t rule_count = 0;
+    char class_name[16], aggregation[16];
+    unsigned window_s, threshold, cooldown_s;
+    if (rule_count >= TRIGGER_MAX_RULES ||
+        sscanf(spec, "%15[^,],%15[^,],%u,%u,%u", class_name, aggregation, &window_s, &threshold, &cooldown_s) != 5) {
+        return false;
+    }
+
+    trigger_rule_config_t* cfg = &system_config.trigger_rules[rule_count++];
+    cfg->enabled = 1;
+    cfg->object_class = isdigit((unsigned char)class_name[0]) ? atoi(class_name) : detection_string_to_class(class_name);
+    cfg->aggregation = trigger_string_to_aggregation(aggregation);
+    cfg->window_s = window_s;
+    cfg->threshold = threshold;
+    cfg->cooldown_s = cooldown_s;
+    cfg->actions = TRIGGER_ACTION_LORA;
+    cfg->lora_type = TRIGGER_DEFAULT_LORA_TYPE;
+    cfg->led_pattern = TRIGGER_DEFAULT_LED_PATTERN;
+    return cfg->object_class < DETECTION_CLASS_COUNT && cfg->aggregation < TRIGGER_AGG_COUNT_TYPES && window_s > 0;
+}
+
+static void replay_usage() {
+    fprintf(stderr,
+            "usage: trace_replay [options] <trace.csv|trace.bin>\n"
+            "       trace_replay [options] -S <sec>\n"
+            "  -q          silence firmware output during the replay\n"
+            "  -v          print every LoRa uplink as it is sent\n"
+            "  -d <level>  debug_level (default %u)\n"
+            "  -t <count>  motherboard count threshold\n"
+            "  -w <sec>    motherboard count window\n"
+            "  -e          trigger the motherboard counter on its EWMA rate\n"
+            "  -r <rule>   add a trigger rule, class,count|rate|absence,window_s,threshold,cooldown_s\n"
+            "  -T          disable the tracker (count every frame)\n"
+            "  -G          disable the NN frame rate governor\n"
+            "  -k <sec>    reboot at this trace time, restoring the counters from the checkpoint\n"
+            "  -P <us>[,<us>]  flash word program [and sector erase] time, 0 = free\n"
+            "  -g <sec>    detection log event gap, 0 = a record per hit (default %u)\n"
+            "  -o <file>   write the trace as AMBT binary and exit\n"
+            "  -S <sec>    no trace: run the simulated NN source at 10, 20 and 30 fps for\n"
+            "              <sec> seconds each, fail on a dropped frame\n",
+            (unsigned)system_config.debug_level, (unsigned)system_config.log_event_gap_s);
+}
+
+int main(int argc, char** argv) {
+    bool quiet = false;
+    bool tracker = true;
+    const char* output = NULL;
+    const char* path = NULL;
+    uint32_t simulate_s = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "-q") == 0) {
+            quiet = true;
+        } else if (strcmp(arg, "-v") == 0) {
+            replay_verbose = true;
+        } else if (strcmp(arg, "-T") == 0) {
+            tracker = false;
+        } else if (strcmp(arg, "-e") == 0) {
+            system_config.class_counters[CLASS_MOTHERBOARD].mode = CLASS_COUNTER_MODE_EWMA;
+        } else if (strcmp(arg, "-G") == 0) {
+            system_config.nn_governor_enabled = 0;
+        } else if (strcmp(arg, "-d") == 0 && has_value) {
+            system_config.debug_level = (uint8_t)atoi(argv[++i]);
+        } else if (strcmp(arg, "-t") == 0 && has_value) {
+            system_config.class_counters[CLASS_MOTHERBOARD].count_threshold = (uint16_t)atol(argv[++i]);
+        } else if (strcmp(arg, "-w") == 0 && has_value) {
+            system_config.class_counters[CLASS_MOTHERBOARD].window_s = (uint16_t)atol(argv[++i]);
+        } else if (strcmp(arg, "-r") == 0 && has_value) {
+            if (!replay_add_rule(argv[++i])) {
+                fprintf(stderr, "invalid rule: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(arg, "-k") == 0 && has_value) {
+            replay_reboot_ms = (uint32_t)(atof(argv[++i]) * 1000);
+        } else if (strcmp(arg, "-P") == 0 && has_value) {
+            if (sscanf(argv[++i], "%u,%u", &FlashMemory.program_us, &FlashMemory.erase_us) < 1) {
+                replay_usage();
+                return 1;
+            }
+        } else if (strcmp(arg, "-g") == 0 && has_value) {
+            system_config.log_event_gap_s = (uint16_t)atol(argv[++i]);
+        } else if (strcmp(arg, "-o") == 0 && has_value) {
+            output = argv[++i];
+        } else if (strcmp(arg, "-S") == 0 && has_value) {
+            simulate_s = (uint32_t)atol(argv[++i]);
+        } else if (arg[0] != '-' && !path) {
+            path = arg;
+        } else {
+            replay_usage();
+            return 1;
+        }
+    }
+
+    if ((simulate_s == 0 || output) && !path) {
+        replay_usage();
+        return 1;
+    }
+    if (path && !trace_load(path)) {
+        fprintf(stderr, "%s: no frames loaded\n", path);
+        return 1;
+    }
+    if (output) {
+        if (!trace_save_binary(output)) {
+            return 1;
+        }
+        printf("Wrote %lu frames to %s\n", (unsigned long)trace.size(), output);
+        return 0;
+    }
+
+    // Same bring-up order as setup(), minus camera and WiFi
+    host_lora_set_uplink(replay_on_uplink);
+    host_serial_set_echo(!quiet);
+    flash_init();
+    gpio_init();
+    motherboard_counter_init();
+    lora_init();
+    detection_init();
+    tracker_set_enabled(tracker);
+    detection_set_callback(replay_on_detection);
+    checkpoint_init();
+    nn_governor_init();
+    motion_gate_init();
+    system_state = SYS_STATE_RUNNING;
+
+    if (!path) {
+        bool passed = replay_simulate(simulate_s);
+        host_serial_set_echo(true);
+        printf("\n%s\n", passed ? "PASSED" : "FAILED");
+        return passed ? 0 : 1;
+    }
+
+    // Nothing on the loop's path may allocate once running, the reboot's
+    // setup code is counted apart
+    uplinks.reserve(REPLAY_MAX_UPLINKS);
+    replay_clock_base = millis() - trace.front().t_ms;
+    uint32_t allocations = heap_probe_allocation_count();
+    uint32_t start_us = micros();
+    replay_run();
+    uint32_t wall_us = micros() - start_us;
+    allocations = heap_probe_allocation_count() - allocations - replay_reboot_allocations;
+
+    host_serial_set_echo(true);
+    replay_print_report(path, wall_us, allocations);
+    detection_print_statistics();
+    motherboard_counter_print_stats();
+    if (trigger_rules_active()) {
+        trigger_rules_print_status();
+    }
+    if (allocations) {
+        printf("FAILED: %u heap allocations in the replay loop\n", allocations);
+        return 1;
+    }
+    if (lora_module.stats.messages_failed) {
+        printf("FAILED: %lu LoRa uplinks rejected\n", (unsigned long)lora_module.stats.messages_failed);
+        return 1;
+    }
+    return 0;
+}